@@ -6,11 +6,16 @@
 #include <QDeclarativeListProperty>
 #include <QStringList>
 #include <QDate>
+#include <QtSql/QSqlQuery>
+#include <QtSql/QSqlRecord>
 
 
 #include "Position.hpp"
 #include "Schlagwort.hpp"
 #include "Kunde.hpp"
+#include "UuidKey.hpp"
+#include "JsonStreamReader.hpp"
+#include "JsonStreamWriter.hpp"
 
 
 class Auftrag: public QObject
@@ -38,6 +43,41 @@ public:
 	void fillFromMap(const QVariantMap& auftragMap);
 	void fillFromForeignMap(const QVariantMap& auftragMap);
 	void fillFromCacheMap(const QVariantMap& auftragMap);
+	void fillFromCacheStream(JsonStreamReader& reader);
+
+	// SQL - normalized: table auftrag,
+	// positionen in table position, keys of tags in table auftrag_tag
+	static const QString createTableCommand();
+	static const QString createParameterizedInsertPosBinding();
+	static const QString createParameterizedInsertOrReplacePosBinding();
+	static const QString createParameterizedUpsertPosBinding();
+	static const QString createParameterizedDeleteByKeys(const int& keyCount);
+	static void toSqlCache(const AuftragRecord& record, QVariantList& nrList,
+			QVariantList& datumList, QVariantList& bemerkungList, QVariantList& auftraggeberList);
+	void fillFromSqlQuery(const QSqlQuery& sqlQuery);
+	static void fillSqlQueryPos(const QSqlRecord& record);
+	static void bindSqlColumns(SqlRowDecoder& decoder, const int& schemaVersion);
+	void fillFromSqlRow(const SqlRowDecoder& decoder);
+	static void positionenToSqlCache(const AuftragRecord& record, QVariantList& uuidList,
+			QVariantList& auftragNrList, QVariantList& posIndexList,
+			QVariantList& bezeichnungList, QVariantList& preisList);
+	void addToPositionenFromSqlQuery(const QSqlQuery& sqlQuery);
+	void addToPositionenFromSqlRow(const SqlRowDecoder& decoder);
+	static const QString createTagsTableCommand();
+	static const QString createParameterizedInsertTagsPosBinding();
+	static const QString createParameterizedDeleteTagsByKeys(const int& keyCount);
+	// SELECT auftrag_nr, schlagwort ordered by auftrag_nr and tag_index
+	static const QString createSelectTagsCommand();
+	static void tagsToSqlCache(const AuftragRecord& record, QVariantList& auftragNrList,
+			QVariantList& tagIndexList, QVariantList& uuidList);
+	void addToTagsKeysFromSqlCache(const UuidKey& uuid);
+
+	// binary snapshot - includes positionen and keys of tags
+	void toBinaryCache(BinaryCacheWriter& writer);
+	AuftragRecord toRecord();
+	// update in place (journal replay) - QML keeps its pointers
+	void fillFromRecord(const AuftragRecord& record);
+	void fillFromBinaryCache(BinaryCacheReader& reader);
 	
 	void prepareNew();
 	
@@ -47,6 +87,7 @@ public:
 	QVariantMap toMap();
 	QVariantMap toForeignMap();
 	QVariantMap toCacheMap();
+	void toCacheStream(JsonStreamWriter& writer);
 
 	int nr() const;
 	void setNr(int nr);
@@ -76,6 +117,8 @@ public:
 	
 	Q_INVOKABLE
 	void markAuftraggeberAsInvalid();
+	// Kunde* still exists but is not in memory (lazy Kunde): resolved again on demand
+	void releaseAuftraggeberAsDataObject();
 	
 
 	
@@ -102,6 +145,11 @@ public:
 	
 	Q_INVOKABLE
 	bool removeFromPositionenByUuid(const QString& uuid);
+
+	bool removeFromPositionenByUuidKey(const UuidKey& uuid);
+
+	// called by Position if a property of a contained Position was changed
+	void positionChanged(Position* position);
 	
 	Q_INVOKABLE
 	int positionenCount();
@@ -132,6 +180,9 @@ public:
 	Q_INVOKABLE
 	QStringList tagsKeys();
 
+	// binary keys - tagsKeys() as Strings only for QML and foreign APIs
+	QList<UuidKey> tagsUuidKeys();
+
 	Q_INVOKABLE
 	void resolveTagsKeys(QList<Schlagwort*> tags);
 	
@@ -158,9 +209,11 @@ public:
 	void positionenChanged(QList<Position*> positionen);
 	void addedToPositionen(Position* position);
 	void removedFromPositionenByUuid(QString uuid);
+	void changedInPositionen(Position* position);
 	
 	void tagsChanged(QList<Schlagwort*> tags);
 	void addedToTags(Schlagwort* schlagwort);
+	void removedFromTags(Schlagwort* schlagwort);
 	
 	
 
@@ -181,7 +234,10 @@ private:
 	static Position* atPositionenProperty(QDeclarativeListProperty<Position> *positionenList, int pos);
 	static void clearPositionenProperty(QDeclarativeListProperty<Position> *positionenList);
 	// lazy Array of independent Data Objects: only keys are persisted
-	QStringList mTagsKeys;
+	QList<UuidKey> mTagsKeys;
+	void fillTagsKeysFromList(const QVariantList& tagsList);
+	void syncTagsKeys();
+	QStringList tagsKeysAsStringList();
 	bool mTagsKeysResolved;
 	QList<Schlagwort*> mTags;
 	// implementation for QDeclarativeListProperty to use
@@ -0,0 +1,51 @@
+#ifndef AUFTRAGSQLREADER_HPP_
+#define AUFTRAGSQLREADER_HPP_
+
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
+
+#include "SqlRowDecoder.hpp"
+
+class Auftrag;
+
+/*
+ * reads the Auftrag aggregate from SQLite cache in one pass
+ *
+ * three forward-only queries, all ordered by Auftrag nr:
+ * auftrag (INTEGER PRIMARY KEY), position (index auftrag_nr, pos_index)
+ * and auftrag_tag (PRIMARY KEY auftrag_nr, tag_index)
+ * are merged like a merge join - no JOIN with duplicated Auftrag columns
+ * and no lookup per Auftrag
+ *
+ * rows are read typed by SqlRowDecoder
+ *
+ * Auftrag* are created without parent
+ */
+class AuftragSqlReader
+{
+public:
+	AuftragSqlReader(const QSqlDatabase& database);
+	~AuftragSqlReader();
+
+	// false if the tables don't exist or cannot be queried
+	bool open();
+	// next Auftrag* including Positionen and keys of tags, 0 at end
+	Auftrag* next();
+	// number of rows in table auftrag
+	int count();
+
+private:
+	QSqlDatabase mDatabase;
+	QSqlQuery mAuftragQuery;
+	QSqlQuery mPositionQuery;
+	QSqlQuery mTagsQuery;
+	SqlRowDecoder* mAuftragRows;
+	SqlRowDecoder* mPositionRows;
+	SqlRowDecoder* mTagsRows;
+	bool mHasPosition;
+	bool mHasTag;
+
+	Q_DISABLE_COPY (AuftragSqlReader)
+};
+
+#endif /* AUFTRAGSQLREADER_HPP_ */
@@ -0,0 +1,80 @@
+#ifndef CACHECODEC_HPP_
+#define CACHECODEC_HPP_
+
+#include <QIODevice>
+#include <QByteArray>
+#include <QString>
+
+/*
+ * optional compression of the JSON caches
+ *
+ * compressed file:
+ * magic "EMCZ" | format version quint8 | codec quint8 | reserved quint16
+ * blocks: quint32 length | qCompress() data (zlib, starts with uncompressed size)
+ * blocks are max 256 kB uncompressed, so reading can be streamed (CacheCodecDevice)
+ *
+ * files without magic are plain JSON (older versions, assets):
+ * auto detected on read
+ *
+ * codecs: qCompress level 1 (fast) or level 9 (best)
+ * both are decoded the same way - the level is only stored for information
+ */
+class CacheCodec
+{
+public:
+	enum Codec {
+		PlainCodec = 0, ZlibFastCodec = 1, ZlibBestCodec = 2
+	};
+
+	static QByteArray encode(const QByteArray& data, const Codec& codec);
+	// plain data is returned as it is
+	static QByteArray decode(const QByteArray& data, bool* ok = 0);
+	static bool isCompressed(const QByteArray& data);
+	// peeks at the device - nothing is read
+	static bool isCompressed(QIODevice* device);
+
+	static bool writeFile(const QString& filePath, const QByteArray& data, const Codec& codec);
+	static QByteArray readFile(const QString& filePath, bool* ok = 0);
+
+	static const int headerSize;
+	static const int blockSize;
+};
+
+/*
+ * reads or writes a compressed cache block by block
+ * used by JsonStreamReader and JsonStreamWriter:
+ * max one block is uncompressed in memory
+ */
+class CacheCodecDevice: public QIODevice
+{
+public:
+	CacheCodecDevice(QIODevice* source, QObject *parent = 0);
+	virtual ~CacheCodecDevice();
+
+	// WriteOnly: codec of the new file (default: ZlibFastCodec)
+	void setCodec(const CacheCodec::Codec& codec);
+	// ReadOnly: false if source is not a compressed cache
+	// WriteOnly: false for PlainCodec
+	bool open(OpenMode mode);
+	// WriteOnly: writes the last block
+	void close();
+	bool isSequential() const;
+	bool atEnd() const;
+	bool hasError() const;
+
+protected:
+	qint64 readData(char* data, qint64 maxSize);
+	qint64 writeData(const char* data, qint64 maxSize);
+
+private:
+	QIODevice* mSource;
+	QByteArray mBlock;
+	int mBlockPos;
+	bool mError;
+	CacheCodec::Codec mCodec;
+
+	bool readBlock();
+	bool writeBlock(const int& length);
+};
+
+#endif /* CACHECODEC_HPP_ */
@@ -0,0 +1,89 @@
+#ifndef CACHELOADER_HPP_
+#define CACHELOADER_HPP_
+
+#include <QObject>
+#include <QThread>
+#include <QStringList>
+#include <QSet>
+
+#include "UuidKey.hpp"
+
+/*
+ * loads the caches on a worker thread
+ * used by DataManager::initAsync()
+ *
+ * DTOs are created without parent on the worker thread,
+ * filled from binary snapshot, SQLite or JSON
+ * and moved to the thread of DataManager in batches
+ * DataManager receives the batches as queued SIGNALS,
+ * sets itself as parent and can use them immediately
+ */
+class CacheLoader: public QObject
+{
+	Q_OBJECT
+
+public:
+	// where the DTOs were loaded from - reported by <dto>Done()
+	enum CacheSource {
+		BinarySource, SqlSource, JsonSource
+	};
+
+	CacheLoader(QThread* targetThread, QObject *parent = 0);
+	virtual ~CacheLoader();
+
+	// binary snapshots or empty if binary cache not used
+	void setBinaryCacheFiles(const QString& kundeFile, const QString& auftragFile,
+			const QString& schlagwortFile);
+	// SQLite database with kunde and auftrag tables
+	void setDatabaseFile(const QString& databaseFile);
+	// JSON caches
+	void setJsonCacheFiles(const QString& auftragFile, const QString& schlagwortFile);
+	void setBatchSize(const int& batchSize);
+	// default: all DTOs
+	// 2PhaseInit: only the DTOs not completely loaded in phase one
+	void setDtosToLoad(const bool& kunde, const bool& auftrag, const bool& schlagwort);
+
+public slots:
+	void load();
+
+Q_SIGNALS:
+	// total is -1 if unknown (JSON stream)
+	void kundeLoaded(QList<QObject*> kundeBatch, int total);
+	void kundeDone(int source);
+	void auftragLoaded(QList<QObject*> auftragBatch, int total);
+	void auftragDone(int source);
+	void schlagwortLoaded(QList<QObject*> schlagwortBatch, int total);
+	void schlagwortDone(int source);
+	void finished();
+
+private:
+	QThread* mTargetThread;
+	QString mKundeBinaryFile;
+	QString mAuftragBinaryFile;
+	QString mSchlagwortBinaryFile;
+	QString mDatabaseFile;
+	QString mAuftragJsonFile;
+	QString mSchlagwortJsonFile;
+	int mBatchSize;
+	bool mLoadKunde;
+	bool mLoadAuftrag;
+	bool mLoadSchlagwort;
+	// truncated snapshot: keys already handed over
+	// skipped when the rest is loaded from SQLite or JSON
+	QSet<int> mLoadedKundeNr;
+	QSet<int> mLoadedAuftragNr;
+	QSet<UuidKey> mLoadedSchlagwortUuid;
+
+	bool loadKundeFromBinaryCache();
+	void loadKundeFromSqlCache();
+	bool loadAuftragFromBinaryCache();
+	bool loadAuftragFromSqlCache();
+	void loadAuftragFromCacheStream();
+	bool loadSchlagwortFromBinaryCache();
+	void loadSchlagwortFromCacheStream();
+
+	// moves the objects to DataManager thread
+	void handOver(QList<QObject*>& batch);
+};
+
+#endif /* CACHELOADER_HPP_ */
@@ -1,6 +1,14 @@
 #include <QObject>
 
 #include "DataManager.hpp"
+#include "CacheLoader.hpp"
+#include "AuftragSqlReader.hpp"
+#include "WalCheckpointer.hpp"
+#include "SnapshotWriter.hpp"
+#include "ChunkSizer.hpp"
+#include "CacheCodec.hpp"
+#include "SqlRowDecoder.hpp"
+#include "KundePager.hpp"
 
 #include <bb/cascades/Application>
 #include <bb/cascades/AbstractPane>
@@ -9,6 +17,14 @@
 
 #include <QtSql/QSqlQuery>
 #include <QtSql/QSqlRecord>
+#include <QElapsedTimer>
+#include <QBuffer>
+#include <QTimer>
+
+#include <sys/resource.h>
+#include <malloc.h>
+#include <unistd.h>
+#include <algorithm>
 
 static QString dbName = "sqlcache.db";
 
@@ -23,12 +39,82 @@ static QString dataPath(const QString& fileName)
 static QString cacheKunde = "cacheKunde.json";
 static QString cacheAuftrag = "cacheAuftrag.json";
 static QString cacheSchlagwort = "cacheSchlagwort.json";
+// binary snapshots
+static QString binaryCacheKunde = "cacheKunde.bin";
+static QString binaryCacheAuftrag = "cacheAuftrag.bin";
+static QString binaryCacheSchlagwort = "cacheSchlagwort.bin";
+// 2PhaseInit: most recent Auftrag loaded in phase one
+static QString binaryCacheAuftragPriority = "cacheAuftragPriority.bin";
+// written at exit if the background save didn't finish in time
+static QString snapshotJournalSuffix = ".journal";
+// changes of Auftrag appended since the last full snapshot
+static QString auftragJournal = "cacheAuftrag.log";
+
+/*
+ * peak resident set size of the process in kB
+ * never falls: only comparable between separate runs
+ */
+static long peakResidentSetKb()
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return -1;
+    }
+    return usage.ru_maxrss;
+}
+
+// bytes allocated by malloc() and not freed
+static long heapInUseKb()
+{
+    struct mallinfo info = mallinfo();
+    return info.uordblks / 1024;
+}
+
+/*
+ * constant time removal from mAllKunde / mAllAuftrag:
+ * the last object takes the place of the removed one
+ * positions are only appended by index*() - if the list was changed
+ * otherwise (clear, QML append, replay) they are rebuilt once
+ */
+template<typename T>
+static bool removeBySwap(QList<QObject*>& list, QHash<T*, int>& positions, T* object)
+{
+    int pos = positions.value(object, -1);
+    if (pos < 0 || pos >= list.size() || list.at(pos) != object) {
+        positions.clear();
+        positions.reserve(list.size());
+        for (int i = 0; i < list.size(); ++i) {
+            positions.insert((T*) list.at(i), i);
+        }
+        pos = positions.value(object, -1);
+        if (pos < 0) {
+            return false;
+        }
+    }
+    QObject* last = list.last();
+    list[pos] = last;
+    positions.insert((T*) last, pos);
+    list.removeLast();
+    positions.remove(object);
+    return true;
+}
 
 using namespace bb::cascades;
 using namespace bb::data;
 
 DataManager::DataManager(QObject *parent) :
-        QObject(parent)
+        QObject(parent), mLazyKunde(false), mLazyKundeBudget(1000), mKundePager(0),
+                mEvictedKunde(0), mAllKundeHandedOut(false), mKundeEvictionSuspended(0),
+                mKundeRecordStorage(false), mKundeCacheOutdated(false),
+                mAuftragCacheOutdated(false), mResolvingReferences(false), mSnapshotWriter(0),
+                mSnapshotThread(0), mSnapshotPending(false), mSaveTimeoutMs(3000),
+                mAutosaveTimer(0), mAuftragJournalLimitKb(512), mIncrementalSqlSync(true),
+                mSqlUpsertSupported(false), mDurabilityProfile(RollbackJournalDurability),
+                mWalCheckpointInterval(5000), mWalCheckpointer(0), mWalCheckpointerThread(0),
+                mAdaptiveChunkSize(false), mChunkMinLatencyMs(50), mChunkMaxLatencyMs(200),
+                mSqlImportRunning(false), mStreamingJsonCache(true), mBinaryCache(true),
+                mInitRunning(false), mAuftragPhaseTwo(false), mAuftragPriorityCount(200),
+                mCacheCodec(CacheCodec::PlainCodec)
 {
     // ApplicationUI is parent of DataManager
     // DataManager is parent of all root DataObjects
@@ -47,6 +133,8 @@ DataManager::DataManager(QObject *parent) :
 	// useful Types for all APPs dealing with data
 	// QTimer
 	qmlRegisterType<QTimer>("org.ekkescorner.common", 1, 0, "QTimer");
+	// batches from CacheLoader are queued between threads
+	qRegisterMetaType<QList<QObject*> >("QList<QObject*>");
 
 	// no auto exit: we must persist the cache before
     bb::Application::instance()->setAutoExit(false);
@@ -62,18 +150,299 @@ DataManager::DataManager(QObject *parent) :
  * called from main.qml with delay using QTimer
  * Data with 2PhaseInit Caching Policy will only
  * load priority records needed to resolve from others
+ *
+ * 2PhaseInit: Auftrag
+ * phase one: Kunde (needed to resolve auftraggeber) and
+ * the most recent Auftrag (priority snapshot) to render the first screen
+ * phase two: all other Auftrag are loaded on a worker thread (CacheLoader)
+ * auftragInitProgress(), auftragInitDone() and initDone() are emitted
  */
 void DataManager::init()
 {
+	if (mInitRunning) {
+		qWarning() << "init() ignored: initAsync() is running";
+		return;
+	}
 	// SQL init the sqlite database
 	mDatabaseAvailable = initDatabase();
 	qDebug() << "SQLite created or opened ? " << mDatabaseAvailable;
+	recoverSnapshotJournal();
 
-    initKundeFromSqlCache();
-    initAuftragFromCache();
-    initSchlagwortFromCache();
+    // binary snapshots are preferred - if there's no snapshot
+    // data is imported from SQLite or JSON
+    if (openLazyKunde()) {
+        // Kunde* are read from SQLite if needed
+    } else if (openKundeRecords()) {
+        // Kunde* are created from KundeRecord if needed
+    } else if (!mBinaryCache || !initKundeFromBinaryCache()) {
+        initKundeFromSqlCache();
+        // imported: there's no snapshot yet
+        mKundeCacheOutdated = mBinaryCache;
+    }
+    bool auftragPhaseTwo = false;
+    if (mBinaryCache && initAuftragPriorityFromBinaryCache()) {
+        auftragPhaseTwo = true;
+    } else if (!mBinaryCache || !initAuftragFromBinaryCache()) {
+        if (initAuftragFromSqlCache()) {
+            mAuftragCacheOutdated = mBinaryCache;
+        } else {
+            // first start: import from JSON
+            initAuftragFromCache();
+            mAuftragCacheOutdated = mBinaryCache || mDatabaseAvailable;
+        }
+    } else {
+        replayAuftragJournal();
+    }
+    if (!mBinaryCache || !initSchlagwortFromBinaryCache()) {
+        initSchlagwortFromCache();
+        // Schlagwort is read-only: not saved at exit, so snapshot it now
+        if (mBinaryCache) {
+            saveSchlagwortToBinaryCache();
+        }
+    }
+    if (auftragPhaseTwo) {
+        startAuftragPhaseTwo();
+    }
+}
+
+/*
+ * 2PhaseInit phase two: all Auftrag from binary snapshot (or JSON)
+ * Auftrag already loaded in phase one are skipped
+ */
+void DataManager::startAuftragPhaseTwo()
+{
+	mInitRunning = true;
+	mAuftragPhaseTwo = true;
+	CacheLoader* cacheLoader = new CacheLoader(this->thread());
+	cacheLoader->setDtosToLoad(false, true, false);
+	cacheLoader->setBinaryCacheFiles(dataPath(binaryCacheKunde), dataPath(binaryCacheAuftrag),
+			dataPath(binaryCacheSchlagwort));
+	cacheLoader->setDatabaseFile(dataPath(dbName));
+	prepareCacheFile(cacheAuftrag);
+	cacheLoader->setJsonCacheFiles(dataPath(cacheAuftrag), dataPath(cacheSchlagwort));
+	startCacheLoader(cacheLoader);
+}
+
+void DataManager::setAuftragPriorityCount(const int& priorityCount)
+{
+	mAuftragPriorityCount = priorityCount;
+}
+
+/*
+ * loads all data from cache on a worker thread (CacheLoader)
+ * same sources as init(): binary snapshot, then SQLite or JSON
+ * DTOs arrive in batches - each batch is appended and indexed
+ * so QML can use partially loaded data
+ * <dto>InitProgress() is emitted per batch, <dto>InitDone() per DTO
+ * and initDone() if all DTOs are loaded
+ */
+void DataManager::initAsync()
+{
+	if (mInitRunning) {
+		qWarning() << "initAsync() already running";
+		return;
+	}
+	mInitRunning = true;
+	// SQL init the sqlite database - used to save at exit
+	mDatabaseAvailable = initDatabase();
+	qDebug() << "SQLite created or opened ? " << mDatabaseAvailable;
+	recoverSnapshotJournal();
+	mAllKunde.clear();
+	mKundeByNr.clear();
+	mKundePosition.clear();
+	mAllAuftrag.clear();
+	clearAuftragIndex();
+	mAllSchlagwort.clear();
+	mSchlagwortByUuid.clear();
+	// copy JSON caches from assets (if needed) before the worker starts
+	prepareCacheFile(cacheAuftrag);
+	prepareCacheFile(cacheSchlagwort);
+
+	CacheLoader* cacheLoader = new CacheLoader(this->thread());
+	if (openLazyKunde() || openKundeRecords()) {
+		// only the keys (or records) - already loaded
+		cacheLoader->setDtosToLoad(false, true, true);
+		emit kundeInitDone();
+	}
+	if (mBinaryCache) {
+		cacheLoader->setBinaryCacheFiles(dataPath(binaryCacheKunde), dataPath(binaryCacheAuftrag),
+				dataPath(binaryCacheSchlagwort));
+	}
+	cacheLoader->setDatabaseFile(dataPath(dbName));
+	cacheLoader->setJsonCacheFiles(dataPath(cacheAuftrag), dataPath(cacheSchlagwort));
+	startCacheLoader(cacheLoader);
+}
+
+/*
+ * runs the CacheLoader on its own thread
+ * CacheLoader and thread are deleted if loading is finished
+ */
+void DataManager::startCacheLoader(CacheLoader* cacheLoader)
+{
+	QThread* thread = new QThread(this);
+	mCacheLoaderThread = thread;
+	cacheLoader->moveToThread(thread);
+
+	bool res = QObject::connect(thread, SIGNAL(started()), cacheLoader, SLOT(load()));
+	Q_ASSERT(res);
+	res = QObject::connect(cacheLoader, SIGNAL(kundeLoaded(QList<QObject*>, int)), this,
+			SLOT(onKundeLoaded(QList<QObject*>, int)));
+	Q_ASSERT(res);
+	res = QObject::connect(cacheLoader, SIGNAL(kundeDone(int)), this, SLOT(onKundeLoadDone(int)));
+	Q_ASSERT(res);
+	res = QObject::connect(cacheLoader, SIGNAL(auftragLoaded(QList<QObject*>, int)), this,
+			SLOT(onAuftragLoaded(QList<QObject*>, int)));
+	Q_ASSERT(res);
+	res = QObject::connect(cacheLoader, SIGNAL(auftragDone(int)), this, SLOT(onAuftragLoadDone(int)));
+	Q_ASSERT(res);
+	res = QObject::connect(cacheLoader, SIGNAL(schlagwortLoaded(QList<QObject*>, int)), this,
+			SLOT(onSchlagwortLoaded(QList<QObject*>, int)));
+	Q_ASSERT(res);
+	res = QObject::connect(cacheLoader, SIGNAL(schlagwortDone(int)), this,
+			SLOT(onSchlagwortLoadDone(int)));
+	Q_ASSERT(res);
+	res = QObject::connect(cacheLoader, SIGNAL(finished()), this, SLOT(onCacheLoaderFinished()));
+	Q_ASSERT(res);
+	// clean up worker and thread
+	// direct: quit() must work while the UI thread waits at exit
+	res = QObject::connect(cacheLoader, SIGNAL(finished()), thread, SLOT(quit()),
+			Qt::DirectConnection);
+	Q_ASSERT(res);
+	res = QObject::connect(thread, SIGNAL(finished()), cacheLoader, SLOT(deleteLater()));
+	Q_ASSERT(res);
+	res = QObject::connect(thread, SIGNAL(finished()), thread, SLOT(deleteLater()));
+	Q_ASSERT(res);
+	Q_UNUSED(res);
+	mInitElapsedTimer.start();
+	thread->start();
+}
+
+/*
+ * exit while loading: the rest is loaded and the queued batches
+ * are applied, so the caches are saved from complete data
+ * (phase two of 2PhaseInit too)
+ */
+void DataManager::waitForCacheLoader()
+{
+	if (mCacheLoaderThread) {
+		QElapsedTimer elapsedTimer;
+		elapsedTimer.start();
+		mCacheLoaderThread->wait();
+		qDebug() << "waited for CacheLoader ms: " << elapsedTimer.elapsed();
+	}
+	// <dto>Loaded(), <dto>Done() and finished() are still queued
+	QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+}
+
+bool DataManager::isInitRunning()
+{
+	return mInitRunning;
+}
+
+void DataManager::onKundeLoaded(QList<QObject*> kundeBatch, int total)
+{
+	if (total > 0 && mAllKunde.isEmpty()) {
+		mAllKunde.reserve(total);
+		mKundeByNr.reserve(total);
+	}
+	for (int i = 0; i < kundeBatch.size(); ++i) {
+		Kunde* kunde = (Kunde*) kundeBatch.at(i);
+		// Important: DataManager must be parent of all root DTOs
+		kunde->setParent(this);
+		mAllKunde.append(kunde);
+		indexKunde(kunde);
+	}
+	emit kundeInitProgress(mAllKunde.size(), total);
+}
+
+void DataManager::onKundeLoadDone(int source)
+{
+	// imported: there's no snapshot yet
+	if (source != CacheLoader::BinarySource && mBinaryCache) {
+		mKundeCacheOutdated = true;
+	}
+	qDebug() << "initAsync Kunde* #" << mAllKunde.size() << " source: " << source
+			<< " after ms: " << mInitElapsedTimer.elapsed();
+	emit kundeInitDone();
+}
+
+void DataManager::onAuftragLoaded(QList<QObject*> auftragBatch, int total)
+{
+	if (total > 0 && mAuftragByNr.capacity() < total) {
+		mAllAuftrag.reserve(total);
+		mAuftragByNr.reserve(total);
+	}
+	for (int i = 0; i < auftragBatch.size(); ++i) {
+		Auftrag* auftrag = (Auftrag*) auftragBatch.at(i);
+		if (mAuftragPhaseTwo && mAuftragByNr.contains(auftrag->nr())) {
+			// 2PhaseInit: already loaded in phase one
+			delete auftrag;
+			continue;
+		}
+		if (mDeletedAuftragNr.contains(auftrag->nr())) {
+			// deleted while loading - must not come back from the cache
+			delete auftrag;
+			continue;
+		}
+		// Important: DataManager must be parent of all root DTOs
+		auftrag->setParent(this);
+		mAllAuftrag.append(auftrag);
+		indexAuftrag(auftrag);
+	}
+	emit auftragInitProgress(mAllAuftrag.size(), total);
 }
 
+void DataManager::onAuftragLoadDone(int source)
+{
+	if (mBinaryCache) {
+		mAuftragCacheOutdated = (source != CacheLoader::BinarySource);
+		if (source == CacheLoader::BinarySource) {
+			replayAuftragJournal();
+		}
+	} else {
+		mAuftragCacheOutdated = (source == CacheLoader::JsonSource);
+	}
+	qDebug() << "initAsync Auftrag* #" << mAllAuftrag.size() << " source: " << source
+			<< " after ms: " << mInitElapsedTimer.elapsed();
+	emit auftragInitDone();
+}
+
+void DataManager::onSchlagwortLoaded(QList<QObject*> schlagwortBatch, int total)
+{
+	if (total > 0 && mAllSchlagwort.isEmpty()) {
+		mAllSchlagwort.reserve(total);
+		mSchlagwortByUuid.reserve(total);
+	}
+	for (int i = 0; i < schlagwortBatch.size(); ++i) {
+		Schlagwort* schlagwort = (Schlagwort*) schlagwortBatch.at(i);
+		// Important: DataManager must be parent of all root DTOs
+		schlagwort->setParent(this);
+		mAllSchlagwort.append(schlagwort);
+		indexSchlagwort(schlagwort);
+	}
+	emit schlagwortInitProgress(mAllSchlagwort.size(), total);
+}
+
+void DataManager::onSchlagwortLoadDone(int source)
+{
+	qDebug() << "initAsync Schlagwort* #" << mAllSchlagwort.size() << " source: " << source
+			<< " after ms: " << mInitElapsedTimer.elapsed();
+	// Schlagwort is read-only: not saved at exit, so snapshot it now
+	if (source != CacheLoader::BinarySource && mBinaryCache) {
+		saveSchlagwortToBinaryCache();
+	}
+	emit schlagwortInitDone();
+}
+
+void DataManager::onCacheLoaderFinished()
+{
+	mInitRunning = false;
+	mAuftragPhaseTwo = false;
+	// one value per start - compare runs with different settings
+	qDebug() << "initAsync done in ms: " << mInitElapsedTimer.elapsed() << " peak RSS kB: "
+			<< peakResidentSetKb();
+	emit initDone();
+}
 
 //  S Q L
 /**
@@ -100,6 +469,8 @@ bool DataManager::initDatabase()
         }
     }
     //
+    // statements of the old connection
+    mStatements.clear();
     mDatabase = QSqlDatabase::addDatabase("QSQLITE");
     mDatabase.setDatabaseName(dataPath(dbName));
     if (mDatabase.open() == false) {
@@ -109,6 +480,221 @@ bool DataManager::initDatabase()
         return false;
     }
     qDebug() << "Database opened: " << dbName;
+    mStatements.setDatabase(mDatabase);
+    mSqlUpsertSupported = isSqlUpsertSupported();
+    applyDurabilityProfile();
+    return true;
+}
+
+void DataManager::setDurabilityProfile(const int& profile)
+{
+    mDurabilityProfile = profile;
+}
+
+void DataManager::setWalCheckpointInterval(const int& intervalMs)
+{
+    mWalCheckpointInterval = intervalMs;
+}
+
+/*
+ * WalDurability:
+ * PRAGMA journal_mode = WAL is persistent, synchronous is per connection
+ * NORMAL: a COMMIT doesn't sync, only checkpoints do
+ * the database is always consistent, a power loss can only lose the last commits
+ * wal_autocheckpoint = 0: checkpoints are done by WalCheckpointer
+ *
+ * RollbackJournalDurability:
+ * switch back if the database was in WAL mode before
+ */
+void DataManager::applyDurabilityProfile()
+{
+    QSqlQuery query (mDatabase);
+    if (mDurabilityProfile != WalDurability) {
+        if (query.exec("PRAGMA journal_mode") && query.next()
+                && query.value(0).toString().toLower() == "wal") {
+            if (!query.exec("PRAGMA journal_mode = DELETE")) {
+                qWarning() << "NO SUCCESS PRAGMA journal_mode = DELETE";
+            }
+        }
+        return;
+    }
+    if (!query.exec("PRAGMA journal_mode = WAL") || !query.next()
+            || query.value(0).toString().toLower() != "wal") {
+        qWarning() << "NO SUCCESS PRAGMA journal_mode = WAL - using rollback journal";
+        mDurabilityProfile = RollbackJournalDurability;
+        return;
+    }
+    if (!query.exec("PRAGMA synchronous = NORMAL")) {
+        qWarning() << "NO SUCCESS PRAGMA synchronous = NORMAL";
+    }
+    if (!query.exec("PRAGMA wal_autocheckpoint = 0")) {
+        qWarning() << "NO SUCCESS PRAGMA wal_autocheckpoint";
+    }
+    qDebug() << "PRAGMA journal_mode: WAL synchronous: NORMAL";
+    startWalCheckpointer();
+}
+
+void DataManager::startWalCheckpointer()
+{
+    if (mWalCheckpointer) {
+        return;
+    }
+    mWalCheckpointerThread = new QThread(this);
+    mWalCheckpointer = new WalCheckpointer(dataPath(dbName), mWalCheckpointInterval);
+    mWalCheckpointer->moveToThread(mWalCheckpointerThread);
+    bool res = QObject::connect(mWalCheckpointerThread, SIGNAL(started()), mWalCheckpointer,
+            SLOT(start()));
+    Q_ASSERT(res);
+    res = QObject::connect(mWalCheckpointer, SIGNAL(checkpointDone(int, qint64, int, int)), this,
+            SLOT(onWalCheckpointDone(int, qint64, int, int)));
+    Q_ASSERT(res);
+    Q_UNUSED(res);
+    mWalCheckpointerThread->start();
+}
+
+/*
+ * waits until the worker has closed its connection
+ * then the last checkpoint runs on our connection:
+ * TRUNCATE resets the WAL file to zero bytes
+ */
+void DataManager::stopWalCheckpointer()
+{
+    if (!mWalCheckpointer) {
+        return;
+    }
+    QMetaObject::invokeMethod(mWalCheckpointer, "stop", Qt::BlockingQueuedConnection);
+    mWalCheckpointerThread->quit();
+    mWalCheckpointerThread->wait();
+    delete mWalCheckpointer;
+    mWalCheckpointer = 0;
+    delete mWalCheckpointerThread;
+    mWalCheckpointerThread = 0;
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+    qint64 walSize = WalCheckpointer::walFileSize(dataPath(dbName));
+    QSqlQuery query (mDatabase);
+    if (!query.exec("PRAGMA wal_checkpoint(TRUNCATE)")) {
+        qWarning() << "NO SUCCESS PRAGMA wal_checkpoint(TRUNCATE)";
+        return;
+    }
+    qDebug() << "WAL final checkpoint in ms: " << elapsedTimer.elapsed() << " WAL kB before: "
+            << walSize / 1024;
+}
+
+void DataManager::checkpointWal()
+{
+    if (!mWalCheckpointer) {
+        return;
+    }
+    QMetaObject::invokeMethod(mWalCheckpointer, "checkpoint", Qt::QueuedConnection);
+}
+
+int DataManager::walSizeKb()
+{
+    return WalCheckpointer::walFileSize(dataPath(dbName)) / 1024;
+}
+
+void DataManager::onWalCheckpointDone(int latencyMs, qint64 walSize, int walFrames,
+        int checkpointedFrames)
+{
+    if (checkpointedFrames < walFrames) {
+        // readers were active - the rest is done with the next checkpoint
+        qDebug() << "WAL checkpoint incomplete: " << checkpointedFrames << " of " << walFrames;
+    }
+    emit walCheckpointDone(latencyMs, walSize / 1024);
+}
+
+/*
+ * INSERT ... ON CONFLICT DO UPDATE needs SQLite 3.24 or newer
+ * older versions use INSERT OR REPLACE
+ */
+bool DataManager::isSqlUpsertSupported()
+{
+    QSqlQuery query (mDatabase);
+    if (!query.exec("SELECT sqlite_version()") || !query.next()) {
+        return false;
+    }
+    QString version = query.value(0).toString();
+    QStringList versionParts = version.split(".");
+    int major = versionParts.value(0).toInt();
+    int minor = versionParts.value(1).toInt();
+    bool supported = major > 3 || (major == 3 && minor >= 24);
+    qDebug() << "SQLite version " << version << " UPSERT: " << supported;
+    return supported;
+}
+
+void DataManager::setIncrementalSqlSync(const bool& incremental)
+{
+    mIncrementalSqlSync = incremental;
+}
+
+/*
+ * rewrites SQLite caches completely: DROP, CREATE, INSERT
+ * then VACUUM to give free pages back to the file system
+ * incremental sync leaves free pages behind - compact from time to time
+ */
+bool DataManager::compactSqlCache()
+{
+    if (!mDatabaseAvailable) {
+        return false;
+    }
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+    // dirty state is taken before writing - see saveCaches()
+    QSet<Kunde*> dirtyKunde = mDirtyKunde;
+    QSet<int> deletedKundeNr = mDeletedKundeNr;
+    bool kundeOutdated = mKundeCacheOutdated;
+    QSet<Auftrag*> dirtyAuftrag = mDirtyAuftrag;
+    QSet<int> deletedAuftragNr = mDeletedAuftragNr;
+    bool auftragOutdated = mAuftragCacheOutdated;
+    if (!mBinaryCache) {
+        // SQLite is the cache: in sync if saved
+        clearKundeDirtyState();
+        clearAuftragDirtyState();
+    }
+    // lazy: most Kunde* are only in the table - not rebuilt
+    bool kundeSaved = isKundeOnlyInSqlCache() ?
+            saveKundeDeltaToSqlCache(dirtyKunde, deletedKundeNr, kundeOutdated) : saveKundeToSqlCache();
+    bool auftragSaved = saveAuftragToSqlCache();
+    if (!mBinaryCache) {
+        if (!kundeSaved) {
+            restoreKundeDirtyState(dirtyKunde, deletedKundeNr, kundeOutdated);
+        }
+        if (!auftragSaved) {
+            restoreAuftragDirtyState(dirtyAuftrag, deletedAuftragNr, auftragOutdated);
+        }
+    }
+    // VACUUM fails if statements are active
+    mStatements.finishAll();
+    QSqlQuery query (mDatabase);
+    if (!query.exec("VACUUM")) {
+        qWarning() << "NO SUCCESS VACUUM";
+    }
+    qDebug() << "SQLite cache compacted in ms: " << elapsedTimer.elapsed();
+    return kundeSaved && auftragSaved;
+}
+
+/*
+ * DELETE rows in chunks: DELETE ... WHERE key IN (?, ?, ...)
+ * SQLite allows max 999 parameters per statement
+ * caller is responsible for the transaction
+ */
+bool DataManager::deleteKeysFromSqlCache(const QString (*deleteCommand)(const int&),
+        const QVariantList& keys)
+{
+    static const int maxKeysPerDelete = 500;
+    for (int fromPos = 0; fromPos < keys.size(); fromPos += maxKeysPerDelete) {
+        int keyCount = qMin(maxKeysPerDelete, keys.size() - fromPos);
+        // all full chunks share one prepared statement
+        QSqlQuery& query = mStatements.prepared(deleteCommand(keyCount));
+        for (int i = 0; i < keyCount; ++i) {
+            query.bindValue(i, keys.at(fromPos + i));
+        }
+        if (!query.exec()) {
+            qWarning() << "NO SUCCESS DELETE " << query.lastQuery() << query.lastError().text();
+            return false;
+        }
+    }
     return true;
 }
 
@@ -117,6 +703,49 @@ void DataManager::setChunkSize(const int& newChunkSize)
     mChunkSize = newChunkSize;
 }
 
+void DataManager::setAdaptiveChunkSize(const bool& adaptive)
+{
+    mAdaptiveChunkSize = adaptive;
+}
+
+void DataManager::setChunkLatencyBounds(const int& minLatencyMs, const int& maxLatencyMs)
+{
+    mChunkMinLatencyMs = minLatencyMs;
+    mChunkMaxLatencyMs = maxLatencyMs;
+}
+
+/*
+ * statistics of the last bulk import per table (kunde, auftrag)
+ * see ChunkSizer::stats()
+ */
+QVariantMap DataManager::chunkStats()
+{
+    return mChunkStats;
+}
+
+/*
+ * adaptive chunk size: events are processed between two transactions
+ * so the UI stays responsive while importing
+ * user input is excluded - timers and signals may still change the data:
+ * savers write from records and dirty state taken before the first chunk
+ */
+void DataManager::yieldBetweenChunks()
+{
+    if (mAdaptiveChunkSize) {
+        QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+    }
+}
+
+void DataManager::setStreamingJsonCache(const bool& streaming)
+{
+    mStreamingJsonCache = streaming;
+}
+
+void DataManager::setBinaryCache(const bool& binary)
+{
+    mBinaryCache = binary;
+}
+
 /**
  * tune PRAGMA synchronous and journal_mode for better speed with bulk import
  * see https://www.sqlite.org/pragma.html
@@ -127,126 +756,949 @@ void DataManager::setChunkSize(const int& newChunkSize)
  *
  * PRAGMA database.journal_mode = DELETE | TRUNCATE | PERSIST | MEMORY | WAL | OFF
  * default: DELETE
+ *
+ * not used with WalDurability - see applyDurabilityProfile()
  */
 void DataManager::bulkImport(const bool& tuneJournalAndSync)
 {
-    QSqlQuery query (mDatabase);
-    bool success;
-    QString journalMode;
-    QString syncMode;
-    query.prepare("PRAGMA journal_mode");
-    success = query.exec();
-    if(!success) {
-        qWarning() << "NO SUCCESS PRAGMA journal_mode";
-        return;
-    }
-    success = query.first();
-    if(!success) {
-        qWarning() << "NO RESULT PRAGMA journal_mode";
+    if (mDurabilityProfile == WalDurability) {
+        // WAL + synchronous NORMAL is fast enough for bulk imports
+        // and stays safe: nothing to switch
         return;
     }
-    journalMode = query.value(0).toString();
-    //
-    query.clear();
-    query.prepare("PRAGMA synchronous");
-    success = query.exec();
-    if(!success) {
-        qWarning() << "NO SUCCESS PRAGMA synchronous";
+    bool success;
+    QString journalMode = execPragma("PRAGMA journal_mode", success).toString();
+    if (!success) {
         return;
     }
-        success = query.first();
-    if(!success) {
-        qWarning() << "NO RESULT PRAGMA synchronous";
+    QString syncMode = syncModeName(execPragma("PRAGMA synchronous", success));
+    if (!success) {
         return;
     }
-    switch (query.value(0).toInt()) {
-        case 0:
-            syncMode = "OFF";
-            break;
-        case 1:
-            syncMode = "NORMAL";
-            break;
-        case 2:
-            syncMode = "FULL";
-            break;
-        default:
-            syncMode = query.value(0).toString();
-            break;
-    }
     qDebug() << "PRAGMA current values - " << "journal: " << journalMode << " synchronous: " << syncMode;
     //
-    query.clear();
     if (tuneJournalAndSync) {
-        query.prepare("PRAGMA journal_mode = MEMORY");
+        execPragma("PRAGMA journal_mode = MEMORY", success);
     } else {
-        query.prepare("PRAGMA journal_mode = DELETE");
-    }
-    success = query.exec();
-    if(!success) {
-        qWarning() << "NO SUCCESS PRAGMA set journal_mode";
-        return;
-    }
-    //
-    query.prepare("PRAGMA journal_mode");
-    success = query.exec();
-    if(!success) {
-        qWarning() << "NO SUCCESS PRAGMA journal_mode";
-        return;
+        execPragma("PRAGMA journal_mode = DELETE", success);
     }
-    success = query.first();
-    if(!success) {
-        qWarning() << "NO RESULT PRAGMA journal_mode";
+    if (!success) {
         return;
     }
-    qDebug() << "PRAGMA NEW VALUE journal_mode: " << query.value(0).toString();
+    qDebug() << "PRAGMA NEW VALUE journal_mode: " << execPragma("PRAGMA journal_mode", success).toString();
     //
-    query.clear();
     if (tuneJournalAndSync) {
-        query.prepare("PRAGMA synchronous = OFF");
+        execPragma("PRAGMA synchronous = OFF", success);
     } else {
-        query.prepare("PRAGMA synchronous = FULL");
+        execPragma("PRAGMA synchronous = FULL", success);
     }
-    success = query.exec();
-    if(!success) {
-        qWarning() << "NO SUCCESS PRAGMA set synchronous";
+    if (!success) {
         return;
     }
-    //
-    query.prepare("PRAGMA synchronous");
+    qDebug() << "PRAGMA synchronous NEW VALUE: " << syncModeName(execPragma("PRAGMA synchronous", success));
+}
+
+/*
+ * PRAGMA statements are prepared once (SqlStatementCache)
+ * returns the first column of the result - invalid if no result
+ */
+QVariant DataManager::execPragma(const QString& pragma, bool& success)
+{
+    QSqlQuery& query = mStatements.prepared(pragma);
     success = query.exec();
-    if(!success) {
-        qWarning() << "NO SUCCESS PRAGMA synchronous";
-        return;
+    if (!success) {
+        qWarning() << "NO SUCCESS " << pragma;
+        return QVariant();
     }
-    success = query.first();
-    if(!success) {
-        qWarning() << "NO RESULT PRAGMA synchronous";
-        return;
+    QVariant value;
+    if (query.next()) {
+        value = query.value(0);
     }
-    switch (query.value(0).toInt()) {
+    query.finish();
+    return value;
+}
+
+QString DataManager::syncModeName(const QVariant& syncMode)
+{
+    switch (syncMode.toInt()) {
         case 0:
-            syncMode = "OFF";
-            break;
+            return "OFF";
         case 1:
-            syncMode = "NORMAL";
-            break;
+            return "NORMAL";
         case 2:
-            syncMode = "FULL";
-            break;
+            return "FULL";
         default:
-            syncMode = query.value(0).toString();
-            break;
+            return syncMode.toString();
     }
-    qDebug() << "PRAGMA synchronous NEW VALUE: " << syncMode;
 }
 
 void DataManager::finish()
 {
-    saveKundeToCache();
-    saveAuftragToCache();
+    if (mAutosaveTimer) {
+        mAutosaveTimer->stop();
+    }
+    if (mInitRunning) {
+        waitForCacheLoader();
+    }
+    if (mInitRunning) {
+        // caches are only partially loaded - saving would lose data
+        qWarning() << "CacheLoader not finished: caches not saved";
+        stopWalCheckpointer();
+        return;
+    }
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+    qDebug() << "finish: Kunde dirty #" << mDirtyKunde.size() << " deleted #" << mDeletedKundeNr.size()
+            << " outdated: " << mKundeCacheOutdated << " Auftrag dirty #" << mDirtyAuftrag.size()
+            << " deleted #" << mDeletedAuftragNr.size() << " outdated: " << mAuftragCacheOutdated;
+    if (mBinaryCache) {
+        saveSnapshotsAtExit();
+    } else {
+        saveCaches();
+    }
+    stopWalCheckpointer();
+    qDebug() << "finish done in ms: " << elapsedTimer.elapsed();
+}
+
+/*
+ * saves all dirty SQLite or JSON caches on the UI thread
+ * binary snapshots are saved by SnapshotWriter (saveInBackground())
+ * dirty state is taken and cleared before writing: events are processed
+ * between two chunks, changes done meanwhile make the cache dirty again
+ * if writing fails, the state taken is restored
+ */
+void DataManager::saveCaches()
+{
+    // nothing changed: nothing to write
+    if (isKundeCacheDirty()) {
+        QSet<Kunde*> dirtyKunde = mDirtyKunde;
+        QSet<int> deletedKundeNr = mDeletedKundeNr;
+        bool outdated = mKundeCacheOutdated;
+        clearKundeDirtyState();
+        bool saved = false;
+        if (mDatabaseAvailable) {
+            // Kunde is @SqlCache: write only the delta
+            // lazy: the table is the only complete copy - always the delta
+            saved = (mIncrementalSqlSync || isKundeOnlyInSqlCache()) ?
+                    saveKundeDeltaToSqlCache(dirtyKunde, deletedKundeNr, outdated) : saveKundeToSqlCache();
+        } else {
+            saved = saveKundeToCache();
+        }
+        if (!saved) {
+            restoreKundeDirtyState(dirtyKunde, deletedKundeNr, outdated);
+        }
+    }
+    // a JSON cache is a complete file: rewritten only if dirty
+    if (isAuftragCacheDirty()) {
+        QSet<Auftrag*> dirtyAuftrag = mDirtyAuftrag;
+        QSet<int> deletedAuftragNr = mDeletedAuftragNr;
+        bool outdated = mAuftragCacheOutdated;
+        clearAuftragDirtyState();
+        bool saved = false;
+        if (mDatabaseAvailable) {
+            // Auftrag is @SqlCache: write only the delta
+            saved = mIncrementalSqlSync ?
+                    saveAuftragDeltaToSqlCache(dirtyAuftrag, deletedAuftragNr, outdated) : saveAuftragToSqlCache();
+        } else {
+            saved = saveAuftragToCache();
+        }
+        if (!saved) {
+            restoreAuftragDirtyState(dirtyAuftrag, deletedAuftragNr, outdated);
+        }
+    }
     // Schlagwort is read-only - not saved to cache
 }
 
+/*
+ * takes value records of the dirty snapshots on the UI thread
+ * and writes them on a worker thread (SnapshotWriter)
+ * periodic autosave: see setAutosaveInterval()
+ * SQLite and JSON caches are saved on the UI thread
+ */
+void DataManager::saveInBackground()
+{
+    if (mInitRunning || mSqlImportRunning) {
+        return;
+    }
+    if (!mBinaryCache) {
+        saveCaches();
+        return;
+    }
+    if (mSnapshotThread) {
+        // save again if the running save is finished
+        mSnapshotPending = true;
+        return;
+    }
+    if (!hasUnsavedChanges()) {
+        return;
+    }
+    startSnapshotSave();
+}
+
+void DataManager::setAutosaveInterval(const int& intervalMs)
+{
+    if (intervalMs <= 0) {
+        if (mAutosaveTimer) {
+            mAutosaveTimer->stop();
+        }
+        return;
+    }
+    if (!mAutosaveTimer) {
+        mAutosaveTimer = new QTimer(this);
+        bool res = QObject::connect(mAutosaveTimer, SIGNAL(timeout()), this,
+                SLOT(saveInBackground()));
+        Q_ASSERT(res);
+        Q_UNUSED(res);
+    }
+    mAutosaveTimer->start(intervalMs);
+}
+
+void DataManager::setSaveTimeout(const int& timeoutMs)
+{
+    mSaveTimeoutMs = timeoutMs;
+}
+
+QList<KundeRecord> DataManager::kundeRecords()
+{
+    if (mKundePager && mKundePager->hasRecords()) {
+        // Kunde* in memory may be changed
+        QHashIterator<int, Kunde*> it(mKundeByNr);
+        while (it.hasNext()) {
+            mKundePager->storeRecord(it.next().value()->toRecord());
+        }
+        return mKundePager->records();
+    }
+    QList<KundeRecord> records;
+    if (mKundePager) {
+        // lazy: page by page - Kunde* read here are deleted again, not indexed
+        records.reserve(mKundePager->count());
+        for (int fromPos = 0; fromPos < mKundePager->count(); fromPos += KundePager::pageSize) {
+            QList<Kunde*> pageList = mKundePager->loadPage(fromPos / KundePager::pageSize);
+            QHash<int, Kunde*> pageByNr;
+            for (int i = 0; i < pageList.size(); ++i) {
+                pageByNr.insert(pageList.at(i)->nr(), pageList.at(i));
+            }
+            int toPos = qMin(fromPos + KundePager::pageSize, mKundePager->count());
+            for (int pos = fromPos; pos < toPos; ++pos) {
+                int nr = mKundePager->keyAt(pos);
+                // in memory: maybe changed
+                Kunde* kunde = mKundeByNr.value(nr, pageByNr.value(nr, 0));
+                if (kunde) {
+                    records.append(kunde->toRecord());
+                }
+            }
+            qDeleteAll(pageList);
+        }
+        return records;
+    }
+    records.reserve(mAllKunde.size());
+    for (int i = 0; i < mAllKunde.size(); ++i) {
+        records.append(((Kunde*) mAllKunde.at(i))->toRecord());
+    }
+    return records;
+}
+
+static bool kundeRecordLessByNr(const KundeRecord& first, const KundeRecord& second)
+{
+    return first.nr < second.nr;
+}
+
+// sorted by nr: inserted Kunde are appended to the snapshot in this order
+QList<KundeRecord> DataManager::dirtyKundeRecords()
+{
+    QList<KundeRecord> records;
+    records.reserve(mDirtyKunde.size());
+    QSetIterator<Kunde*> dirtyIterator(mDirtyKunde);
+    while (dirtyIterator.hasNext()) {
+        records.append(dirtyIterator.next()->toRecord());
+    }
+    std::sort(records.begin(), records.end(), kundeRecordLessByNr);
+    return records;
+}
+
+QList<AuftragRecord> DataManager::auftragRecords()
+{
+    QList<AuftragRecord> records;
+    records.reserve(mAllAuftrag.size());
+    for (int i = 0; i < mAllAuftrag.size(); ++i) {
+        records.append(((Auftrag*) mAllAuftrag.at(i))->toRecord());
+    }
+    return records;
+}
+
+/*
+ * dirty state is cleared as soon as the records are taken:
+ * changes done while the worker is running make the caches dirty again
+ * if the worker fails, the cache is marked as outdated (snapshotSaveDone())
+ */
+void DataManager::startSnapshotSave()
+{
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+    SnapshotWriter* snapshotWriter = new SnapshotWriter();
+    if (isKundeCacheDirty()) {
+        if (!mKundeCacheOutdated && QFile::exists(dataPath(binaryCacheKunde))) {
+            // only the changed records - merged into the snapshot by the worker
+            snapshotWriter->setKundeDelta(dataPath(binaryCacheKunde), mDeletedKundeNr.toList(),
+                    dirtyKundeRecords());
+        } else {
+            snapshotWriter->setKundeRecords(dataPath(binaryCacheKunde), kundeRecords());
+        }
+        clearKundeDirtyState();
+    }
+    if (isAuftragCacheDirty()) {
+        quint32 generation = auftragSnapshotGeneration();
+        if (useAuftragJournal()) {
+            snapshotWriter->setAuftragJournalRecords(dataPath(auftragJournal), generation,
+                    deletedAuftragNrs(), dirtyAuftragRecords());
+            // phase one must not show changed or deleted Auftrag of the journal
+            snapshotWriter->setAuftragPriorityRecords(dataPath(binaryCacheAuftragPriority),
+                    auftragPriorityRecords());
+        } else {
+            // compaction: journal is folded into a new snapshot
+            snapshotWriter->setAuftragRecords(dataPath(binaryCacheAuftrag), auftragRecords());
+            snapshotWriter->setAuftragGeneration(generation + 1, dataPath(auftragJournal));
+            snapshotWriter->setAuftragPriorityRecords(dataPath(binaryCacheAuftragPriority),
+                    auftragPriorityRecords());
+        }
+        clearAuftragDirtyState();
+    }
+    qDebug() << "snapshot records taken in ms: " << elapsedTimer.elapsed();
+    mSnapshotWriter = snapshotWriter;
+    mSnapshotThread = new QThread(this);
+    snapshotWriter->moveToThread(mSnapshotThread);
+    bool res = QObject::connect(mSnapshotThread, SIGNAL(started()), snapshotWriter, SLOT(save()));
+    Q_ASSERT(res);
+    // direct: quit() must work while the UI thread waits at exit
+    res = QObject::connect(snapshotWriter, SIGNAL(finished()), mSnapshotThread, SLOT(quit()),
+            Qt::DirectConnection);
+    Q_ASSERT(res);
+    res = QObject::connect(mSnapshotThread, SIGNAL(finished()), this,
+            SLOT(onSnapshotThreadFinished()));
+    Q_ASSERT(res);
+    Q_UNUSED(res);
+    mSnapshotThread->start();
+}
+
+void DataManager::onSnapshotThreadFinished()
+{
+    if (!mSnapshotThread || sender() != mSnapshotThread) {
+        // already done by waitForSnapshotSave()
+        return;
+    }
+    snapshotSaveDone();
+    if (mSnapshotPending) {
+        mSnapshotPending = false;
+        saveInBackground();
+    }
+}
+
+/*
+ * thread is finished: results of SnapshotWriter can be read
+ */
+void DataManager::snapshotSaveDone()
+{
+    mSnapshotThread->wait();
+    bool success = true;
+    if (mSnapshotWriter->hasKunde() && !mSnapshotWriter->kundeSaved()) {
+        mKundeCacheOutdated = true;
+        success = false;
+    }
+    if (mSnapshotWriter->hasAuftrag() && !mSnapshotWriter->auftragSaved()) {
+        mAuftragCacheOutdated = true;
+        success = false;
+    }
+    delete mSnapshotWriter;
+    mSnapshotWriter = 0;
+    delete mSnapshotThread;
+    mSnapshotThread = 0;
+    emit backgroundSaveDone(success);
+}
+
+/*
+ * returns false if the running save didn't finish in time
+ */
+bool DataManager::waitForSnapshotSave()
+{
+    if (!mSnapshotThread) {
+        return true;
+    }
+    if (!mSnapshotThread->wait(mSaveTimeoutMs)) {
+        return false;
+    }
+    snapshotSaveDone();
+    return true;
+}
+
+/*
+ * exit: waits for a running background save (bounded by setSaveTimeout())
+ * remaining changes are saved in background and waited for the same way
+ * if the worker doesn't finish in time, a journal of all data
+ * is written on the UI thread - it replaces the snapshots at next start
+ * the worker is aborted then: its thread must not outlive DataManager
+ */
+void DataManager::saveSnapshotsAtExit()
+{
+    mSnapshotPending = false;
+    bool done = waitForSnapshotSave();
+    if (done && hasUnsavedChanges()) {
+        startSnapshotSave();
+        done = waitForSnapshotSave();
+    }
+    if (done) {
+        return;
+    }
+    qWarning() << "background save not finished in ms: " << mSaveTimeoutMs << " - writing journal";
+    SnapshotWriter journalWriter;
+    journalWriter.setKundeRecords(dataPath(binaryCacheKunde) + snapshotJournalSuffix,
+            kundeRecords());
+    journalWriter.setAuftragRecords(dataPath(binaryCacheAuftrag) + snapshotJournalSuffix,
+            auftragRecords());
+    journalWriter.save();
+    mSnapshotWriter->abort();
+    // aborted writer may still be in fsync: never wait without limit
+    if (mSnapshotThread->wait(mSaveTimeoutMs)) {
+        snapshotSaveDone();
+    } else {
+        abandonSnapshotWriter();
+    }
+}
+
+/*
+ * exit: the aborted worker hangs in fsync - it can't be interrupted
+ * thread and writer are no longer children of DataManager
+ * and end with the process
+ * the journal written at exit replaces the snapshots at next start
+ */
+void DataManager::abandonSnapshotWriter()
+{
+    qWarning() << "SnapshotWriter still running - left behind";
+    mSnapshotThread->setParent(0);
+    QObject::connect(mSnapshotThread, SIGNAL(finished()), mSnapshotWriter, SLOT(deleteLater()));
+    QObject::connect(mSnapshotThread, SIGNAL(finished()), mSnapshotThread, SLOT(deleteLater()));
+    mSnapshotWriter = 0;
+    mSnapshotThread = 0;
+}
+
+/*
+ * journal is only renamed from temp file if completely written
+ * so an existing journal is newer than the snapshot
+ * Auftrag priority snapshot doesn't match the journal: removed
+ * and written again at next save
+ */
+void DataManager::recoverSnapshotJournal()
+{
+    if (promoteSnapshotJournal(binaryCacheKunde)) {
+        qDebug() << "Kunde snapshot recovered from journal";
+    }
+    if (promoteSnapshotJournal(binaryCacheAuftrag)) {
+        qDebug() << "Auftrag snapshot recovered from journal";
+        // recovered snapshot contains all changes
+        QFile::remove(dataPath(auftragJournal));
+        QFile::remove(dataPath(binaryCacheAuftragPriority));
+        mAuftragCacheOutdated = true;
+    }
+}
+
+void DataManager::setAuftragJournalLimit(const int& limitKb)
+{
+    mAuftragJournalLimitKb = limitKb;
+}
+
+/*
+ * next save writes a full snapshot and removes the journal
+ */
+void DataManager::compactAuftragJournal()
+{
+    mAuftragCacheOutdated = true;
+    saveInBackground();
+}
+
+/*
+ * journal is used if there's a valid snapshot to append to
+ * and the journal is below the limit - else compaction
+ */
+bool DataManager::useAuftragJournal()
+{
+    if (mAuftragJournalLimitKb <= 0 || mAuftragCacheOutdated) {
+        return false;
+    }
+    if (!QFile::exists(dataPath(binaryCacheAuftrag))) {
+        return false;
+    }
+    QFileInfo journalInfo(dataPath(auftragJournal));
+    return !journalInfo.exists() || journalInfo.size() < mAuftragJournalLimitKb * 1024;
+}
+
+quint32 DataManager::auftragSnapshotGeneration()
+{
+    BinaryCacheReader reader(dataPath(binaryCacheAuftrag));
+    if (!reader.open(BinaryCache::AuftragType)) {
+        return 0;
+    }
+    return reader.generation();
+}
+
+/*
+ * deleted keys not used again - reused keys are written as changed records
+ */
+QList<int> DataManager::deletedAuftragNrs()
+{
+    QList<int> nrList;
+    QSetIterator<int> deletedIterator(mDeletedAuftragNr);
+    while (deletedIterator.hasNext()) {
+        int nr = deletedIterator.next();
+        if (!mAuftragByNr.contains(nr)) {
+            nrList.append(nr);
+        }
+    }
+    return nrList;
+}
+
+QList<AuftragRecord> DataManager::dirtyAuftragRecords()
+{
+    QList<AuftragRecord> records;
+    records.reserve(mDirtyAuftrag.size());
+    QSetIterator<Auftrag*> dirtyIterator(mDirtyAuftrag);
+    while (dirtyIterator.hasNext()) {
+        records.append(dirtyIterator.next()->toRecord());
+    }
+    return records;
+}
+
+/*
+ * replays the Auftrag journal after the snapshot was loaded
+ * the journal is folded into the final state per key first (0: deleted),
+ * then applied in one pass over all Auftrag
+ * journal of another generation (snapshot written, journal not yet removed) is ignored
+ * a cut off entry (killed while appending) ends the replay:
+ * the next save writes a full snapshot
+ * Auftrag changed or deleted while phase two was running are kept
+ */
+void DataManager::replayAuftragJournal()
+{
+    QString journalPath = dataPath(auftragJournal);
+    if (!QFile::exists(journalPath)) {
+        return;
+    }
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+    BinaryCacheReader reader(journalPath);
+    if (!reader.open(BinaryCache::AuftragJournalType)) {
+        mAuftragCacheOutdated = true;
+        return;
+    }
+    if (reader.generation() != auftragSnapshotGeneration()) {
+        qDebug() << "Auftrag journal generation " << reader.generation() << " outdated - ignored";
+        reader.close();
+        QFile::remove(journalPath);
+        return;
+    }
+    QHash<int, Auftrag*> journalState;
+    int entries = 0;
+    while (!reader.atEnd() && !reader.hasError()) {
+        qint32 operation = reader.readInt();
+        Auftrag* auftrag = 0;
+        int nr;
+        if (operation == BinaryCache::JournalUpsert) {
+            auftrag = new Auftrag();
+            auftrag->fillFromBinaryCache(reader);
+            nr = auftrag->nr();
+        } else if (operation == BinaryCache::JournalDelete) {
+            nr = reader.readInt();
+        } else {
+            qWarning() << "unknown operation in Auftrag journal: " << operation;
+            break;
+        }
+        if (reader.hasError()) {
+            delete auftrag;
+            break;
+        }
+        // older state of the same key isn't needed anymore
+        delete journalState.value(nr, 0);
+        journalState.insert(nr, auftrag);
+        entries++;
+    }
+    if (!reader.atEnd() || reader.hasError()) {
+        qWarning() << "Auftrag journal cut off after entries #" << entries;
+        mAuftragCacheOutdated = true;
+    }
+    // update or remove existing Auftrag
+    // phase one Auftrag* are already used by QML: updated in place
+    for (int i = mAllAuftrag.size() - 1; i >= 0; --i) {
+        Auftrag* existing = (Auftrag*) mAllAuftrag.at(i);
+        if (!journalState.contains(existing->nr())) {
+            continue;
+        }
+        Auftrag* auftrag = journalState.take(existing->nr());
+        if (mDirtyAuftrag.contains(existing)) {
+            delete auftrag;
+            continue;
+        }
+        // not indexed while updated: no dirty tracking
+        unindexAuftrag(existing);
+        if (auftrag) {
+            existing->fillFromRecord(auftrag->toRecord());
+            delete auftrag;
+            indexAuftrag(existing);
+        } else {
+            // same SIGNALS as deleteAuftragByNr() - delete is already persisted
+            int nr = existing->nr();
+            mAllAuftrag.removeAt(i);
+            mAuftragPosition.remove(existing);
+            emit deletedFromAllAuftragByNr(nr);
+            emit deletedFromAllAuftrag(existing);
+            existing->deleteLater();
+        }
+    }
+    // inserted since snapshot
+    QHashIterator<int, Auftrag*> stateIterator(journalState);
+    while (stateIterator.hasNext()) {
+        stateIterator.next();
+        Auftrag* auftrag = stateIterator.value();
+        if (!auftrag) {
+            continue;
+        }
+        if (mDeletedAuftragNr.contains(auftrag->nr()) || mAuftragByNr.contains(auftrag->nr())) {
+            delete auftrag;
+            continue;
+        }
+        auftrag->setParent(this);
+        mAllAuftrag.append(auftrag);
+        indexAuftrag(auftrag);
+    }
+    qDebug() << "Auftrag journal replayed entries #" << entries << " in ms: "
+            << elapsedTimer.elapsed();
+}
+
+/*
+ * if killed between remove and rename the journal still exists
+ * and is promoted at next start
+ */
+bool DataManager::promoteSnapshotJournal(const QString& fileName)
+{
+    QString journalPath = dataPath(fileName) + snapshotJournalSuffix;
+    if (!QFile::exists(journalPath)) {
+        return false;
+    }
+    QFile::remove(dataPath(fileName));
+    if (!QFile::rename(journalPath, dataPath(fileName))) {
+        qWarning() << "cannot rename journal " << journalPath;
+        return false;
+    }
+    return true;
+}
+
+bool DataManager::hasUnsavedChanges()
+{
+    return isKundeCacheDirty() || isAuftragCacheDirty();
+}
+
+bool DataManager::isKundeCacheDirty()
+{
+    return mKundeCacheOutdated || !mDirtyKunde.isEmpty() || !mDeletedKundeNr.isEmpty();
+}
+
+void DataManager::clearKundeDirtyState()
+{
+    mDirtyKunde.clear();
+    mDeletedKundeNr.clear();
+    mKundeCacheOutdated = false;
+}
+
+/*
+ * saving failed: dirty state taken before saving is merged back
+ * Kunde* deleted meanwhile are no longer indexed - they are skipped
+ */
+void DataManager::restoreKundeDirtyState(const QSet<Kunde*>& dirtyKunde,
+        const QSet<int>& deletedKundeNr, const bool& outdated)
+{
+    QSet<Kunde*> indexed = mKundeByNr.values().toSet();
+    QSetIterator<Kunde*> it(dirtyKunde);
+    while (it.hasNext()) {
+        Kunde* kunde = it.next();
+        if (indexed.contains(kunde)) {
+            mDirtyKunde.insert(kunde);
+        }
+    }
+    mDeletedKundeNr.unite(deletedKundeNr);
+    mKundeCacheOutdated = mKundeCacheOutdated || outdated;
+}
+
+bool DataManager::isAuftragCacheDirty()
+{
+    return mAuftragCacheOutdated || !mDirtyAuftrag.isEmpty() || !mDeletedAuftragNr.isEmpty();
+}
+
+void DataManager::clearAuftragDirtyState()
+{
+    mDirtyAuftrag.clear();
+    mDeletedAuftragNr.clear();
+    mAuftragCacheOutdated = false;
+}
+
+void DataManager::restoreAuftragDirtyState(const QSet<Auftrag*>& dirtyAuftrag,
+        const QSet<int>& deletedAuftragNr, const bool& outdated)
+{
+    QSet<Auftrag*> indexed = mAuftragByNr.values().toSet();
+    QSetIterator<Auftrag*> it(dirtyAuftrag);
+    while (it.hasNext()) {
+        Auftrag* auftrag = it.next();
+        if (indexed.contains(auftrag)) {
+            mDirtyAuftrag.insert(auftrag);
+        }
+    }
+    mDeletedAuftragNr.unite(deletedAuftragNr);
+    mAuftragCacheOutdated = mAuftragCacheOutdated || outdated;
+}
+
+/*
+ * writes all caches as JSON
+ * independent from binary snapshots - per ex. to send data to a server
+ */
+void DataManager::exportCacheToJson()
+{
+    if (isKundeOnlyInSqlCache()) {
+        qWarning() << "lazy Kunde: Kunde not exported";
+    } else {
+        saveKundeToCache();
+    }
+    saveAuftragToCache();
+    saveSchlagwortToCache();
+}
+
+/*
+ * replaces all data with data from JSON caches
+ * snapshots are written from imported data at next exit
+ */
+void DataManager::importCacheFromJson()
+{
+    deleteAuftrag();
+    deleteKunde();
+    // imported Kunde* are all in memory
+    delete mKundePager;
+    mKundePager = 0;
+    deleteSchlagwort();
+    initKundeFromCache();
+    initAuftragFromCache();
+    initSchlagwortFromCache();
+    if (mBinaryCache) {
+        saveSchlagwortToBinaryCache();
+    }
+    // all caches must be rewritten
+    clearKundeDirtyState();
+    clearAuftragDirtyState();
+    mKundeCacheOutdated = true;
+    mAuftragCacheOutdated = true;
+}
+
+/*
+ * reads Kunde from binary snapshot (memory mapped)
+ * returns false if there's no valid snapshot or it is truncated
+ */
+bool DataManager::initKundeFromBinaryCache()
+{
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+    BinaryCacheReader reader(dataPath(binaryCacheKunde));
+    if (!reader.open(BinaryCache::KundeType)) {
+        return false;
+    }
+    mAllKunde.clear();
+    mKundeByNr.clear();
+    mKundePosition.clear();
+    mAllKunde.reserve(reader.recordCount());
+    mKundeByNr.reserve(reader.recordCount());
+    for (quint32 i = 0; i < reader.recordCount() && !reader.hasError(); ++i) {
+        Kunde* kunde = new Kunde();
+        // Important: DataManager must be parent of all root DTOs
+        kunde->setParent(this);
+        kunde->fillFromBinaryCache(reader);
+        if (reader.hasError()) {
+            delete kunde;
+            break;
+        }
+        mAllKunde.append(kunde);
+        indexKunde(kunde);
+    }
+    if (reader.hasError()) {
+        // never keep a partial load: SQLite or JSON is read instead
+        qWarning() << "binary cache Kunde is truncated";
+        qDeleteAll(mAllKunde);
+        mAllKunde.clear();
+        mKundeByNr.clear();
+        mKundePosition.clear();
+        return false;
+    }
+    qDebug() << "read from binary cache Kunde* #" << mAllKunde.size() << " in ms: " << elapsedTimer.elapsed();
+    return true;
+}
+
+/*
+ * reads Auftrag (including Positionen) from binary snapshot (memory mapped)
+ * returns false if there's no valid snapshot or it is truncated
+ */
+bool DataManager::initAuftragFromBinaryCache()
+{
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+    BinaryCacheReader reader(dataPath(binaryCacheAuftrag));
+    if (!reader.open(BinaryCache::AuftragType)) {
+        return false;
+    }
+    mAllAuftrag.clear();
+    clearAuftragIndex();
+    mAllAuftrag.reserve(reader.recordCount());
+    mAuftragByNr.reserve(reader.recordCount());
+    for (quint32 i = 0; i < reader.recordCount() && !reader.hasError(); ++i) {
+        Auftrag* auftrag = new Auftrag();
+        // Important: DataManager must be parent of all root DTOs
+        auftrag->setParent(this);
+        auftrag->fillFromBinaryCache(reader);
+        if (reader.hasError()) {
+            delete auftrag;
+            break;
+        }
+        mAllAuftrag.append(auftrag);
+        indexAuftrag(auftrag);
+    }
+    if (reader.hasError()) {
+        // never keep a partial load: SQLite or JSON is read instead
+        qWarning() << "binary cache Auftrag is truncated";
+        qDeleteAll(mAllAuftrag);
+        mAllAuftrag.clear();
+        clearAuftragIndex();
+        return false;
+    }
+    qDebug() << "read from binary cache Auftrag* #" << mAllAuftrag.size() << " in ms: " << elapsedTimer.elapsed();
+    return true;
+}
+
+/*
+ * 2PhaseInit phase one: reads the most recent Auftrag
+ * from priority snapshot (written at exit together with the full snapshot)
+ * returns false if there's no valid priority snapshot
+ */
+bool DataManager::initAuftragPriorityFromBinaryCache()
+{
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+    BinaryCacheReader reader(dataPath(binaryCacheAuftragPriority));
+    if (!reader.open(BinaryCache::AuftragType)) {
+        return false;
+    }
+    // no full snapshot: phase two would have nothing to load
+    if (!QFile::exists(dataPath(binaryCacheAuftrag))) {
+        return false;
+    }
+    mAllAuftrag.clear();
+    clearAuftragIndex();
+    for (quint32 i = 0; i < reader.recordCount() && !reader.hasError(); ++i) {
+        Auftrag* auftrag = new Auftrag();
+        // Important: DataManager must be parent of all root DTOs
+        auftrag->setParent(this);
+        auftrag->fillFromBinaryCache(reader);
+        if (reader.hasError()) {
+            delete auftrag;
+            break;
+        }
+        mAllAuftrag.append(auftrag);
+        indexAuftrag(auftrag);
+    }
+    if (reader.hasError()) {
+        // the full snapshot is read instead
+        qWarning() << "binary cache Auftrag priority is truncated";
+        qDeleteAll(mAllAuftrag);
+        mAllAuftrag.clear();
+        clearAuftragIndex();
+        return false;
+    }
+    qDebug() << "2PhaseInit read priority Auftrag* #" << mAllAuftrag.size() << " in ms: " << elapsedTimer.elapsed();
+    return true;
+}
+
+static bool auftragIsMoreRecent(QObject* first, QObject* second)
+{
+    return ((Auftrag*) first)->datum() > ((Auftrag*) second)->datum();
+}
+
+/*
+ * 2PhaseInit: records of the most recent Auftrag* for background save
+ */
+QList<AuftragRecord> DataManager::auftragPriorityRecords()
+{
+    QList<QObject*> priorityList = mAllAuftrag;
+    int priorityCount = qMin(mAuftragPriorityCount, priorityList.size());
+    std::partial_sort(priorityList.begin(), priorityList.begin() + priorityCount,
+            priorityList.end(), auftragIsMoreRecent);
+    QList<AuftragRecord> records;
+    records.reserve(priorityCount);
+    for (int i = 0; i < priorityCount; ++i) {
+        records.append(((Auftrag*) priorityList.at(i))->toRecord());
+    }
+    return records;
+}
+
+/*
+ * reads Schlagwort from binary snapshot (memory mapped)
+ * returns false if there's no valid snapshot or it is truncated
+ */
+bool DataManager::initSchlagwortFromBinaryCache()
+{
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+    BinaryCacheReader reader(dataPath(binaryCacheSchlagwort));
+    if (!reader.open(BinaryCache::SchlagwortType)) {
+        return false;
+    }
+    mAllSchlagwort.clear();
+    mSchlagwortByUuid.clear();
+    mAllSchlagwort.reserve(reader.recordCount());
+    mSchlagwortByUuid.reserve(reader.recordCount());
+    for (quint32 i = 0; i < reader.recordCount() && !reader.hasError(); ++i) {
+        Schlagwort* schlagwort = new Schlagwort();
+        // Important: DataManager must be parent of all root DTOs
+        schlagwort->setParent(this);
+        schlagwort->fillFromBinaryCache(reader);
+        if (reader.hasError()) {
+            delete schlagwort;
+            break;
+        }
+        mAllSchlagwort.append(schlagwort);
+        indexSchlagwort(schlagwort);
+    }
+    if (reader.hasError()) {
+        // never keep a partial load: JSON is read instead
+        qWarning() << "binary cache Schlagwort is truncated";
+        qDeleteAll(mAllSchlagwort);
+        mAllSchlagwort.clear();
+        mSchlagwortByUuid.clear();
+        return false;
+    }
+    qDebug() << "read from binary cache Schlagwort* #" << mAllSchlagwort.size() << " in ms: " << elapsedTimer.elapsed();
+    return true;
+}
+
+/*
+ * save List of Schlagwort* as binary snapshot
+ * Schlagwort is read-only: snapshot is written after import from JSON
+ */
+void DataManager::saveSchlagwortToBinaryCache()
+{
+    BinaryCacheWriter writer(dataPath(binaryCacheSchlagwort));
+    if (!writer.open(BinaryCache::SchlagwortType)) {
+        return;
+    }
+    for (int i = 0; i < mAllSchlagwort.size(); ++i) {
+        Schlagwort* schlagwort;
+        schlagwort = (Schlagwort*)mAllSchlagwort.at(i);
+        schlagwort->toBinaryCache(writer);
+        writer.recordWritten();
+    }
+    writer.commit();
+    qDebug() << "Schlagwort* written to binary cache #" << writer.recordCount();
+}
+
 /*
  * reads Maps of Kunde in from JSON cache
  * creates List of Kunde*  from QVariantList
@@ -256,6 +1708,12 @@ void DataManager::initKundeFromCache()
 {
 	qDebug() << "start initKundeFromCache";
     mAllKunde.clear();
+    mKundeByNr.clear();
+    mKundePosition.clear();
+    if (mStreamingJsonCache) {
+        initKundeFromCacheStream();
+        return;
+    }
     QVariantList cacheList;
     cacheList = readFromCache(cacheKunde);
     qDebug() << "read Kunde from cache #" << cacheList.size();
@@ -267,10 +1725,47 @@ void DataManager::initKundeFromCache()
         kunde->setParent(this);
         kunde->fillFromCacheMap(cacheMap);
         mAllKunde.append(kunde);
+        indexKunde(kunde);
     }
     qDebug() << "created Kunde* #" << mAllKunde.size();
 }
 
+/*
+ * reads Kunde in from JSON cache as stream of tokens
+ * Kunde* are created directly from the tokens
+ */
+void DataManager::initKundeFromCacheStream()
+{
+    QFile dataFile;
+    CacheCodecDevice codecDevice(&dataFile);
+    QIODevice* device = openCacheStream(cacheKunde, dataFile, codecDevice);
+    if (!device) {
+        return;
+    }
+    JsonStreamReader reader(device);
+    if (reader.readNext() != JsonStreamReader::BeginArray) {
+        qWarning() << "no JSON Array found in " << cacheKunde;
+        return;
+    }
+    while (reader.readNext() == JsonStreamReader::BeginObject) {
+        Kunde* kunde = new Kunde();
+        // Important: DataManager must be parent of all root DTOs
+        kunde->setParent(this);
+        kunde->fillFromCacheStream(reader);
+        if (reader.hasError()) {
+            // half filled: never append
+            delete kunde;
+            break;
+        }
+        mAllKunde.append(kunde);
+        indexKunde(kunde);
+    }
+    if (reader.hasError()) {
+        qWarning() << "error reading " << cacheKunde << ":" << reader.errorString();
+    }
+    qDebug() << "streamed and created Kunde* #" << mAllKunde.size();
+}
+
 /*
  * queries SELECT * FROM Kunde (SQLite cache)
 * creates List of Kunde*  from QSqlQuery
@@ -279,25 +1774,28 @@ void DataManager::initKundeFromSqlCache()
 {
 	qDebug() << "start initKunde From S Q L Cache";
 	mAllKunde.clear();
-    QString sqlQuery = "SELECT * FROM kunde";
-    QSqlQuery query (mDatabase);
-    query.setForwardOnly(true);
-    query.prepare(sqlQuery);
+	mKundeByNr.clear();
+	mKundePosition.clear();
+    int schemaVersion = SqlRowDecoder::schemaVersion(mDatabase);
+    QSqlQuery& query = mStatements.prepared("SELECT * FROM kunde");
     bool success = query.exec();
     if(!success) {
     	qDebug() << "NO SUCCESS query kunde";
     	return;
     }
-    QSqlRecord record = query.record();
-    Kunde::fillSqlQueryPos(record);
-    while (query.next())
+    SqlRowDecoder rows(query);
+    Kunde::bindSqlColumns(rows, schemaVersion);
+    while (rows.next())
     	{
     		Kunde* kunde = new Kunde();
     		// Important: DataManager must be parent of all root DTOs
     		kunde->setParent(this);
-    		kunde->fillFromSqlQuery(query);
+    		kunde->fillFromSqlRow(rows);
     		mAllKunde.append(kunde);
+    		indexKunde(kunde);
     	}
+    // releases the read lock
+    query.finish();
     qDebug() << "read from SQLite and created Kunde* #" << mAllKunde.size();
 }
 
@@ -306,9 +1804,20 @@ void DataManager::initKundeFromSqlCache()
  * convert list of Kunde* to QVariantList
  * toCacheMap stores all properties without transient values
  */
-void DataManager::saveKundeToCache()
+bool DataManager::saveKundeToCache()
 {
+    if (mStreamingJsonCache) {
+        return saveKundeToCacheStream();
+    }
     QVariantList cacheList;
+    if (mKundePager) {
+        QList<KundeRecord> records = kundeRecords();
+        qDebug() << "now caching KundeRecord #" << records.size();
+        for (int i = 0; i < records.size(); ++i) {
+            cacheList.append(Kunde::cacheMapFromRecord(records.at(i)));
+        }
+        return writeToCache(cacheKunde, cacheList);
+    }
     qDebug() << "now caching Kunde* #" << mAllKunde.size();
     for (int i = 0; i < mAllKunde.size(); ++i) {
         Kunde* kunde;
@@ -318,7 +1827,46 @@ void DataManager::saveKundeToCache()
         cacheList.append(cacheMap);
     }
     qDebug() << "Kunde* converted to JSON cache #" << cacheList.size();
-    writeToCache(cacheKunde, cacheList);
+    return writeToCache(cacheKunde, cacheList);
+}
+
+/*
+ * writes Kunde* (or KundeRecord) to JSON cache one by one
+ * only the write buffer is in memory - not the whole cache
+ */
+bool DataManager::saveKundeToCacheStream()
+{
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+    long heapBefore = heapInUseKb();
+    JsonStreamWriter writer(dataPath(cacheKunde), (CacheCodec::Codec) mCacheCodec);
+    if (!writer.open()) {
+        return false;
+    }
+    int count = 0;
+    long heapKb = 0;
+    writer.beginArray();
+    if (mKundePager) {
+        QList<KundeRecord> records = kundeRecords();
+        for (int i = 0; i < records.size(); ++i) {
+            Kunde::recordToCacheStream(records.at(i), writer);
+        }
+        count = records.size();
+        heapKb = heapInUseKb() - heapBefore;
+    } else {
+        for (int i = 0; i < mAllKunde.size(); ++i) {
+            ((Kunde*) mAllKunde.at(i))->toCacheStream(writer);
+        }
+        count = mAllKunde.size();
+    }
+    writer.endArray();
+    if (!mKundePager) {
+        heapKb = heapInUseKb() - heapBefore;
+    }
+    bool committed = writer.commit();
+    qDebug() << "Kunde* streamed to JSON cache #" << count << " in ms: " << elapsedTimer.elapsed()
+            << " heap kB: " << heapKb;
+    return committed;
 }
 
 /*
@@ -329,18 +1877,21 @@ void DataManager::saveKundeToCache()
  * 
  * Kunde is read-only Cache - so it's not saved automatically at exit
  */
-void DataManager::saveKundeToSqlCache()
+bool DataManager::saveKundeToSqlCache()
 {
-    qDebug() << "now caching Kunde* #" << mAllKunde.size();
+    QList<KundeRecord> records = kundeRecords();
+    qDebug() << "now caching Kunde* #" << records.size();
     bulkImport(true);
     bool success = false;
+    // DROP fails if statements on kunde are active
+    mStatements.finishAll();
     QSqlQuery query (mDatabase);
     query.prepare("DROP TABLE IF EXISTS kunde");
     success = query.exec();
     if(!success) {
         qWarning() << "NO SUCCESS DROP kunde";
         bulkImport(false);
-        return;
+        return false;
     }
     qDebug() << "table DROPPED kunde";
     // create table
@@ -350,7 +1901,7 @@ void DataManager::saveKundeToSqlCache()
     if(!success) {
         qWarning() << "NO SUCCESS CREATE kunde";
         bulkImport(false);
-        return;
+        return false;
     }
     qDebug() << "table CREATED kunde";
 
@@ -358,109 +1909,249 @@ void DataManager::saveKundeToSqlCache()
     //
     QVariantList nrList, nameList, ortList;
     QString insertSQL = Kunde::createParameterizedInsertPosBinding();
-    int laps = mAllKunde.size()/mChunkSize;
-    if(mAllKunde.size()%mChunkSize) {
-        laps ++;
-    }
-    int count = 0;
-    qDebug() << "chunks of " << mChunkSize << " laps: " << laps;
+    ChunkSizer chunkSizer(mChunkSize, mAdaptiveChunkSize, mChunkMinLatencyMs, mChunkMaxLatencyMs);
+    qDebug() << "chunks of " << chunkSizer.chunkSize() << " adaptive: " << mAdaptiveChunkSize;
+    mSqlImportRunning = true;
+    QElapsedTimer chunkTimer;
     int fromPos = 0;
-    int toPos = mChunkSize;
-    if(toPos > mAllKunde.size()) {
-        toPos = mAllKunde.size();
-    }
-    while (count < laps) {
-    	//
-    	query.clear();
-    	query.prepare("BEGIN TRANSACTION");
-    	success = query.exec();
+    while (fromPos < records.size()) {
+    	int toPos = qMin(fromPos + chunkSizer.chunkSize(), records.size());
+    	chunkTimer.start();
+    	success = mStatements.prepared("BEGIN TRANSACTION").exec();
     	if(!success) {
         	qWarning() << "NO SUCCESS BEGIN TRANSACTION";
+        	mSqlImportRunning = false;
         	bulkImport(false);
-        	return;
+        	return false;
     	}
     	// do it
 		nrList.clear();
 		nameList.clear();
 		ortList.clear();
     	for (int i = fromPos; i < toPos; ++i) {
-        	Kunde* kunde;
-        	kunde = (Kunde*)mAllKunde.at(i);
-        	kunde->toSqlCache(nrList, nameList, ortList);
+        	const KundeRecord& record = records.at(i);
+        	nrList << record.nr;
+        	nameList << record.name;
+        	ortList << record.ort;
     	}
         //
-    	query.clear();
-    	query.prepare(insertSQL);
-    	query.addBindValue(nrList);
-    	query.addBindValue(nameList);
-    	query.addBindValue(ortList);
-    	success = query.execBatch();
+    	QSqlQuery& insertQuery = mStatements.prepared(insertSQL);
+    	insertQuery.bindValue(0, nrList);
+    	insertQuery.bindValue(1, nameList);
+    	insertQuery.bindValue(2, ortList);
+    	success = insertQuery.execBatch();
     	if(!success) {
         	qWarning() << "NO SUCCESS INSERT batch kunde";
+        	mSqlImportRunning = false;
         	bulkImport(false);
-        	return;
+        	return false;
     	}
-    	query.clear();
-    	query.prepare("END TRANSACTION");
-    	success = query.exec();
+    	success = mStatements.prepared("END TRANSACTION").exec();
     	if(!success) {
         	qWarning() << "NO SUCCESS END TRANSACTION";
+        	mSqlImportRunning = false;
         	bulkImport(false);
-        	return;
+        	return false;
     	}
         //
-        count ++;
-        fromPos += mChunkSize;
-        toPos += mChunkSize;
-        if(toPos > mAllKunde.size()) {
-            toPos = mAllKunde.size();
-        }
+        chunkSizer.chunkDone(toPos - fromPos, chunkTimer.elapsed());
+        fromPos = toPos;
+        yieldBetweenChunks();
     }
-    qDebug() << "END INSERT chunks of kunde";
+    mSqlImportRunning = false;
+    mChunkStats.insert("kunde", chunkSizer.stats());
+    qDebug() << "END INSERT chunks of kunde " << chunkSizer.stats();
     bulkImport(false);
+    return true;
+}
+
+/*
+ * save only changed, inserted and deleted Kunde* to SQLite cache
+ * one transaction: batched DELETE of removed keys,
+ * UPSERT (INSERT ... ON CONFLICT(nr) DO UPDATE) of changed rows
+ * writes are proportional to the changes, not to the size of the table
+ * table doesn't exist or cache is outdated: complete rewrite
+ */
+bool DataManager::saveKundeDeltaToSqlCache(const QSet<Kunde*>& dirtyKunde,
+        const QSet<int>& deletedKundeNr, const bool& outdated)
+{
+    if (!isKundeOnlyInSqlCache() && (outdated || !mDatabase.tables().contains("kunde"))) {
+        return saveKundeToSqlCache();
+    }
+    qDebug() << "now caching delta Kunde* changed #" << dirtyKunde.size() << " deleted #" << deletedKundeNr.size();
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+    bool success = false;
+    if (!mDatabase.transaction()) {
+        qWarning() << "NO SUCCESS BEGIN TRANSACTION";
+        return false;
+    }
+    // deleted: keys which are not used again by a changed Kunde
+    QVariantList deletedNrList;
+    QSetIterator<int> deletedIterator(deletedKundeNr);
+    while (deletedIterator.hasNext()) {
+        int nr = deletedIterator.next();
+        if (!mKundeByNr.contains(nr)) {
+            deletedNrList << nr;
+        }
+    }
+    success = deleteKeysFromSqlCache(&Kunde::createParameterizedDeleteByKeys, deletedNrList);
+    if(!success) {
+        mDatabase.rollback();
+        return false;
+    }
+    QVariantList nrList, nameList, ortList;
+    QSetIterator<Kunde*> dirtyIterator(dirtyKunde);
+    while (dirtyIterator.hasNext()) {
+        dirtyIterator.next()->toSqlCache(nrList, nameList, ortList);
+    }
+    if (!nrList.isEmpty()) {
+        QSqlQuery& query = mStatements.prepared(
+                mSqlUpsertSupported ? Kunde::createParameterizedUpsertPosBinding() :
+                        Kunde::createParameterizedInsertOrReplacePosBinding());
+        query.bindValue(0, nrList);
+        query.bindValue(1, nameList);
+        query.bindValue(2, ortList);
+        success = query.execBatch();
+        if(!success) {
+            qWarning() << "NO SUCCESS UPSERT batch kunde " << query.lastError().text();
+            mDatabase.rollback();
+            return false;
+        }
+    }
+    if (!mDatabase.commit()) {
+        qWarning() << "NO SUCCESS COMMIT delta kunde";
+        return false;
+    }
+    qDebug() << "delta Kunde* written #" << nrList.size() << " deleted #" << deletedNrList.size()
+            << " in ms: " << elapsedTimer.elapsed();
+    return true;
 }
 /**
 * converts a list of keys in to a list of DataObjects
 * per ex. used to resolve lazy arrays
+* keys are resolved in one batch - see resolveKundeKeys()
 */
 QList<Kunde*> DataManager::listOfKundeForKeys(
         QStringList keyList)
+{
+    QList<int> keys;
+    QStringList invalidKeys;
+    keys.reserve(keyList.size());
+    for (int i = 0; i < keyList.size(); ++i) {
+        bool ok;
+        int nr = keyList.at(i).toInt(&ok);
+        if (ok) {
+            keys.append(nr);
+        } else {
+            invalidKeys.append(keyList.at(i));
+        }
+    }
+    QList<int> missingKeys;
+    QList<Kunde*> listOfData;
+    listOfData = resolveKundeKeys(keys, missingKeys);
+    for (int i = 0; i < missingKeys.size(); ++i) {
+        invalidKeys.append(QString::number(missingKeys.at(i)));
+    }
+    if (invalidKeys.isEmpty()) {
+        return listOfData;
+    }
+    qWarning() << "not all keys found for Kunde: " << invalidKeys.join(", ");
+    return listOfData;
+}
+/**
+* batch resolution of a set of keys (domainKey nr)
+* linear in number of keys: each key is a lookup into the primary key index
+* result is in order of the keys, duplicate keys are resolved only once
+* keys not found are appended to missingKeys
+* lazy Kunde: each page with Kunde* not in memory is read once
+*/
+QList<Kunde*> DataManager::resolveKundeKeys(const QList<int>& keys, QList<int>& missingKeys)
 {
     QList<Kunde*> listOfData;
-    keyList.removeDuplicates();
-    if (keyList.isEmpty()) {
+    if (keys.isEmpty()) {
         return listOfData;
     }
-    for (int i = 0; i < mAllKunde.size(); ++i) {
+    if (mKundePager) {
+        QSet<int> pages;
+        for (int i = 0; i < keys.size(); ++i) {
+            if (!mKundeByNr.contains(keys.at(i))) {
+                int pos = mKundePager->positionOf(keys.at(i));
+                if (pos >= 0) {
+                    pages.insert(pos / KundePager::pageSize);
+                }
+            }
+        }
+        // Kunde* of pages read first must not be evicted by the next page
+        mKundeEvictionSuspended++;
+        QSetIterator<int> pageIterator(pages);
+        while (pageIterator.hasNext()) {
+            materializeKundePage(pageIterator.next());
+        }
+        mKundeEvictionSuspended--;
+    }
+    listOfData.reserve(keys.size());
+    QSet<int> resolvedKeys;
+    resolvedKeys.reserve(keys.size());
+    for (int i = 0; i < keys.size(); ++i) {
+        const int& nr = keys.at(i);
+        if (resolvedKeys.contains(nr)) {
+            continue;
+        }
+        resolvedKeys.insert(nr);
         Kunde* kunde;
-        kunde = (Kunde*) mAllKunde.at(i);
-        if (keyList.contains(QString::number(kunde->nr()))) {
-            listOfData.append(kunde);
-            keyList.removeOne(QString::number(kunde->nr()));
-            if(keyList.isEmpty()){
-                break;
+        kunde = mKundeByNr.value(nr, 0);
+        if (kunde && kunde->nr() == nr) {
+            if (mKundePager) {
+                handOutKunde(kunde);
             }
+            listOfData.append(kunde);
+        } else {
+            missingKeys.append(nr);
         }
     }
-    if (keyList.isEmpty()) {
-        return listOfData;
+    if (mKundePager) {
+        evictKundeAboveBudget();
     }
-    qWarning() << "not all keys found for Kunde: " << keyList.join(", ");
     return listOfData;
 }
 
 QVariantList DataManager::kundeAsQVariantList()
 {
     QVariantList kundeList;
+    if (mKundePager) {
+        // no transient properties: same as toMap()
+        QList<KundeRecord> records = kundeRecords();
+        for (int i = 0; i < records.size(); ++i) {
+            kundeList.append(Kunde::cacheMapFromRecord(records.at(i)));
+        }
+        return kundeList;
+    }
     for (int i = 0; i < mAllKunde.size(); ++i) {
         kundeList.append(((Kunde*) (mAllKunde.at(i)))->toMap());
     }
     return kundeList;
 }
 
+/*
+ * lazy: every page is read - the caller holds all Kunde*,
+ * so they are not evicted anymore
+ */
 QList<QObject*> DataManager::allKunde()
 {
-    return mAllKunde;
+    if (!mKundePager) {
+        return mAllKunde;
+    }
+    mAllKundeHandedOut = true;
+    QList<QObject*> kundeList;
+    kundeList.reserve(mKundePager->count());
+    for (int pos = 0; pos < mKundePager->count(); ++pos) {
+        Kunde* kunde = kundeAt(pos);
+        if (kunde) {
+            kundeList.append(kunde);
+        }
+    }
+    return kundeList;
 }
 
 QDeclarativeListProperty<Kunde> DataManager::kundePropertyList()
@@ -479,7 +2170,8 @@ void DataManager::appendToKundeProperty(
     DataManager *dataManagerObject = qobject_cast<DataManager *>(kundeList->object);
     if (dataManagerObject) {
         kunde->setParent(dataManagerObject);
-        dataManagerObject->mAllKunde.append(kunde);
+        dataManagerObject->appendKunde(kunde);
+        dataManagerObject->mDirtyKunde.insert(kunde);
         emit dataManagerObject->addedToAllKunde(kunde);
     } else {
         qWarning() << "cannot append Kunde* to mAllKunde "
@@ -491,6 +2183,9 @@ int DataManager::kundePropertyCount(
 {
     DataManager *dataManager = qobject_cast<DataManager *>(kundeList->object);
     if (dataManager) {
+        if (dataManager->mKundePager) {
+            return dataManager->mKundePager->count();
+        }
         return dataManager->mAllKunde.size();
     } else {
         qWarning() << "cannot get size mAllKunde " << "Object is not of type DataManager*";
@@ -502,6 +2197,9 @@ Kunde* DataManager::atKundeProperty(
 {
     DataManager *dataManager = qobject_cast<DataManager *>(kundeList->object);
     if (dataManager) {
+        if (dataManager->mKundePager) {
+            return dataManager->kundeAt(pos);
+        }
         if (dataManager->mAllKunde.size() > pos) {
             return (Kunde*) dataManager->mAllKunde.at(pos);
         }
@@ -518,15 +2216,7 @@ void DataManager::clearKundeProperty(
 {
     DataManager *dataManager = qobject_cast<DataManager *>(kundeList->object);
     if (dataManager) {
-        for (int i = 0; i < dataManager->mAllKunde.size(); ++i) {
-            Kunde* kunde;
-            kunde = (Kunde*) dataManager->mAllKunde.at(i);
-			emit dataManager->deletedFromAllKundeByNr(kunde->nr());
-			emit dataManager->deletedFromAllKunde(kunde);
-            kunde->deleteLater();
-            kunde = 0;
-        }
-        dataManager->mAllKunde.clear();
+        dataManager->deleteKunde();
     } else {
         qWarning() << "cannot clear mAllKunde " << "Object is not of type DataManager*";
     }
@@ -538,15 +2228,42 @@ void DataManager::clearKundeProperty(
  */
 void DataManager::deleteKunde()
 {
+    if (mKundePager) {
+        // lazy: deleted by key - the delta removes them from SQLite
+        QVector<int> keys = mKundePager->keys();
+        QList<Kunde*> resident = mKundeByNr.values();
+        for (int i = 0; i < resident.size(); ++i) {
+            Kunde* kunde = resident.at(i);
+            unindexKunde(kunde);
+            mKundePager->forget(kunde->nr());
+            invalidateAuftraggeberReferences(kunde);
+            emit deletedFromAllKundeByNr(kunde->nr());
+            emit deletedFromAllKunde(kunde);
+            kunde->deleteLater();
+        }
+        mDirtyKunde.clear();
+        for (int i = 0; i < keys.size(); ++i) {
+            mDeletedKundeNr.insert(keys.at(i));
+        }
+        mKundePager->clearKeys();
+        return;
+    }
     for (int i = 0; i < mAllKunde.size(); ++i) {
         Kunde* kunde;
         kunde = (Kunde*) mAllKunde.at(i);
+        invalidateAuftraggeberReferences(kunde);
         emit deletedFromAllKundeByNr(kunde->nr());
 		emit deletedFromAllKunde(kunde);
         kunde->deleteLater();
         kunde = 0;
      }
      mAllKunde.clear();
+     mKundeByNr.clear();
+     mKundePosition.clear();
+     mHandedOutKunde.clear();
+     mPinnedKunde.clear();
+     mRetainedKunde.clear();
+     markAllKundeDeleted();
 }
 
 /**
@@ -583,7 +2300,8 @@ void DataManager::insertKunde(Kunde* kunde)
 {
     // Important: DataManager must be parent of all root DTOs
     kunde->setParent(this);
-    mAllKunde.append(kunde);
+    appendKunde(kunde);
+    mDirtyKunde.insert(kunde);
     emit addedToAllKunde(kunde);
 }
 
@@ -597,17 +2315,36 @@ void DataManager::insertKundeFromMap(const QVariantMap& kundeMap,
     } else {
         kunde->fillFromMap(kundeMap);
     }
-    mAllKunde.append(kunde);
+    appendKunde(kunde);
+    mDirtyKunde.insert(kunde);
     emit addedToAllKunde(kunde);
 }
 
+bool DataManager::removeFromAllKunde(Kunde* kunde)
+{
+    return removeBySwap(mAllKunde, mKundePosition, kunde);
+}
+
+bool DataManager::removeFromAllAuftrag(Auftrag* auftrag)
+{
+    return removeBySwap(mAllAuftrag, mAuftragPosition, auftrag);
+}
+
 bool DataManager::deleteKunde(Kunde* kunde)
 {
     bool ok = false;
-    ok = mAllKunde.removeOne(kunde);
+    if (mKundePager) {
+        ok = mKundeByNr.value(kunde->nr(), 0) == kunde && mKundePager->removeKey(kunde->nr());
+        mKundePager->forget(kunde->nr());
+    } else {
+        ok = removeFromAllKunde(kunde);
+    }
     if (!ok) {
         return ok;
     }
+    unindexKunde(kunde);
+    markKundeDeleted(kunde);
+    invalidateAuftraggeberReferences(kunde);
     emit deletedFromAllKundeByNr(kunde->nr());
     emit deletedFromAllKunde(kunde);
     kunde->deleteLater();
@@ -618,19 +2355,26 @@ bool DataManager::deleteKunde(Kunde* kunde)
 
 bool DataManager::deleteKundeByNr(const int& nr)
 {
-    for (int i = 0; i < mAllKunde.size(); ++i) {
-        Kunde* kunde;
-        kunde = (Kunde*) mAllKunde.at(i);
-        if (kunde->nr() == nr) {
-            mAllKunde.removeAt(i);
-            emit deletedFromAllKundeByNr(nr);
-            emit deletedFromAllKunde(kunde);
-            kunde->deleteLater();
-            kunde = 0;
-            return true;
-        }
+    Kunde* kunde;
+    // lazy: materialized to notify the listeners
+    kunde = mKundePager ? findKundeByNr(nr) : mKundeByNr.value(nr, 0);
+    if (!kunde || kunde->nr() != nr) {
+        return false;
+    }
+    if (mKundePager) {
+        mKundePager->removeKey(nr);
+        mKundePager->forget(nr);
+    } else {
+        removeFromAllKunde(kunde);
     }
-    return false;
+    unindexKunde(kunde);
+    markKundeDeleted(kunde);
+    invalidateAuftraggeberReferences(kunde);
+    emit deletedFromAllKundeByNr(nr);
+    emit deletedFromAllKunde(kunde);
+    kunde->deleteLater();
+    kunde = 0;
+    return true;
 }
 
 void DataManager::fillKundeDataModel(QString objectName)
@@ -642,10 +2386,8 @@ void DataManager::fillKundeDataModel(QString objectName)
     if (dataModelList.size() > 0) {
     	GroupDataModel* dataModel = dataModelList.last();
     	if (dataModel) {
-        	QList<QObject*> theList;
-        	for (int i = 0; i < mAllKunde.size(); ++i) {
-            	theList.append(mAllKunde.at(i));
-        	}
+        	// lazy: all pages are read
+        	QList<QObject*> theList = allKunde();
         	dataModel->clear();
         	dataModel->insertList(theList);
         	return;
@@ -695,48 +2437,478 @@ void DataManager::removeItemFromKundeDataModel(QString objectName, Kunde* listIt
             }
             qDebug() << "Kunde Object not found and not removed from " << objectName;
         }
-        return;
+        return;
+    }
+    qDebug() << "no DataModel found for " << objectName;
+}
+
+void DataManager::insertItemIntoKundeDataModel(QString objectName, Kunde* listItem)
+{
+    // using dynamic created Pages / Lists it's a good idea to use findChildren ... last()
+    // probably there are GroupDataModels not deleted yet from previous destroyed Pages
+    QList<GroupDataModel*> dataModelList = Application::instance()->scene()->findChildren<
+            GroupDataModel*>(objectName);
+    if (dataModelList.size() > 0) {
+        GroupDataModel* dataModel = dataModelList.last();
+        if (dataModel) {
+            dataModel->insert(listItem);
+        }
+        return;
+    }
+    qDebug() << "no DataModel found for " << objectName;
+}
+
+// nr is DomainKey
+// constant time lookup using the primary key index
+Kunde* DataManager::findKundeByNr(const int& nr){
+    Kunde* kunde;
+    kunde = mKundeByNr.value(nr, 0);
+    if (mKundePager && !kunde) {
+        int pos = mKundePager->positionOf(nr);
+        if (pos >= 0) {
+            kunde = kundeAt(pos);
+        }
+    } else if (mKundePager && kunde) {
+        handOutKunde(kunde);
+    }
+    if (kunde && kunde->nr() == nr) {
+        return kunde;
+    }
+    qDebug() << "no Kunde found for nr " << nr;
+    return 0;
+}
+
+/*
+ * all Kunde* with the same ort
+ * lazy Kunde: records are compared, only the Kunde* found are materialized
+ */
+QList<QObject*> DataManager::findKundeByOrt(const QString& ort)
+{
+    QList<QObject*> kundeList;
+    const QString interned = Kunde::ortPool().intern(ort);
+    if (mKundePager) {
+        QList<KundeRecord> records = kundeRecords();
+        // Kunde* already found must not be evicted by the next page read
+        mKundeEvictionSuspended++;
+        for (int i = 0; i < records.size(); ++i) {
+            if (records.at(i).ort == interned) {
+                Kunde* kunde = findKundeByNr(records.at(i).nr);
+                if (kunde) {
+                    kundeList.append(kunde);
+                }
+            }
+        }
+        mKundeEvictionSuspended--;
+        evictKundeAboveBudget();
+        return kundeList;
+    }
+    QList<Kunde*> candidates;
+    for (int i = 0; i < mAllKunde.size(); ++i) {
+        candidates.append((Kunde*) mAllKunde.at(i));
+    }
+    for (int i = 0; i < candidates.size(); ++i) {
+        if (StringPool::isSame(candidates.at(i)->ort(), interned)) {
+            kundeList.append(candidates.at(i));
+        }
+    }
+    return kundeList;
+}
+
+/**
+ * primary key index for Kunde
+ * must be kept in sync with mAllKunde:
+ * index after append, unindex before the Kunde* is deleted
+ * nrChanged is connected to keep the index valid if the DomainKey changes
+ */
+void DataManager::indexKunde(Kunde* kunde)
+{
+    mKundeByNr.insert(kunde->nr(), kunde);
+    if (!mAllKunde.isEmpty() && mAllKunde.last() == kunde) {
+        mKundePosition.insert(kunde, mAllKunde.size() - 1);
+    }
+    connect(kunde, SIGNAL(nrChanged(int)), this, SLOT(onKundeNrChanged(int)), Qt::UniqueConnection);
+    // dirty tracking
+    connect(kunde, SIGNAL(nameChanged(QString)), this, SLOT(onKundeChanged()), Qt::UniqueConnection);
+    connect(kunde, SIGNAL(ortChanged(QString)), this, SLOT(onKundeChanged()), Qt::UniqueConnection);
+}
+void DataManager::unindexKunde(Kunde* kunde)
+{
+    if (mKundeByNr.value(kunde->nr(), 0) == kunde) {
+        mKundeByNr.remove(kunde->nr());
+    }
+    mHandedOutKunde.remove(kunde);
+    mPinnedKunde.remove(kunde);
+    mRetainedKunde.remove(kunde);
+    disconnect(kunde, SIGNAL(nrChanged(int)), this, SLOT(onKundeNrChanged(int)));
+    disconnect(kunde, SIGNAL(nameChanged(QString)), this, SLOT(onKundeChanged()));
+    disconnect(kunde, SIGNAL(ortChanged(QString)), this, SLOT(onKundeChanged()));
+}
+
+void DataManager::setLazyKunde(const bool& lazy)
+{
+    mLazyKunde = lazy;
+}
+
+void DataManager::setLazyKundeBudget(const int& maxKunde)
+{
+    // at least some pages - the page just read must never be evicted
+    mLazyKundeBudget = qMax(4 * KundePager::pageSize, maxKunde);
+}
+
+QVariantMap DataManager::lazyKundeStats()
+{
+    QVariantMap statsMap;
+    statsMap.insert("lazy", mKundePager != 0);
+    statsMap.insert("records", mKundePager && mKundePager->hasRecords());
+    statsMap.insert("keys", mKundePager ? mKundePager->count() : mAllKunde.size());
+    statsMap.insert("inMemory", mKundeByNr.size());
+    statsMap.insert("budget", mLazyKundeBudget);
+    statsMap.insert("pagesLoaded", mKundePager ? mKundePager->pagesLoaded() : 0);
+    statsMap.insert("evicted", mEvictedKunde);
+    return statsMap;
+}
+
+/*
+ * lazy Kunde: reads only the keys of table kunde
+ * false: all Kunde* must be loaded (not lazy, binary snapshots or no table yet)
+ */
+bool DataManager::openLazyKunde()
+{
+    delete mKundePager;
+    mKundePager = 0;
+    if (!mLazyKunde || mBinaryCache || !mDatabaseAvailable) {
+        return false;
+    }
+    mKundePager = new KundePager(mStatements, mDatabase);
+    if (!mKundePager->open()) {
+        delete mKundePager;
+        mKundePager = 0;
+        return false;
+    }
+    mAllKunde.clear();
+    mKundeByNr.clear();
+    mKundePosition.clear();
+    mHandedOutKunde.clear();
+    mPinnedKunde.clear();
+    mRetainedKunde.clear();
+    mEvictedKunde = 0;
+    mAllKundeHandedOut = false;
+    return true;
+}
+
+void DataManager::setKundeRecordStorage(const bool& recordStorage)
+{
+    mKundeRecordStorage = recordStorage;
+}
+
+/*
+ * record storage: reads all Kunde as KundeRecord
+ * from binary snapshot, SQLite or JSON (same order as without records)
+ * false: record storage not set - all Kunde* must be loaded
+ */
+bool DataManager::openKundeRecords()
+{
+    if (!mKundeRecordStorage) {
+        return false;
+    }
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+    QVector<KundeRecord> records;
+    bool fromSnapshot = false;
+    if (mBinaryCache) {
+        BinaryCacheReader reader(dataPath(binaryCacheKunde));
+        if (reader.open(BinaryCache::KundeType)) {
+            records.reserve(reader.recordCount());
+            for (quint32 i = 0; i < reader.recordCount() && !reader.hasError(); ++i) {
+                KundeRecord record;
+                record.fillFromBinaryCache(reader);
+                if (reader.hasError()) {
+                    break;
+                }
+                record.ort = Kunde::ortPool().intern(record.ort);
+                records.append(record);
+            }
+            if (reader.hasError()) {
+                // records are the only copy: read SQLite or JSON instead
+                // and rewrite the snapshot
+                qWarning() << "binary cache Kunde is truncated";
+                records.clear();
+            } else {
+                fromSnapshot = true;
+            }
+        }
+    }
+    if (!fromSnapshot && mDatabaseAvailable && mDatabase.tables().contains("kunde")) {
+        int schemaVersion = SqlRowDecoder::schemaVersion(mDatabase);
+        QSqlQuery& query = mStatements.prepared("SELECT * FROM kunde");
+        if (query.exec()) {
+            SqlRowDecoder rows(query);
+            Kunde::bindSqlColumns(rows, schemaVersion);
+            while (rows.next()) {
+                records.append(Kunde::recordFromSqlRow(rows));
+            }
+        }
+        // releases the read lock
+        query.finish();
+    } else if (!fromSnapshot) {
+        QVariantList cacheList = readFromCache(cacheKunde);
+        records.reserve(cacheList.size());
+        for (int i = 0; i < cacheList.size(); ++i) {
+            records.append(Kunde::recordFromCacheMap(cacheList.at(i).toMap()));
+        }
+    }
+    delete mKundePager;
+    mKundePager = new KundePager(mStatements, mDatabase);
+    mKundePager->openRecords(records);
+    mAllKunde.clear();
+    mKundeByNr.clear();
+    mKundePosition.clear();
+    mHandedOutKunde.clear();
+    mPinnedKunde.clear();
+    mRetainedKunde.clear();
+    mEvictedKunde = 0;
+    mAllKundeHandedOut = false;
+    // imported: there's no snapshot yet
+    mKundeCacheOutdated = mBinaryCache && !fromSnapshot;
+    qDebug() << "KundeRecord #" << mKundePager->count() << " in ms: " << elapsedTimer.elapsed();
+    return true;
+}
+
+// lazy Kunde without records: the table is the only complete copy
+bool DataManager::isKundeOnlyInSqlCache()
+{
+    return mKundePager && !mKundePager->hasRecords();
+}
+
+// new Kunde*: mAllKunde or (lazy) the key index
+void DataManager::appendKunde(Kunde* kunde)
+{
+    if (mKundePager) {
+        mKundePager->insertKey(kunde->nr());
+        mKundePager->touch(kunde->nr());
+    } else {
+        mAllKunde.append(kunde);
+    }
+    indexKunde(kunde);
+}
+
+// lazy: Kunde* at pos of the key index - read with its page if not in memory
+Kunde* DataManager::kundeAt(const int& pos)
+{
+    if (pos < 0 || pos >= mKundePager->count()) {
+        qWarning() << "cannot get Kunde* at pos " << pos << " size is " << mKundePager->count();
+        return 0;
+    }
+    int nr = mKundePager->keyAt(pos);
+    Kunde* kunde = mKundeByNr.value(nr, 0);
+    if (!kunde) {
+        materializeKundePage(pos / KundePager::pageSize);
+        kunde = mKundeByNr.value(nr, 0);
+    }
+    if (kunde) {
+        handOutKunde(kunde);
+    }
+    return kunde;
+}
+
+/*
+ * the caller gets the Kunde*: least recently used is now,
+ * pinned until the event loop runs again - see findKundeByNr()
+ */
+void DataManager::handOutKunde(Kunde* kunde)
+{
+    mKundePager->touch(kunde->nr());
+    mHandedOutKunde.insert(kunde);
+    if (mPinnedKunde.isEmpty()) {
+        QTimer::singleShot(0, this, SLOT(onKundePinsExpired()));
+    }
+    mPinnedKunde.insert(kunde);
+}
+
+void DataManager::onKundePinsExpired()
+{
+    mPinnedKunde.clear();
+}
+
+void DataManager::retainKunde(Kunde* kunde)
+{
+    if (kunde) {
+        mRetainedKunde.insert(kunde, mRetainedKunde.value(kunde, 0) + 1);
+    }
+}
+
+void DataManager::releaseKunde(Kunde* kunde)
+{
+    int count = mRetainedKunde.value(kunde, 0);
+    if (count > 1) {
+        mRetainedKunde.insert(kunde, count - 1);
+    } else {
+        mRetainedKunde.remove(kunde);
+    }
+}
+
+void DataManager::materializeKundePage(const int& page)
+{
+    QList<Kunde*> kundeList = mKundePager->loadPage(page);
+    for (int i = 0; i < kundeList.size(); ++i) {
+        Kunde* kunde = kundeList.at(i);
+        int nr = kunde->nr();
+        // already in memory (maybe changed) or deleted and not saved yet
+        if (mKundeByNr.contains(nr) || !mKundePager->containsKey(nr)) {
+            delete kunde;
+            continue;
+        }
+        // Important: DataManager must be parent of all root DTOs
+        kunde->setParent(this);
+        indexKunde(kunde);
+        mKundePager->touch(nr);
+    }
+    evictKundeAboveBudget();
+}
+
+void DataManager::evictKundeAboveBudget()
+{
+    // allKunde(): the caller holds all Kunde*
+    if (!mAllKundeHandedOut && mKundeEvictionSuspended == 0
+            && mKundeByNr.size() > mLazyKundeBudget) {
+        evictKunde();
+    }
+}
+
+/*
+ * down to 3/4 of the budget - so not every page read evicts
+ * dirty Kunde* stay until the delta is saved
+ * Kunde* handed out (kundeAt(), findKundeByNr()) stay until the event loop runs,
+ * then while QML or others are connected to them or they are retained -
+ * unbound ones are deleted, QML guards its pointers
+ * Auftrag* pointing to an evicted Kunde* resolve it again on demand
+ */
+void DataManager::evictKunde()
+{
+    QSet<int> pinned;
+    QSetIterator<Kunde*> dirtyIterator(mDirtyKunde);
+    while (dirtyIterator.hasNext()) {
+        pinned.insert(dirtyIterator.next()->nr());
+    }
+    QSetIterator<Kunde*> handedOutIterator(mHandedOutKunde);
+    while (handedOutIterator.hasNext()) {
+        Kunde* kunde = handedOutIterator.next();
+        if (kunde->isObserved() || mPinnedKunde.contains(kunde) || mRetainedKunde.contains(kunde)) {
+            pinned.insert(kunde->nr());
+        }
+    }
+    QList<int> keys = mKundePager->leastRecentlyUsed(
+            mKundeByNr.size() - mLazyKundeBudget * 3 / 4, pinned);
+    for (int i = 0; i < keys.size(); ++i) {
+        int nr = keys.at(i);
+        mKundePager->forget(nr);
+        Kunde* kunde = mKundeByNr.value(nr, 0);
+        if (!kunde) {
+            continue;
+        }
+        unindexKunde(kunde);
+        if (mKundePager->hasRecords()) {
+            // the record is the only copy now
+            mKundePager->storeRecord(kunde->toRecord());
+        }
+        QMultiHash<int, Auftrag*>::const_iterator it = mAuftragByAuftraggeber.constFind(nr);
+        while (it != mAuftragByAuftraggeber.constEnd() && it.key() == nr) {
+            if (it.value()->auftraggeberAsDataObject() == kunde) {
+                it.value()->releaseAuftraggeberAsDataObject();
+            }
+            ++it;
+        }
+        // QML may still hold it until the next event loop
+        kunde->deleteLater();
+        mEvictedKunde++;
+    }
+    qDebug() << "evicted Kunde* #" << keys.size() << " in memory #" << mKundeByNr.size();
+}
+/**
+ * DomainKey of an already inserted Kunde was changed
+ * the old key isn't known from the SIGNAL, so we search the entry
+ * DomainKeys normally never change - so this is a rare operation
+ */
+void DataManager::onKundeNrChanged(int nr)
+{
+    Kunde* kunde = qobject_cast<Kunde*>(sender());
+    if (!kunde) {
+        return;
+    }
+    QMutableHashIterator<int, Kunde*> i(mKundeByNr);
+    while (i.hasNext()) {
+        i.next();
+        if (i.value() == kunde) {
+            // persisted with the old key
+            mDeletedKundeNr.insert(i.key());
+            if (mKundePager) {
+                mKundePager->removeKey(i.key());
+                mKundePager->forget(i.key());
+            }
+            i.remove();
+            break;
+        }
+    }
+    mKundeByNr.insert(nr, kunde);
+    mDirtyKunde.insert(kunde);
+    if (mKundePager) {
+        mKundePager->insertKey(nr);
+        mKundePager->touch(nr);
     }
-    qDebug() << "no DataModel found for " << objectName;
 }
-
-void DataManager::insertItemIntoKundeDataModel(QString objectName, Kunde* listItem)
+/**
+ * dirty tracking: a property of an inserted Kunde was changed
+ */
+void DataManager::onKundeChanged()
 {
-    // using dynamic created Pages / Lists it's a good idea to use findChildren ... last()
-    // probably there are GroupDataModels not deleted yet from previous destroyed Pages
-    QList<GroupDataModel*> dataModelList = Application::instance()->scene()->findChildren<
-            GroupDataModel*>(objectName);
-    if (dataModelList.size() > 0) {
-        GroupDataModel* dataModel = dataModelList.last();
-        if (dataModel) {
-            dataModel->insert(listItem);
-        }
-        return;
+    Kunde* kunde = qobject_cast<Kunde*>(sender());
+    if (kunde) {
+        mDirtyKunde.insert(kunde);
     }
-    qDebug() << "no DataModel found for " << objectName;
 }
-
-// nr is DomainKey
-Kunde* DataManager::findKundeByNr(const int& nr){
-    for (int i = 0; i < mAllKunde.size(); ++i) {
-        Kunde* kunde;
-        kunde = (Kunde*)mAllKunde.at(i);
-        if(kunde->nr() == nr){
-            return kunde;
-        }
-    }
-    qDebug() << "no Kunde found for nr " << nr;
-    return 0;
+void DataManager::markKundeDeleted(Kunde* kunde)
+{
+    mDirtyKunde.remove(kunde);
+    mDeletedKundeNr.insert(kunde->nr());
+}
+// all Kunde deleted: cache will be rewritten
+void DataManager::markAllKundeDeleted()
+{
+    mDirtyKunde.clear();
+    mDeletedKundeNr.clear();
+    mKundeCacheOutdated = true;
 }
 /*
- * reads Maps of Auftrag in from JSON cache
- * creates List of Auftrag*  from QVariantList
+ * reads Auftrag in from JSON cache
+ * streaming (default) or from QVariantList - see setStreamingJsonCache()
  * List declared as list of QObject* - only way to use in GroupDataModel
  */
 void DataManager::initAuftragFromCache()
 {
 	qDebug() << "start initAuftragFromCache";
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
     mAllAuftrag.clear();
+    clearAuftragIndex();
+    long heapBefore = heapInUseKb();
+    if (mStreamingJsonCache) {
+        initAuftragFromCacheStream();
+    } else {
+        initAuftragFromCacheMap();
+    }
+    // retained by the DTOs - the QVariant tree is logged by initAuftragFromCacheMap()
+    qDebug() << "initAuftragFromCache streaming: " << mStreamingJsonCache
+            << " Auftrag* #" << mAllAuftrag.size() << " in ms: " << elapsedTimer.elapsed()
+            << " heap kB: " << heapInUseKb() - heapBefore;
+}
+
+/*
+ * reads Maps of Auftrag in from JSON cache
+ * creates List of Auftrag*  from QVariantList
+ */
+void DataManager::initAuftragFromCacheMap()
+{
+    long heapBefore = heapInUseKb();
     QVariantList cacheList;
     cacheList = readFromCache(cacheAuftrag);
     qDebug() << "read Auftrag from cache #" << cacheList.size();
@@ -748,8 +2920,274 @@ void DataManager::initAuftragFromCache()
         auftrag->setParent(this);
         auftrag->fillFromCacheMap(cacheMap);
         mAllAuftrag.append(auftrag);
+        indexAuftrag(auftrag);
+    }
+    // peak of this path: DTOs and QVariant tree both alive
+    qDebug() << "created Auftrag* #" << mAllAuftrag.size() << " heap kB with QVariant tree: "
+            << heapInUseKb() - heapBefore;
+}
+
+/*
+ * reads Auftrag in from JSON cache as stream of tokens
+ * Auftrag* and Position* are created directly from the tokens
+ * without an intermediate QVariantList / QVariantMap tree
+ */
+void DataManager::initAuftragFromCacheStream()
+{
+    QFile dataFile;
+    CacheCodecDevice codecDevice(&dataFile);
+    QIODevice* device = openCacheStream(cacheAuftrag, dataFile, codecDevice);
+    if (!device) {
+        return;
+    }
+    JsonStreamReader reader(device);
+    if (reader.readNext() != JsonStreamReader::BeginArray) {
+        qWarning() << "no JSON Array found in " << cacheAuftrag;
+        return;
+    }
+    while (reader.readNext() == JsonStreamReader::BeginObject) {
+        Auftrag* auftrag = new Auftrag();
+        // Important: DataManager must be parent of all root DTOs
+        auftrag->setParent(this);
+        auftrag->fillFromCacheStream(reader);
+        if (reader.hasError()) {
+            // half filled: never append
+            delete auftrag;
+            break;
+        }
+        mAllAuftrag.append(auftrag);
+        indexAuftrag(auftrag);
+    }
+    if (reader.hasError()) {
+        qWarning() << "error reading " << cacheAuftrag << ":" << reader.errorString();
+    }
+    qDebug() << "streamed and created Auftrag* #" << mAllAuftrag.size();
+}
+
+/*
+ * reads Auftrag, Positionen and keys of tags from SQLite cache
+ * tables auftrag, position, auftrag_tag are merged in one pass
+ * returns false if there are no tables yet
+ */
+bool DataManager::initAuftragFromSqlCache()
+{
+    if (!mDatabaseAvailable) {
+        return false;
+    }
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+    AuftragSqlReader reader(mDatabase);
+    if (!reader.open()) {
+        return false;
+    }
+    qDebug() << "start initAuftrag From S Q L Cache";
+    mAllAuftrag.clear();
+    clearAuftragIndex();
+    long heapBefore = heapInUseKb();
+    Auftrag* auftrag;
+    while ((auftrag = reader.next()) != 0) {
+        // Important: DataManager must be parent of all root DTOs
+        auftrag->setParent(this);
+        mAllAuftrag.append(auftrag);
+        indexAuftrag(auftrag);
+    }
+    qDebug() << "read from SQLite and created Auftrag* #" << mAllAuftrag.size() << " in ms: "
+            << elapsedTimer.elapsed() << " heap kB: " << heapInUseKb() - heapBefore;
+    return true;
+}
+
+/*
+ * save List of Auftrag* to SQLite cache
+ * tables auftrag, position and auftrag_tag are dropped and created
+ * INSERT chunks of Auftrag (default: 10k) with their Positionen and tags
+ */
+bool DataManager::saveAuftragToSqlCache()
+{
+    // events are processed between two chunks: mAllAuftrag may change meanwhile
+    QList<AuftragRecord> records = auftragRecords();
+    qDebug() << "now caching Auftrag* into SQLite #" << records.size();
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+    bulkImport(true);
+    bool success = false;
+    // DROP fails if statements on the tables are active
+    mStatements.finishAll();
+    QSqlQuery query (mDatabase);
+    QStringList commands;
+    commands << "DROP TABLE IF EXISTS auftrag" << "DROP TABLE IF EXISTS position"
+            << "DROP TABLE IF EXISTS auftrag_tag" << Auftrag::createTableCommand()
+            << Position::createTableCommand() << Auftrag::createTagsTableCommand();
+    for (int i = 0; i < commands.size(); ++i) {
+        query.clear();
+        success = query.exec(commands.at(i));
+        if(!success) {
+            qWarning() << "NO SUCCESS " << commands.at(i);
+            bulkImport(false);
+            return false;
+        }
+    }
+    qDebug() << "tables CREATED auftrag, position, auftrag_tag";
+    QString insertSQL = Auftrag::createParameterizedInsertPosBinding();
+    QString insertPositionSQL = Position::createParameterizedInsertPosBinding();
+    QString insertTagsSQL = Auftrag::createParameterizedInsertTagsPosBinding();
+    ChunkSizer chunkSizer(mChunkSize, mAdaptiveChunkSize, mChunkMinLatencyMs, mChunkMaxLatencyMs);
+    mSqlImportRunning = true;
+    QElapsedTimer chunkTimer;
+    int fromPos = 0;
+    while (fromPos < records.size()) {
+        int toPos = qMin(fromPos + chunkSizer.chunkSize(), records.size());
+        chunkTimer.start();
+        if (!mDatabase.transaction()) {
+            qWarning() << "NO SUCCESS BEGIN TRANSACTION";
+            mSqlImportRunning = false;
+            bulkImport(false);
+            return false;
+        }
+        success = insertAuftragIntoSqlCache(records, fromPos, toPos, insertSQL, insertPositionSQL, insertTagsSQL);
+        if(!success || !mDatabase.commit()) {
+            qWarning() << "NO SUCCESS INSERT batch auftrag";
+            mDatabase.rollback();
+            mSqlImportRunning = false;
+            bulkImport(false);
+            return false;
+        }
+        chunkSizer.chunkDone(toPos - fromPos, chunkTimer.elapsed());
+        fromPos = toPos;
+        yieldBetweenChunks();
+    }
+    mSqlImportRunning = false;
+    mChunkStats.insert("auftrag", chunkSizer.stats());
+    bulkImport(false);
+    qDebug() << "END INSERT chunks of auftrag in ms: " << elapsedTimer.elapsed();
+    return success;
+}
+
+/*
+ * INSERT records fromPos .. toPos-1 with Positionen and tags using execBatch
+ * caller is responsible for the transaction
+ */
+bool DataManager::insertAuftragIntoSqlCache(const QList<AuftragRecord>& records, const int& fromPos,
+        const int& toPos, const QString& insertSQL, const QString& insertPositionSQL,
+        const QString& insertTagsSQL)
+{
+    QVariantList nrList, datumList, bemerkungList, auftraggeberList;
+    QVariantList uuidList, auftragNrList, posIndexList, bezeichnungList, preisList;
+    QVariantList tagsAuftragNrList, tagIndexList, tagsUuidList;
+    for (int i = fromPos; i < toPos; ++i) {
+        const AuftragRecord& record = records.at(i);
+        Auftrag::toSqlCache(record, nrList, datumList, bemerkungList, auftraggeberList);
+        Auftrag::positionenToSqlCache(record, uuidList, auftragNrList, posIndexList, bezeichnungList, preisList);
+        Auftrag::tagsToSqlCache(record, tagsAuftragNrList, tagIndexList, tagsUuidList);
+    }
+    if (!nrList.isEmpty()) {
+        QSqlQuery& query = mStatements.prepared(insertSQL);
+        query.bindValue(0, nrList);
+        query.bindValue(1, datumList);
+        query.bindValue(2, bemerkungList);
+        query.bindValue(3, auftraggeberList);
+        if (!query.execBatch()) {
+            qWarning() << "NO SUCCESS INSERT batch auftrag " << query.lastError().text();
+            return false;
+        }
+    }
+    if (!uuidList.isEmpty()) {
+        QSqlQuery& query = mStatements.prepared(insertPositionSQL);
+        query.bindValue(0, uuidList);
+        query.bindValue(1, auftragNrList);
+        query.bindValue(2, posIndexList);
+        query.bindValue(3, bezeichnungList);
+        query.bindValue(4, preisList);
+        if (!query.execBatch()) {
+            qWarning() << "NO SUCCESS INSERT batch position " << query.lastError().text();
+            return false;
+        }
+    }
+    if (!tagsUuidList.isEmpty()) {
+        QSqlQuery& query = mStatements.prepared(insertTagsSQL);
+        query.bindValue(0, tagsAuftragNrList);
+        query.bindValue(1, tagIndexList);
+        query.bindValue(2, tagsUuidList);
+        if (!query.execBatch()) {
+            qWarning() << "NO SUCCESS INSERT batch auftrag_tag " << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * position table of an older cache: uuid was the primary key
+ */
+bool DataManager::isPositionTableOutdated()
+{
+    QSqlQuery query(mDatabase);
+    if (!query.exec("SELECT sql FROM sqlite_master WHERE type = 'table' AND name = 'position'") || !query.next()) {
+        return true;
+    }
+    return Position::isOutdatedTableCommand(query.value(0).toString());
+}
+
+/*
+ * save only changed, inserted and deleted Auftrag* to SQLite cache
+ * one transaction:
+ * batched DELETE of removed Auftrag from all three tables,
+ * Positionen and tags of changed Auftrag are deleted and inserted again,
+ * UPSERT of the changed auftrag rows
+ * tables don't exist or cache is outdated: complete rewrite
+ */
+bool DataManager::saveAuftragDeltaToSqlCache(const QSet<Auftrag*>& dirtyAuftrag,
+        const QSet<int>& deletedAuftragNr, const bool& outdated)
+{
+    if (outdated || !mDatabase.tables().contains("auftrag") || isPositionTableOutdated()) {
+        return saveAuftragToSqlCache();
+    }
+    qDebug() << "now caching delta Auftrag* changed #" << dirtyAuftrag.size() << " deleted #" << deletedAuftragNr.size();
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+    // deleted: keys which are not used again by a changed Auftrag
+    QVariantList deletedNrList;
+    QSetIterator<int> deletedIterator(deletedAuftragNr);
+    while (deletedIterator.hasNext()) {
+        int nr = deletedIterator.next();
+        if (!mAuftragByNr.contains(nr)) {
+            deletedNrList << nr;
+        }
+    }
+    // Positionen and tags are replaced for deleted and changed Auftrag
+    QVariantList replacedNrList = deletedNrList;
+    QList<AuftragRecord> dirtyList;
+    QSetIterator<Auftrag*> dirtyIterator(dirtyAuftrag);
+    while (dirtyIterator.hasNext()) {
+        Auftrag* auftrag = dirtyIterator.next();
+        dirtyList.append(auftrag->toRecord());
+        replacedNrList << auftrag->nr();
+    }
+    if (!mDatabase.transaction()) {
+        qWarning() << "NO SUCCESS BEGIN TRANSACTION";
+        return false;
+    }
+    bool success = deleteKeysFromSqlCache(&Auftrag::createParameterizedDeleteByKeys, deletedNrList)
+            && deleteKeysFromSqlCache(&Position::createParameterizedDeleteByAuftragNrs, replacedNrList)
+            && deleteKeysFromSqlCache(&Auftrag::createParameterizedDeleteTagsByKeys, replacedNrList);
+    if (success) {
+        QString upsertSQL;
+        if (mSqlUpsertSupported) {
+            upsertSQL = Auftrag::createParameterizedUpsertPosBinding();
+        } else {
+            upsertSQL = Auftrag::createParameterizedInsertOrReplacePosBinding();
+        }
+        success = insertAuftragIntoSqlCache(dirtyList, 0, dirtyList.size(), upsertSQL,
+                Position::createParameterizedInsertPosBinding(),
+                Auftrag::createParameterizedInsertTagsPosBinding());
     }
-    qDebug() << "created Auftrag* #" << mAllAuftrag.size();
+    if (!success || !mDatabase.commit()) {
+        qWarning() << "NO SUCCESS delta auftrag";
+        mDatabase.rollback();
+        return false;
+    }
+    qDebug() << "delta Auftrag* written #" << dirtyList.size() << " deleted #" << deletedNrList.size()
+            << " in ms: " << elapsedTimer.elapsed();
+    return true;
 }
 
 
@@ -758,8 +3196,11 @@ void DataManager::initAuftragFromCache()
  * convert list of Auftrag* to QVariantList
  * toCacheMap stores all properties without transient values
  */
-void DataManager::saveAuftragToCache()
+bool DataManager::saveAuftragToCache()
 {
+    if (mStreamingJsonCache) {
+        return saveAuftragToCacheStream();
+    }
     QVariantList cacheList;
     qDebug() << "now caching Auftrag* #" << mAllAuftrag.size();
     for (int i = 0; i < mAllAuftrag.size(); ++i) {
@@ -770,7 +3211,33 @@ void DataManager::saveAuftragToCache()
         cacheList.append(cacheMap);
     }
     qDebug() << "Auftrag* converted to JSON cache #" << cacheList.size();
-    writeToCache(cacheAuftrag, cacheList);
+    return writeToCache(cacheAuftrag, cacheList);
+}
+
+/*
+ * writes Auftrag* (including Positionen) to JSON cache one by one
+ * only the write buffer is in memory - not the whole cache
+ */
+bool DataManager::saveAuftragToCacheStream()
+{
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+    long heapBefore = heapInUseKb();
+    JsonStreamWriter writer(dataPath(cacheAuftrag), (CacheCodec::Codec) mCacheCodec);
+    if (!writer.open()) {
+        return false;
+    }
+    writer.beginArray();
+    for (int i = 0; i < mAllAuftrag.size(); ++i) {
+        ((Auftrag*) mAllAuftrag.at(i))->toCacheStream(writer);
+    }
+    writer.endArray();
+    // write buffer only - no QVariantList of the whole cache
+    long heapKb = heapInUseKb() - heapBefore;
+    bool committed = writer.commit();
+    qDebug() << "Auftrag* streamed to JSON cache #" << mAllAuftrag.size() << " in ms: "
+            << elapsedTimer.elapsed() << " heap kB: " << heapKb;
+    return committed;
 }
 
 
@@ -795,45 +3262,92 @@ void DataManager::resolveAuftragReferences(Auftrag* auftrag)
     	}
     }
     if (!auftrag->areTagsKeysResolved()) {
+        QList<UuidKey> missingKeys;
+        mResolvingReferences = true;
         auftrag->resolveTagsKeys(
-                listOfSchlagwortForKeys(auftrag->tagsKeys()));
+                resolveSchlagwortKeys(auftrag->tagsUuidKeys(), missingKeys));
+        mResolvingReferences = false;
+        if (!missingKeys.isEmpty()) {
+            qWarning() << "not all tags found for Auftrag: " << auftrag->nr() << " missing #" << missingKeys.size();
+        }
     }
 }
 void DataManager::resolveReferencesForAllAuftrag()
 {
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
     for (int i = 0; i < mAllAuftrag.size(); ++i) {
         Auftrag* auftrag;
         auftrag = (Auftrag*)mAllAuftrag.at(i);
     	resolveAuftragReferences(auftrag);
     }
+    // lookups are using the primary key index:
+    // time per Auftrag should stay constant while number of Kunde grows
+    qDebug() << "resolved references for Auftrag* #" << mAllAuftrag.size()
+            << " Kunde* #" << mKundeByNr.size()
+            << " in ms: " << elapsedTimer.elapsed();
 }
 /**
 * converts a list of keys in to a list of DataObjects
 * per ex. used to resolve lazy arrays
+* keys are resolved in one batch - see resolveAuftragKeys()
 */
 QList<Auftrag*> DataManager::listOfAuftragForKeys(
         QStringList keyList)
 {
+    QList<int> keys;
+    QStringList invalidKeys;
+    keys.reserve(keyList.size());
+    for (int i = 0; i < keyList.size(); ++i) {
+        bool ok;
+        int nr = keyList.at(i).toInt(&ok);
+        if (ok) {
+            keys.append(nr);
+        } else {
+            invalidKeys.append(keyList.at(i));
+        }
+    }
+    QList<int> missingKeys;
     QList<Auftrag*> listOfData;
-    keyList.removeDuplicates();
-    if (keyList.isEmpty()) {
+    listOfData = resolveAuftragKeys(keys, missingKeys);
+    for (int i = 0; i < missingKeys.size(); ++i) {
+        invalidKeys.append(QString::number(missingKeys.at(i)));
+    }
+    if (invalidKeys.isEmpty()) {
         return listOfData;
     }
-    for (int i = 0; i < mAllAuftrag.size(); ++i) {
+    qWarning() << "not all keys found for Auftrag: " << invalidKeys.join(", ");
+    return listOfData;
+}
+/**
+* batch resolution of a set of keys (domainKey nr)
+* linear in number of keys: each key is a lookup into the primary key index
+* result is in order of the keys, duplicate keys are resolved only once
+* keys not found are appended to missingKeys
+*/
+QList<Auftrag*> DataManager::resolveAuftragKeys(const QList<int>& keys, QList<int>& missingKeys)
+{
+    QList<Auftrag*> listOfData;
+    if (keys.isEmpty()) {
+        return listOfData;
+    }
+    listOfData.reserve(keys.size());
+    QSet<int> resolvedKeys;
+    resolvedKeys.reserve(keys.size());
+    for (int i = 0; i < keys.size(); ++i) {
+        const int& nr = keys.at(i);
+        if (resolvedKeys.contains(nr)) {
+            continue;
+        }
+        resolvedKeys.insert(nr);
         Auftrag* auftrag;
-        auftrag = (Auftrag*) mAllAuftrag.at(i);
-        if (keyList.contains(QString::number(auftrag->nr()))) {
+        auftrag = mAuftragByNr.value(nr, 0);
+        if (auftrag && auftrag->nr() == nr) {
             listOfData.append(auftrag);
-            keyList.removeOne(QString::number(auftrag->nr()));
-            if(keyList.isEmpty()){
-                break;
-            }
+        } else {
+            missingKeys.append(nr);
         }
     }
-    if (keyList.isEmpty()) {
-        return listOfData;
-    }
-    qWarning() << "not all keys found for Auftrag: " << keyList.join(", ");
     return listOfData;
 }
 
@@ -868,6 +3382,8 @@ void DataManager::appendToAuftragProperty(
     if (dataManagerObject) {
         auftrag->setParent(dataManagerObject);
         dataManagerObject->mAllAuftrag.append(auftrag);
+        dataManagerObject->indexAuftrag(auftrag);
+        dataManagerObject->mDirtyAuftrag.insert(auftrag);
         emit dataManagerObject->addedToAllAuftrag(auftrag);
     } else {
         qWarning() << "cannot append Auftrag* to mAllAuftrag "
@@ -915,6 +3431,8 @@ void DataManager::clearAuftragProperty(
             auftrag = 0;
         }
         dataManager->mAllAuftrag.clear();
+        dataManager->clearAuftragIndex();
+        dataManager->markAllAuftragDeleted();
     } else {
         qWarning() << "cannot clear mAllAuftrag " << "Object is not of type DataManager*";
     }
@@ -935,6 +3453,8 @@ void DataManager::deleteAuftrag()
         auftrag = 0;
      }
      mAllAuftrag.clear();
+     clearAuftragIndex();
+     markAllAuftragDeleted();
 }
 
 /**
@@ -972,6 +3492,8 @@ void DataManager::insertAuftrag(Auftrag* auftrag)
     // Important: DataManager must be parent of all root DTOs
     auftrag->setParent(this);
     mAllAuftrag.append(auftrag);
+    indexAuftrag(auftrag);
+    mDirtyAuftrag.insert(auftrag);
     emit addedToAllAuftrag(auftrag);
 }
 
@@ -986,16 +3508,20 @@ void DataManager::insertAuftragFromMap(const QVariantMap& auftragMap,
         auftrag->fillFromMap(auftragMap);
     }
     mAllAuftrag.append(auftrag);
+    indexAuftrag(auftrag);
+    mDirtyAuftrag.insert(auftrag);
     emit addedToAllAuftrag(auftrag);
 }
 
 bool DataManager::deleteAuftrag(Auftrag* auftrag)
 {
     bool ok = false;
-    ok = mAllAuftrag.removeOne(auftrag);
+    ok = removeFromAllAuftrag(auftrag);
     if (!ok) {
         return ok;
     }
+    unindexAuftrag(auftrag);
+    markAuftragDeleted(auftrag);
     emit deletedFromAllAuftragByNr(auftrag->nr());
     emit deletedFromAllAuftrag(auftrag);
     auftrag->deleteLater();
@@ -1006,19 +3532,19 @@ bool DataManager::deleteAuftrag(Auftrag* auftrag)
 
 bool DataManager::deleteAuftragByNr(const int& nr)
 {
-    for (int i = 0; i < mAllAuftrag.size(); ++i) {
-        Auftrag* auftrag;
-        auftrag = (Auftrag*) mAllAuftrag.at(i);
-        if (auftrag->nr() == nr) {
-            mAllAuftrag.removeAt(i);
-            emit deletedFromAllAuftragByNr(nr);
-            emit deletedFromAllAuftrag(auftrag);
-            auftrag->deleteLater();
-            auftrag = 0;
-            return true;
-        }
+    Auftrag* auftrag;
+    auftrag = mAuftragByNr.value(nr, 0);
+    if (!auftrag || auftrag->nr() != nr) {
+        return false;
     }
-    return false;
+    removeFromAllAuftrag(auftrag);
+    unindexAuftrag(auftrag);
+    markAuftragDeleted(auftrag);
+    emit deletedFromAllAuftragByNr(nr);
+    emit deletedFromAllAuftrag(auftrag);
+    auftrag->deleteLater();
+    auftrag = 0;
+    return true;
 }
 
 void DataManager::fillAuftragDataModel(QString objectName)
@@ -1085,36 +3611,258 @@ void DataManager::removeItemFromAuftragDataModel(QString objectName, Auftrag* li
         }
         return;
     }
-    qDebug() << "no DataModel found for " << objectName;
+    qDebug() << "no DataModel found for " << objectName;
+}
+
+void DataManager::insertItemIntoAuftragDataModel(QString objectName, Auftrag* listItem)
+{
+    // using dynamic created Pages / Lists it's a good idea to use findChildren ... last()
+    // probably there are GroupDataModels not deleted yet from previous destroyed Pages
+    QList<GroupDataModel*> dataModelList = Application::instance()->scene()->findChildren<
+            GroupDataModel*>(objectName);
+    if (dataModelList.size() > 0) {
+        GroupDataModel* dataModel = dataModelList.last();
+        if (dataModel) {
+            dataModel->insert(listItem);
+        }
+        return;
+    }
+    qDebug() << "no DataModel found for " << objectName;
+}
+
+// nr is DomainKey
+// constant time lookup using the primary key index
+Auftrag* DataManager::findAuftragByNr(const int& nr){
+    Auftrag* auftrag;
+    auftrag = mAuftragByNr.value(nr, 0);
+    if (auftrag && auftrag->nr() == nr) {
+        return auftrag;
+    }
+    qDebug() << "no Auftrag found for nr " << nr;
+    return 0;
+}
+
+/**
+ * primary key index for Auftrag
+ * must be kept in sync with mAllAuftrag:
+ * index after append, unindex before the Auftrag* is deleted
+ * nrChanged is connected to keep the index valid if the DomainKey changes
+ */
+void DataManager::indexAuftrag(Auftrag* auftrag)
+{
+    mAuftragByNr.insert(auftrag->nr(), auftrag);
+    if (!mAllAuftrag.isEmpty() && mAllAuftrag.last() == auftrag) {
+        mAuftragPosition.insert(auftrag, mAllAuftrag.size() - 1);
+    }
+    connect(auftrag, SIGNAL(nrChanged(int)), this, SLOT(onAuftragNrChanged(int)), Qt::UniqueConnection);
+    // reverse index auftraggeber
+    mIndexedAuftraggeber.insert(auftrag, auftrag->auftraggeber());
+    if (auftrag->auftraggeber() != -1) {
+        mAuftragByAuftraggeber.insert(auftrag->auftraggeber(), auftrag);
+    }
+    connect(auftrag, SIGNAL(auftraggeberChanged(int)), this, SLOT(onAuftragAuftraggeberChanged(int)), Qt::UniqueConnection);
+    // inverted tag index
+    mTagIndex.update(auftrag, auftrag->tagsUuidKeys());
+    connect(auftrag, SIGNAL(addedToTags(Schlagwort*)), this, SLOT(onAuftragTagsChanged()), Qt::UniqueConnection);
+    connect(auftrag, SIGNAL(removedFromTags(Schlagwort*)), this, SLOT(onAuftragTagsChanged()), Qt::UniqueConnection);
+    connect(auftrag, SIGNAL(tagsChanged(QList<Schlagwort*>)), this, SLOT(onAuftragTagsChanged()), Qt::UniqueConnection);
+    // dirty tracking
+    connect(auftrag, SIGNAL(datumChanged(QDate)), this, SLOT(onAuftragChanged()), Qt::UniqueConnection);
+    connect(auftrag, SIGNAL(bemerkungChanged(QString)), this, SLOT(onAuftragChanged()), Qt::UniqueConnection);
+    connect(auftrag, SIGNAL(auftraggeberChanged(int)), this, SLOT(onAuftragChanged()), Qt::UniqueConnection);
+    connect(auftrag, SIGNAL(positionenChanged(QList<Position*>)), this, SLOT(onAuftragChanged()), Qt::UniqueConnection);
+    connect(auftrag, SIGNAL(addedToPositionen(Position*)), this, SLOT(onAuftragChanged()), Qt::UniqueConnection);
+    connect(auftrag, SIGNAL(removedFromPositionenByUuid(QString)), this, SLOT(onAuftragChanged()), Qt::UniqueConnection);
+    connect(auftrag, SIGNAL(changedInPositionen(Position*)), this, SLOT(onAuftragChanged()), Qt::UniqueConnection);
+    connect(auftrag, SIGNAL(tagsChanged(QList<Schlagwort*>)), this, SLOT(onAuftragChanged()), Qt::UniqueConnection);
+    connect(auftrag, SIGNAL(addedToTags(Schlagwort*)), this, SLOT(onAuftragChanged()), Qt::UniqueConnection);
+    connect(auftrag, SIGNAL(removedFromTags(Schlagwort*)), this, SLOT(onAuftragChanged()), Qt::UniqueConnection);
+}
+void DataManager::unindexAuftrag(Auftrag* auftrag)
+{
+    if (mAuftragByNr.value(auftrag->nr(), 0) == auftrag) {
+        mAuftragByNr.remove(auftrag->nr());
+    }
+    disconnect(auftrag, SIGNAL(nrChanged(int)), this, SLOT(onAuftragNrChanged(int)));
+    // reverse index auftraggeber
+    int auftraggeber = mIndexedAuftraggeber.take(auftrag);
+    mAuftragByAuftraggeber.remove(auftraggeber, auftrag);
+    disconnect(auftrag, SIGNAL(auftraggeberChanged(int)), this, SLOT(onAuftragAuftraggeberChanged(int)));
+    // inverted tag index
+    mTagIndex.remove(auftrag);
+    disconnect(auftrag, SIGNAL(addedToTags(Schlagwort*)), this, SLOT(onAuftragTagsChanged()));
+    disconnect(auftrag, SIGNAL(removedFromTags(Schlagwort*)), this, SLOT(onAuftragTagsChanged()));
+    disconnect(auftrag, SIGNAL(tagsChanged(QList<Schlagwort*>)), this, SLOT(onAuftragTagsChanged()));
+    disconnect(auftrag, SIGNAL(datumChanged(QDate)), this, SLOT(onAuftragChanged()));
+    disconnect(auftrag, SIGNAL(bemerkungChanged(QString)), this, SLOT(onAuftragChanged()));
+    disconnect(auftrag, SIGNAL(auftraggeberChanged(int)), this, SLOT(onAuftragChanged()));
+    disconnect(auftrag, SIGNAL(positionenChanged(QList<Position*>)), this, SLOT(onAuftragChanged()));
+    disconnect(auftrag, SIGNAL(addedToPositionen(Position*)), this, SLOT(onAuftragChanged()));
+    disconnect(auftrag, SIGNAL(removedFromPositionenByUuid(QString)), this, SLOT(onAuftragChanged()));
+    disconnect(auftrag, SIGNAL(changedInPositionen(Position*)), this, SLOT(onAuftragChanged()));
+    disconnect(auftrag, SIGNAL(tagsChanged(QList<Schlagwort*>)), this, SLOT(onAuftragChanged()));
+    disconnect(auftrag, SIGNAL(addedToTags(Schlagwort*)), this, SLOT(onAuftragChanged()));
+    disconnect(auftrag, SIGNAL(removedFromTags(Schlagwort*)), this, SLOT(onAuftragChanged()));
+}
+void DataManager::clearAuftragIndex()
+{
+    mAuftragByNr.clear();
+    mAuftragPosition.clear();
+    mAuftragByAuftraggeber.clear();
+    mIndexedAuftraggeber.clear();
+    mTagIndex.clear();
+}
+/**
+ * auftraggeber of an already inserted Auftrag was changed
+ * move the Auftrag* in reverse index from old Kunde nr to the new one
+ */
+void DataManager::onAuftragAuftraggeberChanged(int auftraggeber)
+{
+    Auftrag* auftrag = qobject_cast<Auftrag*>(sender());
+    if (!auftrag || !mIndexedAuftraggeber.contains(auftrag)) {
+        return;
+    }
+    int oldAuftraggeber = mIndexedAuftraggeber.value(auftrag);
+    mAuftragByAuftraggeber.remove(oldAuftraggeber, auftrag);
+    mIndexedAuftraggeber.insert(auftrag, auftraggeber);
+    if (auftraggeber != -1) {
+        mAuftragByAuftraggeber.insert(auftraggeber, auftrag);
+    }
+}
+
+/**
+ * tags of an already inserted Auftrag were added, removed or replaced
+ * re-index the (persisted) tag keys of this Auftrag
+ */
+void DataManager::onAuftragTagsChanged()
+{
+    Auftrag* auftrag = qobject_cast<Auftrag*>(sender());
+    if (!auftrag || !mIndexedAuftraggeber.contains(auftrag)) {
+        return;
+    }
+    mTagIndex.update(auftrag, auftrag->tagsUuidKeys());
+}
+
+/**
+ * filter Auftrag by tags
+ * uses the inverted tag index: no need to resolve the tags of all Auftrag
+ * result is in order of insertion (per ex. as read from cache)
+ */
+QList<QObject*> DataManager::listOfAuftragForTags(const QStringList& allOfTags,
+        const QStringList& anyOfTags, const QStringList& noneOfTags)
+{
+    QList<UuidKey> allOf, anyOf, noneOf;
+    for (int i = 0; i < allOfTags.size(); ++i) {
+        allOf.append(UuidKey::fromString(allOfTags.at(i)));
+    }
+    for (int i = 0; i < anyOfTags.size(); ++i) {
+        anyOf.append(UuidKey::fromString(anyOfTags.at(i)));
+    }
+    for (int i = 0; i < noneOfTags.size(); ++i) {
+        noneOf.append(UuidKey::fromString(noneOfTags.at(i)));
+    }
+    QList<Auftrag*> auftragList;
+    auftragList = listOfAuftragForTagKeys(allOf, anyOf, noneOf);
+    QList<QObject*> listOfData;
+    listOfData.reserve(auftragList.size());
+    for (int i = 0; i < auftragList.size(); ++i) {
+        listOfData.append(auftragList.at(i));
+    }
+    return listOfData;
+}
+QList<Auftrag*> DataManager::listOfAuftragForTagKeys(const QList<UuidKey>& allOfTags,
+        const QList<UuidKey>& anyOfTags, const QList<UuidKey>& noneOfTags)
+{
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+    QList<Auftrag*> auftragList;
+    auftragList = mTagIndex.query(allOfTags, anyOfTags, noneOfTags);
+    qDebug() << "tag query found Auftrag* #" << auftragList.size() << " of "
+            << mTagIndex.documentCount() << " in ms: " << elapsedTimer.elapsed();
+    return auftragList;
+}
+
+/**
+ * all Auftrag of a Kunde (auftraggeber)
+ * uses the reverse index - no scan of all Auftrag
+ */
+QList<QObject*> DataManager::listOfAuftragForAuftraggeber(const int& nr)
+{
+    QList<QObject*> listOfData;
+    QMultiHash<int, Auftrag*>::const_iterator i = mAuftragByAuftraggeber.constFind(nr);
+    while (i != mAuftragByAuftraggeber.constEnd() && i.key() == nr) {
+        listOfData.append(i.value());
+        ++i;
+    }
+    return listOfData;
+}
+
+/**
+ * Kunde will be deleted: all Auftrag resolved to this Kunde*
+ * must forget the pointer - otherwise it would be dangling
+ * only the Auftrag of this Kunde are touched (reverse index)
+ */
+void DataManager::invalidateAuftraggeberReferences(Kunde* kunde)
+{
+    QMultiHash<int, Auftrag*>::const_iterator i = mAuftragByAuftraggeber.constFind(kunde->nr());
+    while (i != mAuftragByAuftraggeber.constEnd() && i.key() == kunde->nr()) {
+        Auftrag* auftrag = i.value();
+        if (auftrag->auftraggeberAsDataObject() == kunde) {
+            auftrag->markAuftraggeberAsInvalid();
+        }
+        ++i;
+    }
+}
+/**
+ * DomainKey of an already inserted Auftrag was changed
+ * the old key isn't known from the SIGNAL, so we search the entry
+ * DomainKeys normally never change - so this is a rare operation
+ */
+void DataManager::onAuftragNrChanged(int nr)
+{
+    Auftrag* auftrag = qobject_cast<Auftrag*>(sender());
+    if (!auftrag) {
+        return;
+    }
+    QMutableHashIterator<int, Auftrag*> i(mAuftragByNr);
+    while (i.hasNext()) {
+        i.next();
+        if (i.value() == auftrag) {
+            // persisted with the old key
+            mDeletedAuftragNr.insert(i.key());
+            i.remove();
+            break;
+        }
+    }
+    mAuftragByNr.insert(nr, auftrag);
+    mDirtyAuftrag.insert(auftrag);
 }
-
-void DataManager::insertItemIntoAuftragDataModel(QString objectName, Auftrag* listItem)
+/**
+ * dirty tracking: a property, a Position or the tags
+ * of an inserted Auftrag were changed
+ * resolving the lazy tags is no change
+ */
+void DataManager::onAuftragChanged()
 {
-    // using dynamic created Pages / Lists it's a good idea to use findChildren ... last()
-    // probably there are GroupDataModels not deleted yet from previous destroyed Pages
-    QList<GroupDataModel*> dataModelList = Application::instance()->scene()->findChildren<
-            GroupDataModel*>(objectName);
-    if (dataModelList.size() > 0) {
-        GroupDataModel* dataModel = dataModelList.last();
-        if (dataModel) {
-            dataModel->insert(listItem);
-        }
+    if (mResolvingReferences) {
         return;
     }
-    qDebug() << "no DataModel found for " << objectName;
-}
-
-// nr is DomainKey
-Auftrag* DataManager::findAuftragByNr(const int& nr){
-    for (int i = 0; i < mAllAuftrag.size(); ++i) {
-        Auftrag* auftrag;
-        auftrag = (Auftrag*)mAllAuftrag.at(i);
-        if(auftrag->nr() == nr){
-            return auftrag;
-        }
+    Auftrag* auftrag = qobject_cast<Auftrag*>(sender());
+    if (auftrag) {
+        mDirtyAuftrag.insert(auftrag);
     }
-    qDebug() << "no Auftrag found for nr " << nr;
-    return 0;
+}
+void DataManager::markAuftragDeleted(Auftrag* auftrag)
+{
+    mDirtyAuftrag.remove(auftrag);
+    mDeletedAuftragNr.insert(auftrag->nr());
+}
+// all Auftrag deleted: cache will be rewritten
+void DataManager::markAllAuftragDeleted()
+{
+    mDirtyAuftrag.clear();
+    mDeletedAuftragNr.clear();
+    mAuftragCacheOutdated = true;
 }
 /*
  * reads Maps of Schlagwort in from JSON cache
@@ -1125,6 +3873,11 @@ void DataManager::initSchlagwortFromCache()
 {
 	qDebug() << "start initSchlagwortFromCache";
     mAllSchlagwort.clear();
+    mSchlagwortByUuid.clear();
+    if (mStreamingJsonCache) {
+        initSchlagwortFromCacheStream();
+        return;
+    }
     QVariantList cacheList;
     cacheList = readFromCache(cacheSchlagwort);
     qDebug() << "read Schlagwort from cache #" << cacheList.size();
@@ -1136,10 +3889,47 @@ void DataManager::initSchlagwortFromCache()
         schlagwort->setParent(this);
         schlagwort->fillFromCacheMap(cacheMap);
         mAllSchlagwort.append(schlagwort);
+        indexSchlagwort(schlagwort);
     }
     qDebug() << "created Schlagwort* #" << mAllSchlagwort.size();
 }
 
+/*
+ * reads Schlagwort in from JSON cache as stream of tokens
+ * Schlagwort* are created directly from the tokens
+ */
+void DataManager::initSchlagwortFromCacheStream()
+{
+    QFile dataFile;
+    CacheCodecDevice codecDevice(&dataFile);
+    QIODevice* device = openCacheStream(cacheSchlagwort, dataFile, codecDevice);
+    if (!device) {
+        return;
+    }
+    JsonStreamReader reader(device);
+    if (reader.readNext() != JsonStreamReader::BeginArray) {
+        qWarning() << "no JSON Array found in " << cacheSchlagwort;
+        return;
+    }
+    while (reader.readNext() == JsonStreamReader::BeginObject) {
+        Schlagwort* schlagwort = new Schlagwort();
+        // Important: DataManager must be parent of all root DTOs
+        schlagwort->setParent(this);
+        schlagwort->fillFromCacheStream(reader);
+        if (reader.hasError()) {
+            // half filled: never append
+            delete schlagwort;
+            break;
+        }
+        mAllSchlagwort.append(schlagwort);
+        indexSchlagwort(schlagwort);
+    }
+    if (reader.hasError()) {
+        qWarning() << "error reading " << cacheSchlagwort << ":" << reader.errorString();
+    }
+    qDebug() << "streamed and created Schlagwort* #" << mAllSchlagwort.size();
+}
+
 
 /*
  * save List of Schlagwort* to JSON cache
@@ -1149,6 +3939,10 @@ void DataManager::initSchlagwortFromCache()
  */
 void DataManager::saveSchlagwortToCache()
 {
+    if (mStreamingJsonCache) {
+        saveSchlagwortToCacheStream();
+        return;
+    }
     QVariantList cacheList;
     qDebug() << "now caching Schlagwort* #" << mAllSchlagwort.size();
     for (int i = 0; i < mAllSchlagwort.size(); ++i) {
@@ -1162,33 +3956,84 @@ void DataManager::saveSchlagwortToCache()
     writeToCache(cacheSchlagwort, cacheList);
 }
 
+/*
+ * writes Schlagwort* to JSON cache one by one
+ */
+bool DataManager::saveSchlagwortToCacheStream()
+{
+    JsonStreamWriter writer(dataPath(cacheSchlagwort), (CacheCodec::Codec) mCacheCodec);
+    if (!writer.open()) {
+        return false;
+    }
+    writer.beginArray();
+    for (int i = 0; i < mAllSchlagwort.size(); ++i) {
+        ((Schlagwort*) mAllSchlagwort.at(i))->toCacheStream(writer);
+    }
+    writer.endArray();
+    qDebug() << "Schlagwort* streamed to JSON cache #" << mAllSchlagwort.size();
+    return writer.commit();
+}
+
 /**
 * converts a list of keys in to a list of DataObjects
 * per ex. used to resolve lazy arrays
+* keys are resolved in one batch - see resolveSchlagwortKeys()
 */
 QList<Schlagwort*> DataManager::listOfSchlagwortForKeys(
         QStringList keyList)
+{
+    QList<UuidKey> keys;
+    QStringList invalidKeys;
+    keys.reserve(keyList.size());
+    for (int i = 0; i < keyList.size(); ++i) {
+        UuidKey key = UuidKey::fromString(keyList.at(i));
+        if (key.isNull()) {
+            invalidKeys.append(keyList.at(i));
+        } else {
+            keys.append(key);
+        }
+    }
+    QList<UuidKey> missingKeys;
+    QList<Schlagwort*> listOfData;
+    listOfData = resolveSchlagwortKeys(keys, missingKeys);
+    for (int i = 0; i < missingKeys.size(); ++i) {
+        invalidKeys.append(missingKeys.at(i).toString());
+    }
+    if (invalidKeys.isEmpty()) {
+        return listOfData;
+    }
+    qWarning() << "not all keys found for Schlagwort: " << invalidKeys.join(", ");
+    return listOfData;
+}
+/**
+* batch resolution of a set of keys (domainKey uuid)
+* linear in number of keys: each key is a lookup into the primary key index
+* result is in order of the keys, duplicate keys are resolved only once
+* keys not found are appended to missingKeys
+*/
+QList<Schlagwort*> DataManager::resolveSchlagwortKeys(const QList<UuidKey>& keys, QList<UuidKey>& missingKeys)
 {
     QList<Schlagwort*> listOfData;
-    keyList.removeDuplicates();
-    if (keyList.isEmpty()) {
+    if (keys.isEmpty()) {
         return listOfData;
     }
-    for (int i = 0; i < mAllSchlagwort.size(); ++i) {
+    listOfData.reserve(keys.size());
+    QSet<UuidKey> resolvedKeys;
+    resolvedKeys.reserve(keys.size());
+    for (int i = 0; i < keys.size(); ++i) {
+        const UuidKey& uuid = keys.at(i);
+        if (resolvedKeys.contains(uuid)) {
+            continue;
+        }
+        resolvedKeys.insert(uuid);
         Schlagwort* schlagwort;
-        schlagwort = (Schlagwort*) mAllSchlagwort.at(i);
-        if (keyList.contains(schlagwort->uuid())) {
+        schlagwort = mSchlagwortByUuid.value(uuid, 0);
+        if (schlagwort && schlagwort->uuidAsKey() == uuid) {
             listOfData.append(schlagwort);
-            keyList.removeOne(schlagwort->uuid());
-            if(keyList.isEmpty()){
-                break;
-            }
+        } else {
+            missingKeys.append(uuid);
         }
     }
-    if (keyList.isEmpty()) {
-        return listOfData;
-    }
-    qWarning() << "not all keys found for Schlagwort: " << keyList.join(", ");
     return listOfData;
 }
 
@@ -1223,6 +4068,7 @@ void DataManager::appendToSchlagwortProperty(
     if (dataManagerObject) {
         schlagwort->setParent(dataManagerObject);
         dataManagerObject->mAllSchlagwort.append(schlagwort);
+        dataManagerObject->indexSchlagwort(schlagwort);
         emit dataManagerObject->addedToAllSchlagwort(schlagwort);
     } else {
         qWarning() << "cannot append Schlagwort* to mAllSchlagwort "
@@ -1270,6 +4116,7 @@ void DataManager::clearSchlagwortProperty(
             schlagwort = 0;
         }
         dataManager->mAllSchlagwort.clear();
+        dataManager->mSchlagwortByUuid.clear();
     } else {
         qWarning() << "cannot clear mAllSchlagwort " << "Object is not of type DataManager*";
     }
@@ -1290,6 +4137,7 @@ void DataManager::deleteSchlagwort()
         schlagwort = 0;
      }
      mAllSchlagwort.clear();
+     mSchlagwortByUuid.clear();
 }
 
 /**
@@ -1327,6 +4175,7 @@ void DataManager::insertSchlagwort(Schlagwort* schlagwort)
     // Important: DataManager must be parent of all root DTOs
     schlagwort->setParent(this);
     mAllSchlagwort.append(schlagwort);
+    indexSchlagwort(schlagwort);
     emit addedToAllSchlagwort(schlagwort);
 }
 
@@ -1341,6 +4190,7 @@ void DataManager::insertSchlagwortFromMap(const QVariantMap& schlagwortMap,
         schlagwort->fillFromMap(schlagwortMap);
     }
     mAllSchlagwort.append(schlagwort);
+    indexSchlagwort(schlagwort);
     emit addedToAllSchlagwort(schlagwort);
 }
 
@@ -1351,6 +4201,7 @@ bool DataManager::deleteSchlagwort(Schlagwort* schlagwort)
     if (!ok) {
         return ok;
     }
+    unindexSchlagwort(schlagwort);
     emit deletedFromAllSchlagwortByUuid(schlagwort->uuid());
     emit deletedFromAllSchlagwort(schlagwort);
     schlagwort->deleteLater();
@@ -1364,19 +4215,19 @@ bool DataManager::deleteSchlagwortByUuid(const QString& uuid)
         qDebug() << "cannot delete Schlagwort from empty uuid";
         return false;
     }
-    for (int i = 0; i < mAllSchlagwort.size(); ++i) {
-        Schlagwort* schlagwort;
-        schlagwort = (Schlagwort*) mAllSchlagwort.at(i);
-        if (schlagwort->uuid() == uuid) {
-            mAllSchlagwort.removeAt(i);
-            emit deletedFromAllSchlagwortByUuid(uuid);
-            emit deletedFromAllSchlagwort(schlagwort);
-            schlagwort->deleteLater();
-            schlagwort = 0;
-            return true;
-        }
+    UuidKey key = UuidKey::fromString(uuid);
+    Schlagwort* schlagwort;
+    schlagwort = mSchlagwortByUuid.value(key, 0);
+    if (!schlagwort || schlagwort->uuidAsKey() != key) {
+        return false;
     }
-    return false;
+    mAllSchlagwort.removeOne(schlagwort);
+    unindexSchlagwort(schlagwort);
+    emit deletedFromAllSchlagwortByUuid(uuid);
+    emit deletedFromAllSchlagwort(schlagwort);
+    schlagwort->deleteLater();
+    schlagwort = 0;
+    return true;
 }
 
 
@@ -1467,26 +4318,66 @@ Schlagwort* DataManager::findSchlagwortByUuid(const QString& uuid){
         qDebug() << "cannot find Schlagwort from empty uuid";
         return 0;
     }
-    for (int i = 0; i < mAllSchlagwort.size(); ++i) {
-        Schlagwort* schlagwort;
-        schlagwort = (Schlagwort*)mAllSchlagwort.at(i);
-        if(schlagwort->uuid() == uuid){
-            return schlagwort;
-        }
+    return findSchlagwortByUuidKey(UuidKey::fromString(uuid));
+}
+Schlagwort* DataManager::findSchlagwortByUuidKey(const UuidKey& uuid){
+    Schlagwort* schlagwort;
+    schlagwort = mSchlagwortByUuid.value(uuid, 0);
+    if (schlagwort && schlagwort->uuidAsKey() == uuid) {
+        return schlagwort;
     }
-    qDebug() << "no Schlagwort found for uuid " << uuid;
+    qDebug() << "no Schlagwort found for uuid " << uuid.toString();
     return 0;
 }
 
+/**
+ * primary key index for Schlagwort
+ * must be kept in sync with mAllSchlagwort:
+ * index after append, unindex before the Schlagwort* is deleted
+ * uuidChanged is connected to keep the index valid if the DomainKey changes
+ */
+void DataManager::indexSchlagwort(Schlagwort* schlagwort)
+{
+    mSchlagwortByUuid.insert(schlagwort->uuidAsKey(), schlagwort);
+    connect(schlagwort, SIGNAL(uuidChanged(QString)), this, SLOT(onSchlagwortUuidChanged(QString)), Qt::UniqueConnection);
+}
+void DataManager::unindexSchlagwort(Schlagwort* schlagwort)
+{
+    if (mSchlagwortByUuid.value(schlagwort->uuidAsKey(), 0) == schlagwort) {
+        mSchlagwortByUuid.remove(schlagwort->uuidAsKey());
+    }
+    disconnect(schlagwort, SIGNAL(uuidChanged(QString)), this, SLOT(onSchlagwortUuidChanged(QString)));
+}
+/**
+ * DomainKey of an already inserted Schlagwort was changed
+ * the old key isn't known from the SIGNAL, so we search the entry
+ * DomainKeys normally never change - so this is a rare operation
+ */
+void DataManager::onSchlagwortUuidChanged(QString uuid)
+{
+    Schlagwort* schlagwort = qobject_cast<Schlagwort*>(sender());
+    if (!schlagwort) {
+        return;
+    }
+    Q_UNUSED(uuid);
+    QMutableHashIterator<UuidKey, Schlagwort*> i(mSchlagwortByUuid);
+    while (i.hasNext()) {
+        i.next();
+        if (i.value() == schlagwort) {
+            i.remove();
+            break;
+        }
+    }
+    mSchlagwortByUuid.insert(schlagwort->uuidAsKey(), schlagwort);
+}
+
 
 /*
- * reads data in from stored cache
+ * checks if the cache file exists
  * if no cache found tries to get data from assets/datamodel
  */
-QVariantList DataManager::readFromCache(QString& fileName)
+bool DataManager::prepareCacheFile(QString& fileName)
 {
-    JsonDataAccess jda;
-    QVariantList cacheList;
     QFile dataFile(dataPath(fileName));
     if (!dataFile.exists()) {
         QFile assetDataFile(dataAssetsPath(fileName));
@@ -1495,24 +4386,535 @@ QVariantList DataManager::readFromCache(QString& fileName)
             bool copyOk = assetDataFile.copy(dataPath(fileName));
             if (!copyOk) {
                 qDebug() << "cannot copy dataAssetsPath(fileName) to dataPath(fileName)";
-                // no cache, no assets - empty list
-                return cacheList;
+                return false;
             }
         } else {
-            // no cache, no assets - empty list
-            return cacheList;
+            return false;
         }
     }
-    cacheList = jda.load(dataPath(fileName)).toList();
+    return true;
+}
+
+/*
+ * reads data in from stored cache
+ * if no cache found tries to get data from assets/datamodel
+ */
+QVariantList DataManager::readFromCache(QString& fileName)
+{
+    JsonDataAccess jda;
+    QVariantList cacheList;
+    if (!prepareCacheFile(fileName)) {
+        // no cache, no assets - empty list
+        return cacheList;
+    }
+    // plain or compressed: auto detected
+    bool ok;
+    QByteArray json = CacheCodec::readFile(dataPath(fileName), &ok);
+    if (!ok) {
+        qWarning() << "cache damaged: " << fileName;
+    }
+    cacheList = jda.loadFromBuffer(json).toList();
     return cacheList;
 }
 
-void DataManager::writeToCache(QString& fileName, QVariantList& data)
+/*
+ * opens the cache (copied from assets if needed)
+ * compressed cache: decompressed block by block while parsing
+ */
+QIODevice* DataManager::openCacheStream(QString& fileName, QFile& dataFile,
+        CacheCodecDevice& codecDevice)
+{
+    if (!prepareCacheFile(fileName)) {
+        return 0;
+    }
+    dataFile.setFileName(dataPath(fileName));
+    if (!dataFile.open(QIODevice::ReadOnly)) {
+        qWarning() << "cannot open " << fileName << ":" << dataFile.errorString();
+        return 0;
+    }
+    if (!CacheCodec::isCompressed(&dataFile)) {
+        return &dataFile;
+    }
+    if (!codecDevice.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+    return &codecDevice;
+}
+
+bool DataManager::writeToCache(QString& fileName, QVariantList& data)
 {
     QString filePath;
     filePath = dataPath(fileName);
     JsonDataAccess jda;
-    jda.save(data, filePath);
+    if (mCacheCodec == CacheCodec::PlainCodec) {
+        jda.save(data, filePath);
+        if (jda.hasError()) {
+            qWarning() << "cannot write " << fileName << ":" << jda.error().errorMessage();
+            return false;
+        }
+        return true;
+    }
+    QByteArray json;
+    jda.saveToBuffer(data, &json);
+    if (jda.hasError()) {
+        qWarning() << "cannot convert " << fileName << ":" << jda.error().errorMessage();
+        return false;
+    }
+    return CacheCodec::writeFile(filePath, json, (CacheCodec::Codec) mCacheCodec);
+}
+
+void DataManager::setCacheCodec(const int& codec)
+{
+    mCacheCodec = codec;
+}
+
+/*
+ * compares the codecs with the current Auftrag* as JSON
+ * per codec: size, encode, write (incl. fsync), read and decode time
+ * results are logged and returned - per ex. to show them in QML
+ * tradeoff on device: less Bytes written to flash vs CPU time
+ */
+QVariantList DataManager::benchmarkCacheCodecs()
+{
+    QVariantList results;
+    QVariantList cacheList;
+    for (int i = 0; i < mAllAuftrag.size(); ++i) {
+        cacheList.append(((Auftrag*) mAllAuftrag.at(i))->toCacheMap());
+    }
+    JsonDataAccess jda;
+    QByteArray json;
+    jda.saveToBuffer(cacheList, &json);
+    QString benchmarkPath = dataPath("codecBenchmark.tmp");
+    QElapsedTimer elapsedTimer;
+    for (int codec = CacheCodec::PlainCodec; codec <= CacheCodec::ZlibBestCodec; ++codec) {
+        elapsedTimer.start();
+        QByteArray encoded = CacheCodec::encode(json, (CacheCodec::Codec) codec);
+        qint64 encodeMs = elapsedTimer.elapsed();
+        elapsedTimer.start();
+        QFile benchmarkFile(benchmarkPath);
+        if (!benchmarkFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qWarning() << "cannot open " << benchmarkPath;
+            break;
+        }
+        benchmarkFile.write(encoded);
+        benchmarkFile.flush();
+        ::fsync(benchmarkFile.handle());
+        benchmarkFile.close();
+        qint64 writeMs = elapsedTimer.elapsed();
+        elapsedTimer.start();
+        QByteArray decoded = CacheCodec::readFile(benchmarkPath);
+        qint64 readMs = elapsedTimer.elapsed();
+        QVariantMap result;
+        result.insert("codec", codec);
+        result.insert("jsonBytes", json.size());
+        result.insert("fileBytes", encoded.size());
+        result.insert("encodeMs", encodeMs);
+        result.insert("writeMs", writeMs);
+        result.insert("readDecodeMs", readMs);
+        result.insert("verified", decoded == json);
+        qDebug() << "codec benchmark Auftrag* #" << mAllAuftrag.size() << result;
+        results.append(result);
+    }
+    QFile::remove(benchmarkPath);
+    return results;
+}
+
+/*
+ * heap: ::new / ::delete bypass the ObjectPool of Position
+ * heap in use is measured while all Position* exist
+ */
+QVariantMap DataManager::benchmarkPositionAllocation(const int& count)
+{
+    QVariantMap results;
+    int positionCount = qMax(1, count);
+    QList<Position*> positions;
+    positions.reserve(positionCount);
+    QElapsedTimer elapsedTimer;
+
+    long heapBefore = heapInUseKb();
+    elapsedTimer.start();
+    for (int i = 0; i < positionCount; ++i) {
+        positions.append(::new Position());
+    }
+    qint64 heapMs = elapsedTimer.elapsed();
+    long heapKb = heapInUseKb() - heapBefore;
+    elapsedTimer.start();
+    for (int i = 0; i < positions.size(); ++i) {
+        ::delete positions.at(i);
+    }
+    qint64 heapDeleteMs = elapsedTimer.elapsed();
+    positions.clear();
+
+    heapBefore = heapInUseKb();
+    elapsedTimer.start();
+    for (int i = 0; i < positionCount; ++i) {
+        positions.append(new Position());
+    }
+    qint64 poolMs = elapsedTimer.elapsed();
+    long poolKb = heapInUseKb() - heapBefore;
+    elapsedTimer.start();
+    for (int i = 0; i < positions.size(); ++i) {
+        delete positions.at(i);
+    }
+    qint64 poolDeleteMs = elapsedTimer.elapsed();
+    positions.clear();
+
+    results.insert("count", positionCount);
+    results.insert("heapAllocationsPerSecond", heapMs > 0 ? (qint64) positionCount * 1000 / heapMs : 0);
+    results.insert("heapDeleteMs", heapDeleteMs);
+    results.insert("heapInUseKb", (qint64) heapKb);
+    results.insert("poolAllocationsPerSecond", poolMs > 0 ? (qint64) positionCount * 1000 / poolMs : 0);
+    results.insert("poolDeleteMs", poolDeleteMs);
+    // slabs reused from earlier runs are not counted
+    results.insert("poolInUseKb", (qint64) poolKb);
+    results.insert("pool", Position::allocationPool().stats());
+    qDebug() << "Position allocation benchmark: " << results;
+    return results;
+}
+
+QVariantList DataManager::stringPoolStats()
+{
+    QVariantList statsList;
+    statsList << Kunde::ortPool().stats() << Position::bezeichnungPool().stats()
+            << Schlagwort::textPool().stats();
+    qDebug() << "String pools: " << statsList;
+    return statsList;
+}
+
+void DataManager::purgeStringPools()
+{
+    Kunde::ortPool().purge();
+    Position::bezeichnungPool().purge();
+    Schlagwort::textPool().purge();
+}
+
+/*
+ * reads table kunde 'rounds' times with QVariant values (fillFromSqlQuery(),
+ * as initKundeFromSqlCache() did before SqlRowDecoder) and typed (fillFromSqlRow())
+ * Kunde* are created without parent and deleted outside of the measured time
+ */
+QVariantMap DataManager::benchmarkSqlDecoding(const int& rounds)
+{
+    QVariantMap results;
+    if (!mDatabaseAvailable) {
+        return results;
+    }
+    int schemaVersion = SqlRowDecoder::schemaVersion(mDatabase);
+    QElapsedTimer elapsedTimer;
+    QList<Kunde*> created;
+    qint64 variantMs = 0;
+    qint64 typedMs = 0;
+    int variantRows = 0;
+    int typedRows = 0;
+    bool native = false;
+    for (int round = 0; round < qMax(1, rounds); ++round) {
+        elapsedTimer.start();
+        QSqlQuery& variantQuery = mStatements.prepared("SELECT * FROM kunde");
+        if (!variantQuery.exec()) {
+            qWarning() << "NO SUCCESS query kunde";
+            return results;
+        }
+        Kunde::fillSqlQueryPos(variantQuery.record());
+        while (variantQuery.next()) {
+            Kunde* kunde = new Kunde();
+            kunde->fillFromSqlQuery(variantQuery);
+            created.append(kunde);
+        }
+        variantQuery.finish();
+        variantMs += elapsedTimer.elapsed();
+        variantRows += created.size();
+        qDeleteAll(created);
+        created.clear();
+
+        elapsedTimer.start();
+        QSqlQuery& typedQuery = mStatements.prepared("SELECT * FROM kunde");
+        if (!typedQuery.exec()) {
+            qWarning() << "NO SUCCESS query kunde";
+            return results;
+        }
+        SqlRowDecoder rows(typedQuery);
+        Kunde::bindSqlColumns(rows, schemaVersion);
+        while (rows.next()) {
+            Kunde* kunde = new Kunde();
+            kunde->fillFromSqlRow(rows);
+            created.append(kunde);
+        }
+        typedQuery.finish();
+        typedMs += elapsedTimer.elapsed();
+        typedRows += rows.rows();
+        native = rows.isNative();
+        qDeleteAll(created);
+        created.clear();
+    }
+    results.insert("rounds", qMax(1, rounds));
+    results.insert("rows", variantRows);
+    results.insert("variantMs", variantMs);
+    results.insert("variantRowsPerSecond", variantMs > 0 ? (qint64) variantRows * 1000 / variantMs : 0);
+    results.insert("typedMs", typedMs);
+    results.insert("typedRowsPerSecond", typedMs > 0 ? (qint64) typedRows * 1000 / typedMs : 0);
+    results.insert("native", native);
+    results.insert("verified", variantRows == typedRows);
+    qDebug() << "SQL decoding benchmark Kunde: " << results;
+    return results;
+}
+
+/*
+ * parses json rounds times into new DTOs of type T
+ * once with JsonDataAccess and fillFromCacheMap(),
+ * once with JsonStreamReader and fillFromCacheStream()
+ * heap in use is measured while all DTOs exist: peak RSS never falls
+ * inside one process and cannot compare both ways
+ */
+template<typename T>
+static QVariantMap benchmarkJsonParsingOf(const QByteArray& json, const int& rounds)
+{
+    QElapsedTimer elapsedTimer;
+    QList<T*> created;
+    qint64 mapMs = 0;
+    qint64 streamMs = 0;
+    int mapObjects = 0;
+    int streamObjects = 0;
+    long mapHeapKb = 0;
+    long streamHeapKb = 0;
+    JsonDataAccess jda;
+    for (int round = 0; round < rounds; ++round) {
+        long heapBefore = heapInUseKb();
+        elapsedTimer.start();
+        QVariantList cacheList = jda.loadFromBuffer(json).toList();
+        for (int i = 0; i < cacheList.size(); ++i) {
+            T* dto = new T();
+            dto->fillFromCacheMap(cacheList.at(i).toMap());
+            created.append(dto);
+        }
+        // DTOs and QVariant tree
+        mapHeapKb = qMax(mapHeapKb, heapInUseKb() - heapBefore);
+        cacheList.clear();
+        mapMs += elapsedTimer.elapsed();
+        mapObjects += created.size();
+        qDeleteAll(created);
+        created.clear();
+
+        heapBefore = heapInUseKb();
+        elapsedTimer.start();
+        QBuffer buffer;
+        buffer.setData(json);
+        buffer.open(QIODevice::ReadOnly);
+        JsonStreamReader reader(&buffer);
+        if (reader.readNext() == JsonStreamReader::BeginArray) {
+            while (reader.readNext() == JsonStreamReader::BeginObject) {
+                T* dto = new T();
+                dto->fillFromCacheStream(reader);
+                if (reader.hasError()) {
+                    delete dto;
+                    break;
+                }
+                created.append(dto);
+            }
+        }
+        streamMs += elapsedTimer.elapsed();
+        streamObjects += created.size();
+        streamHeapKb = qMax(streamHeapKb, heapInUseKb() - heapBefore);
+        qDeleteAll(created);
+        created.clear();
+    }
+    QVariantMap results;
+    results.insert("bytes", json.size());
+    results.insert("objects", mapObjects / rounds);
+    results.insert("mapMs", mapMs);
+    results.insert("mapHeapKb", (qint64) mapHeapKb);
+    results.insert("mapObjectsPerSecond", mapMs > 0 ? (qint64) mapObjects * 1000 / mapMs : 0);
+    results.insert("streamMs", streamMs);
+    results.insert("streamHeapKb", (qint64) streamHeapKb);
+    results.insert("streamObjectsPerSecond", streamMs > 0 ? (qint64) streamObjects * 1000 / streamMs : 0);
+    results.insert("verified", mapObjects == streamObjects);
+    return results;
+}
+
+/*
+ * JSON of the current data (same as the JSON caches)
+ * Position is measured as part of Auftrag: positionen counts them
+ */
+QVariantMap DataManager::benchmarkJsonParsing(const int& rounds)
+{
+    JsonDataAccess jda;
+    QByteArray kundeJson;
+    QByteArray auftragJson;
+    QByteArray schlagwortJson;
+    QVariantList cacheList = kundeAsQVariantList();
+    jda.saveToBuffer(cacheList, &kundeJson);
+    cacheList.clear();
+    int positionen = 0;
+    for (int i = 0; i < mAllAuftrag.size(); ++i) {
+        Auftrag* auftrag = (Auftrag*) mAllAuftrag.at(i);
+        positionen += auftrag->positionenCount();
+        cacheList.append(auftrag->toCacheMap());
+    }
+    jda.saveToBuffer(cacheList, &auftragJson);
+    cacheList.clear();
+    for (int i = 0; i < mAllSchlagwort.size(); ++i) {
+        cacheList.append(((Schlagwort*) mAllSchlagwort.at(i))->toCacheMap());
+    }
+    jda.saveToBuffer(cacheList, &schlagwortJson);
+    cacheList.clear();
+
+    QVariantMap results;
+    results.insert("rounds", qMax(1, rounds));
+    results.insert("kunde", benchmarkJsonParsingOf<Kunde>(kundeJson, qMax(1, rounds)));
+    QVariantMap auftragResults = benchmarkJsonParsingOf<Auftrag>(auftragJson, qMax(1, rounds));
+    auftragResults.insert("positionen", positionen);
+    results.insert("auftrag", auftragResults);
+    results.insert("schlagwort", benchmarkJsonParsingOf<Schlagwort>(schlagwortJson, qMax(1, rounds)));
+    qDebug() << "JSON parsing benchmark: " << results;
+    return results;
+}
+
+/*
+ * lookups of size synthetic keys: QHash<int, int> like the primary key index
+ * vs linear scan of a QVector - ns per lookup
+ * the scan does fewer lookups at large sizes, so each size takes about the same time
+ */
+static QVariantMap benchmarkLookupsAtSize(const int& size)
+{
+    QVector<int> nrs;
+    nrs.reserve(size);
+    QHash<int, int> index;
+    index.reserve(size);
+    for (int i = 0; i < size; ++i) {
+        // keys with gaps: not equal to the position
+        nrs.append(i * 7 + 3);
+        index.insert(i * 7 + 3, i);
+    }
+    const int indexLookups = 100000;
+    const int scanLookups = qMax(10, 10000000 / size);
+    QVector<int> keys;
+    keys.reserve(indexLookups);
+    qsrand(42);
+    for (int i = 0; i < indexLookups; ++i) {
+        // RAND_MAX may be 32767: two values for large sizes
+        uint random = (uint(qrand()) << 15) ^ uint(qrand());
+        keys.append(int(random % size) * 7 + 3);
+    }
+    QElapsedTimer elapsedTimer;
+    int indexFound = 0;
+    elapsedTimer.start();
+    for (int i = 0; i < indexLookups; ++i) {
+        if (index.value(keys.at(i), -1) >= 0) {
+            indexFound++;
+        }
+    }
+    qint64 indexNs = elapsedTimer.nsecsElapsed();
+    int scanFound = 0;
+    elapsedTimer.start();
+    for (int i = 0; i < scanLookups; ++i) {
+        int nr = keys.at(i % indexLookups);
+        for (int k = 0; k < nrs.size(); ++k) {
+            if (nrs.at(k) == nr) {
+                scanFound++;
+                break;
+            }
+        }
+    }
+    qint64 scanNs = elapsedTimer.nsecsElapsed();
+    QVariantMap result;
+    result.insert("size", size);
+    result.insert("indexNsPerLookup", indexNs / indexLookups);
+    result.insert("scanNsPerLookup", scanNs / scanLookups);
+    result.insert("verified", indexFound == indexLookups && scanFound == scanLookups);
+    return result;
+}
+
+/*
+ * looks up the references of all Auftrag* without resolving them
+ * once with the index (mKundeByNr, lazy: key index of KundePager / mSchlagwortByUuid),
+ * once by scanning the lists (lazy: the keys)
+ * sizes: the same for synthetic keys from 1k to 500k - lookup by index must stay flat
+ */
+QVariantMap DataManager::benchmarkReferenceResolution(const int& rounds)
+{
+    QList<int> kundeKeys;
+    QList<UuidKey> tagKeys;
+    for (int i = 0; i < mAllAuftrag.size(); ++i) {
+        Auftrag* auftrag = (Auftrag*) mAllAuftrag.at(i);
+        if (auftrag->hasAuftraggeber()) {
+            kundeKeys.append(auftrag->auftraggeber());
+        }
+        tagKeys.append(auftrag->tagsUuidKeys());
+    }
+    // lazy: Kunde* not in memory are found by key like findKundeByNr()
+    QVector<int> lazyKeys;
+    if (mKundePager) {
+        lazyKeys = mKundePager->keys();
+    }
+    QElapsedTimer elapsedTimer;
+    qint64 indexMs = 0;
+    qint64 scanMs = 0;
+    int indexFound = 0;
+    int scanFound = 0;
+    for (int round = 0; round < qMax(1, rounds); ++round) {
+        elapsedTimer.start();
+        for (int i = 0; i < kundeKeys.size(); ++i) {
+            if (mKundePager ? mKundePager->positionOf(kundeKeys.at(i)) >= 0
+                    : mKundeByNr.value(kundeKeys.at(i), 0) != 0) {
+                indexFound++;
+            }
+        }
+        for (int i = 0; i < tagKeys.size(); ++i) {
+            if (mSchlagwortByUuid.value(tagKeys.at(i), 0)) {
+                indexFound++;
+            }
+        }
+        indexMs += elapsedTimer.elapsed();
+
+        elapsedTimer.start();
+        for (int i = 0; i < kundeKeys.size(); ++i) {
+            int nr = kundeKeys.at(i);
+            if (mKundePager) {
+                for (int k = 0; k < lazyKeys.size(); ++k) {
+                    if (lazyKeys.at(k) == nr) {
+                        scanFound++;
+                        break;
+                    }
+                }
+                continue;
+            }
+            for (int k = 0; k < mAllKunde.size(); ++k) {
+                if (((Kunde*) mAllKunde.at(k))->nr() == nr) {
+                    scanFound++;
+                    break;
+                }
+            }
+        }
+        for (int i = 0; i < tagKeys.size(); ++i) {
+            const UuidKey& uuid = tagKeys.at(i);
+            for (int s = 0; s < mAllSchlagwort.size(); ++s) {
+                if (((Schlagwort*) mAllSchlagwort.at(s))->uuidAsKey() == uuid) {
+                    scanFound++;
+                    break;
+                }
+            }
+        }
+        scanMs += elapsedTimer.elapsed();
+    }
+    int lookups = (kundeKeys.size() + tagKeys.size()) * qMax(1, rounds);
+    QVariantMap results;
+    results.insert("rounds", qMax(1, rounds));
+    results.insert("auftrag", mAllAuftrag.size());
+    results.insert("kunde", mKundePager ? mKundePager->count() : mAllKunde.size());
+    results.insert("schlagwort", mAllSchlagwort.size());
+    results.insert("lookups", lookups);
+    results.insert("indexMs", indexMs);
+    results.insert("indexLookupsPerSecond", indexMs > 0 ? (qint64) lookups * 1000 / indexMs : 0);
+    results.insert("scanMs", scanMs);
+    results.insert("scanLookupsPerSecond", scanMs > 0 ? (qint64) lookups * 1000 / scanMs : 0);
+    results.insert("verified", indexFound == scanFound);
+    QVariantList sizes;
+    sizes.append(benchmarkLookupsAtSize(1000));
+    sizes.append(benchmarkLookupsAtSize(10000));
+    sizes.append(benchmarkLookupsAtSize(100000));
+    sizes.append(benchmarkLookupsAtSize(500000));
+    results.insert("sizes", sizes);
+    qDebug() << "reference resolution benchmark: " << results;
+    return results;
 }
 
 void DataManager::onManualExit()
@@ -1524,5 +4926,17 @@ void DataManager::onManualExit()
 
 DataManager::~DataManager()
 {
-    // clean up
+    // the thread is a child: must not be destroyed while running
+    if (mCacheLoaderThread) {
+        mCacheLoaderThread->wait();
+    }
+    if (mSnapshotThread) {
+        mSnapshotWriter->abort();
+        if (mSnapshotThread->wait(mSaveTimeoutMs)) {
+            delete mSnapshotWriter;
+        } else {
+            abandonSnapshotWriter();
+        }
+    }
+    delete mKundePager;
 }
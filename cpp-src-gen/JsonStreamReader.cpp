@@ -0,0 +1,455 @@
+#include "JsonStreamReader.hpp"
+#include <QDebug>
+
+#include <string.h>
+
+// size of the chunks read from device
+static const int chunkSize = 64 * 1024;
+
+static quint32 keyTag(const char* name, const int& size)
+{
+	return (quint32(size) << 8) | (size > 0 ? uchar(name[0]) : 0);
+}
+
+JsonKeyTable::JsonKeyTable(const QStringList& keys)
+{
+	for (int i = 0; i < keys.size(); ++i) {
+		QByteArray key = keys.at(i).toUtf8();
+		mKeys.append(key);
+		mTags.append(keyTag(key.constData(), key.size()));
+	}
+}
+
+int JsonKeyTable::indexOf(const char* name, const int& size) const
+{
+	quint32 tag = keyTag(name, size);
+	for (int i = 0; i < mTags.size(); ++i) {
+		if (mTags.at(i) == tag && memcmp(mKeys.at(i).constData(), name, size) == 0) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+JsonStreamReader::JsonStreamReader(QIODevice* device) :
+		mDevice(device), mPos(0), mAtEnd(false), mTokenType(NoToken), mStringDecoded(true), mNumber(0.0), mBool(
+				false), mExpectName(false), mSeparator(0)
+{
+}
+
+JsonStreamReader::TokenType JsonStreamReader::tokenType() const
+{
+	return mTokenType;
+}
+
+const QString& JsonStreamReader::stringValue() const
+{
+	if (!mStringDecoded) {
+		mString = QString::fromUtf8(mScratch.constData(), mScratch.size());
+		mStringDecoded = true;
+	}
+	return mString;
+}
+
+int JsonStreamReader::nameIndex(const JsonKeyTable& keys) const
+{
+	if (mTokenType != Name) {
+		return -1;
+	}
+	return keys.indexOf(mScratch.constData(), mScratch.size());
+}
+
+double JsonStreamReader::numberValue() const
+{
+	return mNumber;
+}
+
+int JsonStreamReader::intValue() const
+{
+	return int(mNumber);
+}
+
+bool JsonStreamReader::boolValue() const
+{
+	return mBool;
+}
+
+bool JsonStreamReader::hasError() const
+{
+	return mTokenType == Invalid;
+}
+
+QString JsonStreamReader::errorString() const
+{
+	return mError;
+}
+
+/*
+ * reads the next token
+ * ',' and ':' are separators only and never reported,
+ * but must be exactly where JSON expects them
+ */
+JsonStreamReader::TokenType JsonStreamReader::readNext()
+{
+	if (mTokenType == Invalid || mTokenType == EndDocument) {
+		return mTokenType;
+	}
+	int c;
+	for (;;) {
+		c = nextChar();
+		if (c == ' ' || c == '\n' || c == '\r' || c == '\t') {
+			continue;
+		}
+		if (c == ',' || c == ':') {
+			if (c != mSeparator) {
+				return fail(QString("unexpected '").append(QChar(c)).append("'"));
+			}
+			mSeparator = 0;
+			continue;
+		}
+		break;
+	}
+	switch (c) {
+	case -1:
+		if (!mContainers.isEmpty() || mSeparator != '$') {
+			return fail("unexpected end of document");
+		}
+		mTokenType = EndDocument;
+		return mTokenType;
+	case '}':
+	case ']':
+		break;
+	default:
+		if (mSeparator != 0) {
+			return failSeparator();
+		}
+		if (mExpectName && c != '"') {
+			return fail("name expected");
+		}
+		break;
+	}
+	switch (c) {
+	case '{':
+		mContainers.append('{');
+		mExpectName = true;
+		mTokenType = BeginObject;
+		return mTokenType;
+	case '[':
+		mContainers.append('[');
+		mExpectName = false;
+		mTokenType = BeginArray;
+		return mTokenType;
+	case '}':
+		// empty object or after a member - never after ',' or ':'
+		if (mContainers.isEmpty() || mContainers.last() != '{'
+				|| (mSeparator != ',' && mTokenType != BeginObject)) {
+			return fail("unexpected '}'");
+		}
+		mContainers.pop_back();
+		valueCompleted();
+		mTokenType = EndObject;
+		return mTokenType;
+	case ']':
+		if (mContainers.isEmpty() || mContainers.last() != '['
+				|| (mSeparator != ',' && mTokenType != BeginArray)) {
+			return fail("unexpected ']'");
+		}
+		mContainers.pop_back();
+		valueCompleted();
+		mTokenType = EndArray;
+		return mTokenType;
+	case '"':
+		if (!readString()) {
+			return fail("invalid string");
+		}
+		if (mExpectName) {
+			mExpectName = false;
+			mSeparator = ':';
+			mTokenType = Name;
+		} else {
+			valueCompleted();
+			mTokenType = String;
+		}
+		return mTokenType;
+	case 't':
+		if (!readLiteral("rue")) {
+			return fail("invalid literal");
+		}
+		mBool = true;
+		valueCompleted();
+		mTokenType = Bool;
+		return mTokenType;
+	case 'f':
+		if (!readLiteral("alse")) {
+			return fail("invalid literal");
+		}
+		mBool = false;
+		valueCompleted();
+		mTokenType = Bool;
+		return mTokenType;
+	case 'n':
+		if (!readLiteral("ull")) {
+			return fail("invalid literal");
+		}
+		valueCompleted();
+		mTokenType = Null;
+		return mTokenType;
+	default:
+		if (c == '-' || (c >= '0' && c <= '9')) {
+			if (!readNumber(c)) {
+				return fail("invalid number");
+			}
+			valueCompleted();
+			mTokenType = Number;
+			return mTokenType;
+		}
+		return fail(QString("unexpected character: ").append(QChar(c)));
+	}
+}
+
+void JsonStreamReader::skipValue()
+{
+	if (mTokenType != BeginObject && mTokenType != BeginArray) {
+		// simple value - nothing more to read
+		return;
+	}
+	int depth = 1;
+	while (depth > 0) {
+		switch (readNext()) {
+		case BeginObject:
+		case BeginArray:
+			depth++;
+			break;
+		case EndObject:
+		case EndArray:
+			depth--;
+			break;
+		case EndDocument:
+		case Invalid:
+			return;
+		default:
+			break;
+		}
+	}
+}
+
+// inside an object the next String will be a Name again
+void JsonStreamReader::valueCompleted()
+{
+	mExpectName = !mContainers.isEmpty() && mContainers.last() == '{';
+	mSeparator = mContainers.isEmpty() ? '$' : ',';
+}
+
+JsonStreamReader::TokenType JsonStreamReader::failSeparator()
+{
+	switch (mSeparator) {
+	case ',':
+		return fail("missing ','");
+	case ':':
+		return fail("missing ':'");
+	default:
+		return fail("data after the end of document");
+	}
+}
+
+JsonStreamReader::TokenType JsonStreamReader::fail(const QString& error)
+{
+	mError = error;
+	qWarning() << "JsonStreamReader: " << error;
+	mTokenType = Invalid;
+	return mTokenType;
+}
+
+bool JsonStreamReader::fill()
+{
+	if (mAtEnd) {
+		return false;
+	}
+	mBuffer = mDevice->read(chunkSize);
+	mPos = 0;
+	if (mBuffer.isEmpty()) {
+		mAtEnd = true;
+		return false;
+	}
+	return true;
+}
+
+int JsonStreamReader::peekChar()
+{
+	if (mPos >= mBuffer.size() && !fill()) {
+		return -1;
+	}
+	return uchar(mBuffer.at(mPos));
+}
+
+int JsonStreamReader::nextChar()
+{
+	if (mPos >= mBuffer.size() && !fill()) {
+		return -1;
+	}
+	return uchar(mBuffer.at(mPos++));
+}
+
+/*
+ * collects the UTF-8 bytes of the string
+ * escapes are decoded and appended as UTF-8
+ */
+bool JsonStreamReader::readString()
+{
+	mScratch.clear();
+	for (;;) {
+		// fast path: copy unescaped bytes from the buffer
+		int start = mPos;
+		while (mPos < mBuffer.size()) {
+			char c = mBuffer.at(mPos);
+			if (c == '"' || c == '\\') {
+				break;
+			}
+			mPos++;
+		}
+		mScratch.append(mBuffer.constData() + start, mPos - start);
+		int c = nextChar();
+		if (c == -1) {
+			return false;
+		}
+		if (c == '"') {
+			// names matched by nameIndex() are never decoded
+			mString.clear();
+			mStringDecoded = false;
+			return true;
+		}
+		if (c == '\\') {
+			int escaped = nextChar();
+			switch (escaped) {
+			case '"':
+			case '\\':
+			case '/':
+				mScratch.append(char(escaped));
+				break;
+			case 'b':
+				mScratch.append('\b');
+				break;
+			case 'f':
+				mScratch.append('\f');
+				break;
+			case 'n':
+				mScratch.append('\n');
+				break;
+			case 'r':
+				mScratch.append('\r');
+				break;
+			case 't':
+				mScratch.append('\t');
+				break;
+			case 'u': {
+				uint codeUnit;
+				if (!readHex4(codeUnit)) {
+					return false;
+				}
+				if (codeUnit >= 0xd800 && codeUnit < 0xdc00) {
+					// surrogate pair: low surrogate must follow
+					uint lowUnit;
+					if (nextChar() != '\\' || nextChar() != 'u' || !readHex4(lowUnit)
+							|| lowUnit < 0xdc00 || lowUnit > 0xdfff) {
+						return false;
+					}
+					codeUnit = 0x10000 + ((codeUnit - 0xd800) << 10) + (lowUnit - 0xdc00);
+				} else if (codeUnit >= 0xdc00 && codeUnit <= 0xdfff) {
+					// low surrogate without high surrogate
+					return false;
+				}
+				appendUtf8(codeUnit);
+				break;
+			}
+			default:
+				return false;
+			}
+		} else {
+			// buffer was refilled inside nextChar()
+			mScratch.append(char(c));
+		}
+	}
+}
+
+bool JsonStreamReader::readHex4(uint& codeUnit)
+{
+	codeUnit = 0;
+	for (int i = 0; i < 4; ++i) {
+		int c = nextChar();
+		codeUnit <<= 4;
+		if (c >= '0' && c <= '9') {
+			codeUnit |= c - '0';
+		} else if (c >= 'a' && c <= 'f') {
+			codeUnit |= c - 'a' + 10;
+		} else if (c >= 'A' && c <= 'F') {
+			codeUnit |= c - 'A' + 10;
+		} else {
+			return false;
+		}
+	}
+	return true;
+}
+
+void JsonStreamReader::appendUtf8(uint codePoint)
+{
+	if (codePoint < 0x80) {
+		mScratch.append(char(codePoint));
+	} else if (codePoint < 0x800) {
+		mScratch.append(char(0xc0 | (codePoint >> 6)));
+		mScratch.append(char(0x80 | (codePoint & 0x3f)));
+	} else if (codePoint < 0x10000) {
+		mScratch.append(char(0xe0 | (codePoint >> 12)));
+		mScratch.append(char(0x80 | ((codePoint >> 6) & 0x3f)));
+		mScratch.append(char(0x80 | (codePoint & 0x3f)));
+	} else {
+		mScratch.append(char(0xf0 | (codePoint >> 18)));
+		mScratch.append(char(0x80 | ((codePoint >> 12) & 0x3f)));
+		mScratch.append(char(0x80 | ((codePoint >> 6) & 0x3f)));
+		mScratch.append(char(0x80 | (codePoint & 0x3f)));
+	}
+}
+
+bool JsonStreamReader::readNumber(int firstChar)
+{
+	// mScratch is reused: a string not read until now is lost
+	mString.clear();
+	mStringDecoded = true;
+	mScratch.clear();
+	mScratch.append(char(firstChar));
+	bool isInteger = true;
+	for (;;) {
+		int c = peekChar();
+		if ((c >= '0' && c <= '9') || c == '-' || c == '+') {
+			mScratch.append(char(c));
+		} else if (c == '.' || c == 'e' || c == 'E') {
+			isInteger = false;
+			mScratch.append(char(c));
+		} else {
+			break;
+		}
+		mPos++;
+	}
+	bool ok;
+	if (isInteger) {
+		mNumber = mScratch.toLongLong(&ok);
+		if (!ok) {
+			// outside of 64 bit: as double like other JSON parsers
+			mNumber = mScratch.toDouble(&ok);
+		}
+	} else {
+		// QByteArray conversion is locale independent
+		mNumber = mScratch.toDouble(&ok);
+	}
+	return ok;
+}
+
+bool JsonStreamReader::readLiteral(const char* rest)
+{
+	while (*rest) {
+		if (nextChar() != *rest) {
+			return false;
+		}
+		rest++;
+	}
+	return true;
+}
@@ -0,0 +1,243 @@
+#include "JsonStreamWriter.hpp"
+#include <QDebug>
+
+#include <qnumeric.h>
+#include <stdio.h>
+#include <unistd.h>
+
+// buffered output is written in chunks of this size
+static const int chunkSize = 64 * 1024;
+
+static const char hexDigits[] = "0123456789abcdef";
+
+JsonStreamWriter::JsonStreamWriter(const QString& filePath, const CacheCodec::Codec& codec) :
+		mFilePath(filePath), mFile(filePath + ".tmp"), mCodecDevice(&mFile), mCodec(codec), mDevice(
+				0), mAfterName(false), mFailed(false)
+{
+}
+
+JsonStreamWriter::~JsonStreamWriter()
+{
+	// not committed: the old cache stays
+	if (mDevice) {
+		mCodecDevice.close();
+		mFile.close();
+		mFile.remove();
+	}
+}
+
+bool JsonStreamWriter::open()
+{
+	if (!mFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		qWarning() << "cannot open " << mFile.fileName() << ":" << mFile.errorString();
+		mFailed = true;
+		return false;
+	}
+	mDevice = &mFile;
+	if (mCodec != CacheCodec::PlainCodec) {
+		mCodecDevice.setCodec(mCodec);
+		if (!mCodecDevice.open(QIODevice::WriteOnly)) {
+			mFailed = true;
+			return false;
+		}
+		mDevice = &mCodecDevice;
+	}
+	mBuffer.reserve(chunkSize + 1024);
+	return true;
+}
+
+bool JsonStreamWriter::hasError() const
+{
+	return mFailed;
+}
+
+// ',' before all but the first value of a container - nothing after a name
+void JsonStreamWriter::separate()
+{
+	if (mAfterName) {
+		mAfterName = false;
+		return;
+	}
+	if (mFirstValue.isEmpty()) {
+		return;
+	}
+	if (mFirstValue.last()) {
+		mFirstValue.last() = false;
+	} else {
+		mBuffer.append(',');
+	}
+}
+
+void JsonStreamWriter::valueWritten()
+{
+	if (mBuffer.size() >= chunkSize) {
+		flushBuffer();
+	}
+}
+
+void JsonStreamWriter::beginArray()
+{
+	separate();
+	mBuffer.append('[');
+	mFirstValue.append(true);
+}
+
+void JsonStreamWriter::endArray()
+{
+	mFirstValue.pop_back();
+	mBuffer.append(']');
+	valueWritten();
+}
+
+void JsonStreamWriter::beginObject()
+{
+	separate();
+	mBuffer.append('{');
+	mFirstValue.append(true);
+}
+
+void JsonStreamWriter::endObject()
+{
+	mFirstValue.pop_back();
+	mBuffer.append('}');
+	valueWritten();
+}
+
+void JsonStreamWriter::writeName(const QString& name)
+{
+	separate();
+	appendEscaped(name);
+	mBuffer.append(':');
+	mAfterName = true;
+}
+
+void JsonStreamWriter::writeString(const QString& value)
+{
+	separate();
+	appendEscaped(value);
+	valueWritten();
+}
+
+void JsonStreamWriter::writeInt(const int& value)
+{
+	separate();
+	mBuffer.append(QByteArray::number(value));
+	valueWritten();
+}
+
+void JsonStreamWriter::writeDouble(const double& value)
+{
+	separate();
+	if (qIsNaN(value) || qIsInf(value)) {
+		// no JSON number
+		mBuffer.append("null");
+	} else {
+		// 15 digits: same as QVariant double to String
+		mBuffer.append(QByteArray::number(value, 'g', 15));
+	}
+	valueWritten();
+}
+
+void JsonStreamWriter::writeBool(const bool& value)
+{
+	separate();
+	mBuffer.append(value ? "true" : "false");
+	valueWritten();
+}
+
+void JsonStreamWriter::writeNull()
+{
+	separate();
+	mBuffer.append("null");
+	valueWritten();
+}
+
+/*
+ * bytes of multi byte UTF-8 sequences are never '"', '\' or control characters:
+ * only single bytes must be checked
+ */
+void JsonStreamWriter::appendEscaped(const QString& value)
+{
+	QByteArray utf8 = value.toUtf8();
+	mBuffer.append('"');
+	int start = 0;
+	for (int i = 0; i < utf8.size(); ++i) {
+		uchar c = utf8.at(i);
+		if (c >= 0x20 && c != '"' && c != '\\') {
+			continue;
+		}
+		mBuffer.append(utf8.constData() + start, i - start);
+		start = i + 1;
+		mBuffer.append('\\');
+		switch (c) {
+		case '"':
+		case '\\':
+			mBuffer.append(char(c));
+			break;
+		case '\b':
+			mBuffer.append('b');
+			break;
+		case '\f':
+			mBuffer.append('f');
+			break;
+		case '\n':
+			mBuffer.append('n');
+			break;
+		case '\r':
+			mBuffer.append('r');
+			break;
+		case '\t':
+			mBuffer.append('t');
+			break;
+		default:
+			mBuffer.append("u00");
+			mBuffer.append(hexDigits[c >> 4]);
+			mBuffer.append(hexDigits[c & 0xf]);
+			break;
+		}
+	}
+	mBuffer.append(utf8.constData() + start, utf8.size() - start);
+	mBuffer.append('"');
+}
+
+void JsonStreamWriter::flushBuffer()
+{
+	if (mBuffer.isEmpty()) {
+		return;
+	}
+	if (!mFailed && mDevice) {
+		mFailed = mDevice->write(mBuffer) != mBuffer.size();
+	}
+	mBuffer.clear();
+}
+
+bool JsonStreamWriter::commit()
+{
+	if (!mDevice) {
+		return false;
+	}
+	flushBuffer();
+	if (mDevice == &mCodecDevice) {
+		// last block
+		mCodecDevice.close();
+		mFailed = mFailed || mCodecDevice.hasError();
+	}
+	mDevice = 0;
+	if (!mFailed) {
+		mFailed = !mFile.flush() || ::fsync(mFile.handle()) != 0;
+	}
+	mFile.close();
+	if (mFailed) {
+		qWarning() << "cannot write JSON cache " << mFilePath;
+		mFile.remove();
+		return false;
+	}
+	// rename() replaces the old cache atomically
+	if (::rename(QFile::encodeName(mFile.fileName()).constData(),
+			QFile::encodeName(mFilePath).constData()) != 0) {
+		qWarning() << "cannot rename JSON cache to " << mFilePath;
+		mFile.remove();
+		return false;
+	}
+	return true;
+}
@@ -12,10 +12,20 @@ static const QString nrForeignKey = "nr";
 static const QString nameForeignKey = "name";
 static const QString ortForeignKey = "ort";
 // SQL
-static bool queryPosInitialized;
 static int nrQueryPos;
 static int nameQueryPos;
 static int ortQueryPos;
+// few distinct values: shared by all Kunde
+static StringPool ortStrings("Kunde.ort");
+enum KundeColumn {
+	NrColumn, NameColumn, OrtColumn
+};
+static SqlColumnBinding sqlColumns(QStringList() << nrKey << nameKey << ortKey);
+// JSON cache stream
+enum KundeCacheKey {
+	NrCacheKey, NameCacheKey, OrtCacheKey
+};
+static const JsonKeyTable cacheKeys(QStringList() << nrKey << nameKey << ortKey);
 
 /*
  * Default Constructor if Kunde not initialized from QVariantMap
@@ -75,7 +85,7 @@ const QString Kunde::createParameterizedInsertNameBinding()
     insertSQL.append(valueSQL);
     return insertSQL;
 }
-const QString Kunde::createParameterizedInsertPosBinding()
+static QString buildParameterizedInsertPosBinding()
 {
 	QString insertSQL;
     QString valueSQL;
@@ -101,23 +111,75 @@ const QString Kunde::createParameterizedInsertPosBinding()
     insertSQL.append(valueSQL);
     return insertSQL;
 }
+// built once: the same QString is the key of SqlStatementCache
+const QString Kunde::createParameterizedInsertPosBinding()
+{
+	static const QString sql = buildParameterizedInsertPosBinding();
+	return sql;
+}
 /*
  * Exports Properties from Kunde as QVariantLists
  * to insert into SQLite
  * 
  * To cache as JSON use toCacheMap()
  */
+/*
+ * incremental save: changed or inserted rows
+ */
+static QString buildParameterizedInsertOrReplacePosBinding()
+{
+	QString insertSQL = Kunde::createParameterizedInsertPosBinding();
+	insertSQL.replace(0, 11, "INSERT OR REPLACE INTO");
+	return insertSQL;
+}
+const QString Kunde::createParameterizedInsertOrReplacePosBinding()
+{
+	static const QString sql = buildParameterizedInsertOrReplacePosBinding();
+	return sql;
+}
+/*
+ * incremental save: changed or inserted rows
+ * UPSERT updates the row in place (SQLite 3.24+)
+ */
+static QString buildParameterizedUpsertPosBinding()
+{
+	QString upsertSQL = Kunde::createParameterizedInsertPosBinding();
+	upsertSQL.append("ON CONFLICT(").append(nrKey).append(") DO UPDATE SET ");
+	upsertSQL.append(nameKey).append(" = excluded.").append(nameKey).append(", ");
+	upsertSQL.append(ortKey).append(" = excluded.").append(ortKey);
+	return upsertSQL;
+}
+const QString Kunde::createParameterizedUpsertPosBinding()
+{
+	static const QString sql = buildParameterizedUpsertPosBinding();
+	return sql;
+}
+/*
+ * incremental save: deleted rows
+ * DELETE ... WHERE nr IN (?, ?, ...) with keyCount parameters
+ */
+const QString Kunde::createParameterizedDeleteByKeys(const int& keyCount)
+{
+	QString deleteSQL = "DELETE FROM kunde WHERE ";
+	deleteSQL.append(nrKey).append(" IN (");
+	for (int i = 0; i < keyCount; ++i) {
+		deleteSQL.append(i == 0 ? "?" : ", ?");
+	}
+	deleteSQL.append(")");
+	return deleteSQL;
+}
 void Kunde::toSqlCache(QVariantList& nrList, QVariantList& nameList, QVariantList& ortList)
 {
 	nrList << mNr;
 	nameList << mName;
 	ortList << mOrt;
 }
+/*
+ * positions for fillFromSqlQuery() - looked up for each query
+ * typed reading with cached positions: bindSqlColumns()
+ */
 void Kunde::fillSqlQueryPos(const QSqlRecord& record)
 {
-    if(queryPosInitialized) {
-        return;
-    }
 nrQueryPos = record.indexOf(nrKey);
 nameQueryPos = record.indexOf(nameKey);
 ortQueryPos = record.indexOf(ortKey);
@@ -130,9 +192,100 @@ void Kunde::fillFromSqlQuery(const QSqlQuery& sqlQuery)
 {
 	mNr = sqlQuery.value(nrQueryPos).toInt();
 	mName = sqlQuery.value(nameQueryPos).toString();
-	mOrt = sqlQuery.value(ortQueryPos).toString();
+	mOrt = ortStrings.intern(sqlQuery.value(ortQueryPos).toString());
+}
+void Kunde::bindSqlColumns(SqlRowDecoder& decoder, const int& schemaVersion)
+{
+	decoder.bind(sqlColumns, schemaVersion);
+}
+/*
+ * initialize Kunde from the current row of SqlRowDecoder
+ * bindSqlColumns() must be called before
+ */
+void Kunde::fillFromSqlRow(const SqlRowDecoder& decoder)
+{
+	mNr = decoder.intValue(NrColumn);
+	mName = decoder.stringValue(NameColumn);
+	mOrt = ortStrings.intern(decoder.stringValue(OrtColumn));
 }
 
+/*
+ * Exports Properties from Kunde into binary snapshot
+ * fixed order - corresponding import: fillFromBinaryCache()
+ */
+void Kunde::toBinaryCache(BinaryCacheWriter& writer)
+{
+	writer.writeInt(mNr);
+	writer.writeString(mName);
+	writer.writeString(mOrt);
+}
+/*
+ * value copy for background save (SnapshotWriter)
+ */
+KundeRecord Kunde::toRecord() const
+{
+	KundeRecord record;
+	record.nr = mNr;
+	record.name = mName;
+	record.ort = mOrt;
+	return record;
+}
+void Kunde::fillFromRecord(const KundeRecord& record)
+{
+	mNr = record.nr;
+	mName = record.name;
+	mOrt = ortStrings.intern(record.ort);
+}
+/*
+ * record storage: values without a Kunde*
+ * same columns and keys as fillFromSqlRow() and fillFromCacheMap()
+ */
+KundeRecord Kunde::recordFromSqlRow(const SqlRowDecoder& decoder)
+{
+	KundeRecord record;
+	record.nr = decoder.intValue(NrColumn);
+	record.name = decoder.stringValue(NameColumn);
+	record.ort = ortStrings.intern(decoder.stringValue(OrtColumn));
+	return record;
+}
+KundeRecord Kunde::recordFromCacheMap(const QVariantMap& kundeMap)
+{
+	KundeRecord record;
+	record.nr = kundeMap.value(nrKey).toInt();
+	record.name = kundeMap.value(nameKey).toString();
+	record.ort = ortStrings.intern(kundeMap.value(ortKey).toString());
+	return record;
+}
+QVariantMap Kunde::cacheMapFromRecord(const KundeRecord& record)
+{
+	QVariantMap kundeMap;
+	kundeMap.insert(nrKey, record.nr);
+	kundeMap.insert(nameKey, record.name);
+	kundeMap.insert(ortKey, record.ort);
+	return kundeMap;
+}
+// record storage: same JSON as toCacheStream()
+void Kunde::recordToCacheStream(const KundeRecord& record, JsonStreamWriter& writer)
+{
+	writer.beginObject();
+	writer.writeName(nrKey);
+	writer.writeInt(record.nr);
+	writer.writeName(nameKey);
+	writer.writeString(record.name);
+	writer.writeName(ortKey);
+	writer.writeString(record.ort);
+	writer.endObject();
+}
+/*
+ * initialize Kunde from binary snapshot
+ * corresponding export method: toBinaryCache()
+ */
+void Kunde::fillFromBinaryCache(BinaryCacheReader& reader)
+{
+	mNr = reader.readInt();
+	mName = reader.readString();
+	mOrt = ortStrings.intern(reader.readString());
+}
 
 /*
  * initialize Kunde from QVariantMap
@@ -145,7 +298,7 @@ void Kunde::fillFromMap(const QVariantMap& kundeMap)
 {
 	mNr = kundeMap.value(nrKey).toInt();
 	mName = kundeMap.value(nameKey).toString();
-	mOrt = kundeMap.value(ortKey).toString();
+	mOrt = ortStrings.intern(kundeMap.value(ortKey).toString());
 }
 /*
  * initialize OrderData from QVariantMap
@@ -158,7 +311,7 @@ void Kunde::fillFromForeignMap(const QVariantMap& kundeMap)
 {
 	mNr = kundeMap.value(nrForeignKey).toInt();
 	mName = kundeMap.value(nameForeignKey).toString();
-	mOrt = kundeMap.value(ortForeignKey).toString();
+	mOrt = ortStrings.intern(kundeMap.value(ortForeignKey).toString());
 }
 /*
  * initialize OrderData from QVariantMap
@@ -171,7 +324,33 @@ void Kunde::fillFromCacheMap(const QVariantMap& kundeMap)
 {
 	mNr = kundeMap.value(nrKey).toInt();
 	mName = kundeMap.value(nameKey).toString();
-	mOrt = kundeMap.value(ortKey).toString();
+	mOrt = ortStrings.intern(kundeMap.value(ortKey).toString());
+}
+/*
+ * initialize Kunde directly from JSON tokens
+ * reader must be positioned at BeginObject
+ * same properties as fillFromCacheMap() without QVariantMap
+ */
+void Kunde::fillFromCacheStream(JsonStreamReader& reader)
+{
+	while (reader.readNext() == JsonStreamReader::Name) {
+		int key = reader.nameIndex(cacheKeys);
+		reader.readNext();
+		switch (key) {
+		case NrCacheKey:
+			mNr = reader.intValue();
+			break;
+		case NameCacheKey:
+			mName = reader.stringValue();
+			break;
+		case OrtCacheKey:
+			mOrt = ortStrings.intern(reader.stringValue());
+			break;
+		default:
+			reader.skipValue();
+			break;
+		}
+	}
 }
 
 void Kunde::prepareNew()
@@ -229,6 +408,23 @@ QVariantMap Kunde::toCacheMap()
 	// use default toMao()
 	return toMap();
 }
+
+/*
+ * writes Kunde directly as JSON tokens
+ * same properties as toCacheMap() without QVariantMap
+ * corresponding import: fillFromCacheStream()
+ */
+void Kunde::toCacheStream(JsonStreamWriter& writer)
+{
+	writer.beginObject();
+	writer.writeName(nrKey);
+	writer.writeInt(mNr);
+	writer.writeName(nameKey);
+	writer.writeString(mName);
+	writer.writeName(ortKey);
+	writer.writeString(mOrt);
+	writer.endObject();
+}
 // ATT 
 // Mandatory: nr
 // Domain KEY: nr
@@ -265,14 +461,29 @@ QString Kunde::ort() const
 	return mOrt;
 }
 
+StringPool& Kunde::ortPool()
+{
+	return ortStrings;
+}
+
 void Kunde::setOrt(QString ort)
 {
 	if (ort != mOrt) {
-		mOrt = ort;
+		mOrt = ortStrings.intern(ort);
 		emit ortChanged(ort);
 	}
 }
 
+/*
+ * DataManager is connected once to each signal while the Kunde* is indexed
+ * more receivers: QML bindings or others still use this Kunde*
+ */
+bool Kunde::isObserved() const
+{
+	return receivers(SIGNAL(nrChanged(int))) > 1 || receivers(SIGNAL(nameChanged(QString))) > 1
+			|| receivers(SIGNAL(ortChanged(QString))) > 1;
+}
+
 
 Kunde::~Kunde()
 {
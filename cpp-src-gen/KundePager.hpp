@@ -0,0 +1,84 @@
+#ifndef KUNDEPAGER_HPP_
+#define KUNDEPAGER_HPP_
+
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QVector>
+#include <QtSql/QSqlDatabase>
+
+#include "SqlStatementCache.hpp"
+#include "CacheRecords.hpp"
+
+class Kunde;
+
+/*
+ * lazy Kunde (DataManager::setLazyKunde()):
+ * only the sorted keys (nr) of table kunde are in memory
+ * Kunde* are read from SQLite page by page if needed
+ *
+ * a page are pageSize keys of the index
+ * read by key range: nr BETWEEN first and last key of the page
+ * (keyset pagination on INTEGER PRIMARY KEY - no OFFSET scan)
+ *
+ * keys of inserted or deleted Kunde are maintained by DataManager:
+ * the index may differ from the table until the delta is saved
+ *
+ * record storage (DataManager::setKundeRecordStorage()):
+ * all Kunde as KundeRecord in one array, in the order of the keys
+ * pages are created from the records instead of SQLite
+ * evicted Kunde* are written back with storeRecord()
+ *
+ * LRU: last use per materialized Kunde
+ * DataManager evicts the least recently used ones above the budget
+ */
+class KundePager
+{
+public:
+	KundePager(SqlStatementCache& statements, const QSqlDatabase& database);
+
+	// reads the keys - false if table kunde doesn't exist
+	bool open();
+	// record storage - records are sorted by nr
+	void openRecords(QVector<KundeRecord>& records);
+	bool hasRecords() const;
+	void storeRecord(const KundeRecord& record);
+	QList<KundeRecord> records() const;
+	int count() const;
+	int keyAt(const int& pos) const;
+	// -1 if not found
+	int positionOf(const int& nr) const;
+	bool containsKey(const int& nr) const;
+	void insertKey(const int& nr);
+	bool removeKey(const int& nr);
+	QVector<int> keys() const;
+	void clearKeys();
+
+	// Kunde* without parent - rows of keys not in the index are skipped
+	QList<Kunde*> loadPage(const int& page);
+
+	void touch(const int& nr);
+	void forget(const int& nr);
+	// least recently used first, pinned keys are skipped
+	QList<int> leastRecentlyUsed(const int& count, const QSet<int>& pinned) const;
+
+	int pagesLoaded() const;
+
+	static const int pageSize;
+
+private:
+	SqlStatementCache& mStatements;
+	QSqlDatabase mDatabase;
+	int mSchemaVersion;
+	QVector<int> mKeys;
+	bool mRecordStorage;
+	// record storage: same positions as mKeys
+	QVector<KundeRecord> mRecords;
+	QHash<int, quint32> mLastUse;
+	quint32 mTick;
+	int mPagesLoaded;
+
+	Q_DISABLE_COPY (KundePager)
+};
+
+#endif /* KUNDEPAGER_HPP_ */
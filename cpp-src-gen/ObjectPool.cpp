@@ -0,0 +1,90 @@
+#include "ObjectPool.hpp"
+#include <QDebug>
+
+#include <QMutexLocker>
+#include <stdlib.h>
+
+// alignment of malloc() for double and pointers
+static const size_t objectAlignment = 8;
+
+ObjectPool::ObjectPool(const QString& name, const size_t& objectSize, const int& objectsPerSlab) :
+		mName(name), mObjectSize(
+				(qMax(objectSize, sizeof(FreeObject)) + objectAlignment - 1) & ~(objectAlignment - 1)), mObjectsPerSlab(
+				qMax(1, objectsPerSlab)), mFreeList(0), mInUse(0), mPeakInUse(0), mAllocations(0)
+{
+}
+
+ObjectPool::~ObjectPool()
+{
+	// static pool: objects still alive at exit keep their memory
+	if (!trim()) {
+		qDebug() << "ObjectPool " << mName << " in use at exit #" << mInUse;
+	}
+}
+
+void ObjectPool::addSlab()
+{
+	char* slab = static_cast<char*>(::malloc(mObjectSize * mObjectsPerSlab));
+	Q_CHECK_PTR(slab);
+	mSlabs.append(slab);
+	// first object of the slab at the head of the free list
+	for (int i = mObjectsPerSlab - 1; i >= 0; --i) {
+		FreeObject* object = reinterpret_cast<FreeObject*>(slab + i * mObjectSize);
+		object->next = mFreeList;
+		mFreeList = object;
+	}
+}
+
+void* ObjectPool::allocate()
+{
+	QMutexLocker locker(&mMutex);
+	if (!mFreeList) {
+		addSlab();
+	}
+	FreeObject* object = mFreeList;
+	mFreeList = object->next;
+	mInUse++;
+	mPeakInUse = qMax(mPeakInUse, mInUse);
+	mAllocations++;
+	return object;
+}
+
+void ObjectPool::release(void* object)
+{
+	if (!object) {
+		return;
+	}
+	QMutexLocker locker(&mMutex);
+	FreeObject* freeObject = static_cast<FreeObject*>(object);
+	freeObject->next = mFreeList;
+	mFreeList = freeObject;
+	mInUse--;
+}
+
+bool ObjectPool::trim()
+{
+	QMutexLocker locker(&mMutex);
+	if (mInUse > 0) {
+		return false;
+	}
+	for (int i = 0; i < mSlabs.size(); ++i) {
+		::free(mSlabs.at(i));
+	}
+	mSlabs.clear();
+	mFreeList = 0;
+	return true;
+}
+
+QVariantMap ObjectPool::stats()
+{
+	QMutexLocker locker(&mMutex);
+	QVariantMap statsMap;
+	statsMap.insert("name", mName);
+	statsMap.insert("objectSize", (int) mObjectSize);
+	statsMap.insert("inUse", mInUse);
+	statsMap.insert("peakInUse", mPeakInUse);
+	statsMap.insert("allocations", mAllocations);
+	statsMap.insert("slabs", mSlabs.size());
+	statsMap.insert("reservedKb", (qint64) mSlabs.size() * mObjectsPerSlab * mObjectSize / 1024);
+	return statsMap;
+}
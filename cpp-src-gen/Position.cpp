@@ -1,6 +1,5 @@
 #include "Position.hpp"
 #include <QDebug>
-#include <quuid.h>
 #include "Auftrag.hpp"
 
 // keys of QVariantMap used in this APP
@@ -14,15 +13,179 @@ static const QString uuidForeignKey = "uuid";
 static const QString bezeichnungForeignKey = "bezeichnung";
 static const QString preisForeignKey = "preis";
 // no key for auftragsKopf
+// SQL
+static const QString auftragNrColumn = "auftrag_nr";
+static const QString posIndexColumn = "pos_index";
+static int uuidQueryPos;
+static int auftragNrQueryPos;
+static int bezeichnungQueryPos;
+static int preisQueryPos;
+// product names repeat in most Auftrag
+static StringPool bezeichnungStrings("Position.bezeichnung");
+enum PositionColumn {
+	UuidColumn, AuftragNrColumn, BezeichnungColumn, PreisColumn
+};
+static SqlColumnBinding sqlColumns(
+		QStringList() << uuidKey << auftragNrColumn << bezeichnungKey << preisKey);
+
+// JSON cache stream
+enum PositionCacheKey {
+	UuidCacheKey, BezeichnungCacheKey, PreisCacheKey
+};
+static const JsonKeyTable cacheKeys(QStringList() << uuidKey << bezeichnungKey << preisKey);
+
+static ObjectPool positionMemory("Position", sizeof(Position), 512);
+
+/*
+ * no uuid: a new one is created
+ * not a UUID: rejected and logged - the Position keeps no uuid
+ */
+static UuidKey uuidFromText(const QString& uuidString)
+{
+	if (uuidString.isEmpty()) {
+		return UuidKey::createUuid();
+	}
+	return UuidKey::fromString(uuidString, "Position");
+}
 
 /*
  * Default Constructor if Position not initialized from QVariantMap
  */
 Position::Position(QObject *parent) :
-        QObject(parent), mUuid(""), mBezeichnung(""), mPreis(0.0)
+        QObject(parent), mUuid(), mBezeichnung(""), mPreis(0.0)
 {
 }
 
+// S Q L
+/*
+ * uuid is stored as BLOB (16 Bytes, RFC 4122) - NULL if the Position has no uuid
+ * Positionen are keyed by Auftrag and index: uuid is not unique for sure
+ */
+const QString Position::createTableCommand()
+{
+	QString createSQL = "CREATE TABLE position (";
+	// uuid
+	createSQL.append(uuidKey).append(" BLOB");
+	createSQL.append(", ");
+	// auftragsKopf
+	createSQL.append(auftragNrColumn).append(" INTEGER");
+	createSQL.append(", ");
+	createSQL.append(posIndexColumn).append(" INTEGER");
+	createSQL.append(", ");
+	// bezeichnung
+	createSQL.append(bezeichnungKey).append(" TEXT");
+	createSQL.append(", ");
+	// preis
+	createSQL.append(preisKey).append(" REAL");
+	createSQL.append(", ");
+	// Positionen are read ordered by Auftrag and index
+	createSQL.append("PRIMARY KEY (").append(auftragNrColumn).append(", ").append(posIndexColumn).append(")");
+	createSQL.append(", ");
+	//
+    createSQL = createSQL.left(createSQL.length()-2);
+    createSQL.append(");");
+    return createSQL;
+}
+/*
+ * caches written before the position table was keyed by Auftrag and index
+ * are replaced completely
+ */
+bool Position::isOutdatedTableCommand(const QString& tableSQL)
+{
+	return !tableSQL.contains("PRIMARY KEY (" + auftragNrColumn);
+}
+static QString buildParameterizedInsertPosBinding()
+{
+	QString insertSQL;
+    QString valueSQL;
+    insertSQL = "INSERT INTO position (";
+    valueSQL = " VALUES (";
+// uuid 
+	insertSQL.append(uuidKey);
+	insertSQL.append(", ");
+	valueSQL.append("?, ");
+// auftragsKopf 
+	insertSQL.append(auftragNrColumn);
+	insertSQL.append(", ");
+	valueSQL.append("?, ");
+	insertSQL.append(posIndexColumn);
+	insertSQL.append(", ");
+	valueSQL.append("?, ");
+// bezeichnung 
+	insertSQL.append(bezeichnungKey);
+	insertSQL.append(", ");
+	valueSQL.append("?, ");
+// preis 
+	insertSQL.append(preisKey);
+	insertSQL.append(", ");
+	valueSQL.append("?, ");
+//
+    insertSQL = insertSQL.left(insertSQL.length()-2);
+    insertSQL.append(") ");
+    valueSQL = valueSQL.left(valueSQL.length()-2);
+    valueSQL.append(") ");
+    insertSQL.append(valueSQL);
+    return insertSQL;
+}
+const QString Position::createParameterizedInsertPosBinding()
+{
+	static const QString sql = buildParameterizedInsertPosBinding();
+	return sql;
+}
+// DELETE ... WHERE auftrag_nr IN (?, ?, ...) with keyCount parameters
+const QString Position::createParameterizedDeleteByAuftragNrs(const int& keyCount)
+{
+	QString deleteSQL = "DELETE FROM position WHERE ";
+	deleteSQL.append(auftragNrColumn).append(" IN (");
+	for (int i = 0; i < keyCount; ++i) {
+		deleteSQL.append(i == 0 ? "?" : ", ?");
+	}
+	deleteSQL.append(")");
+	return deleteSQL;
+}
+void Position::toSqlCache(const PositionRecord& record, const int& auftragNr, const int& posIndex,
+		QVariantList& uuidList, QVariantList& auftragNrList, QVariantList& posIndexList,
+		QVariantList& bezeichnungList, QVariantList& preisList)
+{
+	if (record.uuid.isNull()) {
+		uuidList << QVariant(QVariant::ByteArray);
+	} else {
+		uuidList << record.uuid.toRfc4122();
+	}
+	auftragNrList << auftragNr;
+	posIndexList << posIndex;
+	bezeichnungList << record.bezeichnung;
+	preisList << record.preis;
+}
+void Position::fillSqlQueryPos(const QSqlRecord& record)
+{
+uuidQueryPos = record.indexOf(uuidKey);
+auftragNrQueryPos = record.indexOf(auftragNrColumn);
+bezeichnungQueryPos = record.indexOf(bezeichnungKey);
+preisQueryPos = record.indexOf(preisKey);
+}
+void Position::fillFromSqlQuery(const QSqlQuery& sqlQuery)
+{
+	// NULL: saved without uuid - stays null
+	mUuid = UuidKey::fromRfc4122(sqlQuery.value(uuidQueryPos).toByteArray());
+	mBezeichnung = bezeichnungStrings.intern(sqlQuery.value(bezeichnungQueryPos).toString());
+	mPreis = sqlQuery.value(preisQueryPos).toDouble();
+}
+void Position::bindSqlColumns(SqlRowDecoder& decoder, const int& schemaVersion)
+{
+	decoder.bind(sqlColumns, schemaVersion);
+}
+int Position::auftragNrSqlColumn()
+{
+	return AuftragNrColumn;
+}
+void Position::fillFromSqlRow(const SqlRowDecoder& decoder)
+{
+	mUuid = UuidKey::fromRfc4122(decoder.blobValue(UuidColumn));
+	mBezeichnung = bezeichnungStrings.intern(decoder.stringValue(BezeichnungColumn));
+	mPreis = decoder.doubleValue(PreisColumn);
+}
+
 /*
  * initialize Position from QVariantMap
  * Map got from JsonDataAccess or so
@@ -32,13 +195,8 @@ Position::Position(QObject *parent) :
  */
 void Position::fillFromMap(const QVariantMap& positionMap)
 {
-	mUuid = positionMap.value(uuidKey).toString();
-	if (mUuid.isEmpty()) {
-		mUuid = QUuid::createUuid().toString();
-		mUuid = mUuid.right(mUuid.length() - 1);
-		mUuid = mUuid.left(mUuid.length() - 1);
-	}	
-	mBezeichnung = positionMap.value(bezeichnungKey).toString();
+	mUuid = uuidFromText(positionMap.value(uuidKey).toString());
+	mBezeichnung = bezeichnungStrings.intern(positionMap.value(bezeichnungKey).toString());
 	mPreis = positionMap.value(preisKey).toDouble();
 	// mAuftragsKopf is parent (Auftrag* containing Position)
 }
@@ -51,13 +209,8 @@ void Position::fillFromMap(const QVariantMap& positionMap)
  */
 void Position::fillFromForeignMap(const QVariantMap& positionMap)
 {
-	mUuid = positionMap.value(uuidForeignKey).toString();
-	if (mUuid.isEmpty()) {
-		mUuid = QUuid::createUuid().toString();
-		mUuid = mUuid.right(mUuid.length() - 1);
-		mUuid = mUuid.left(mUuid.length() - 1);
-	}	
-	mBezeichnung = positionMap.value(bezeichnungForeignKey).toString();
+	mUuid = uuidFromText(positionMap.value(uuidForeignKey).toString());
+	mBezeichnung = bezeichnungStrings.intern(positionMap.value(bezeichnungForeignKey).toString());
 	mPreis = positionMap.value(preisForeignKey).toDouble();
 	// mAuftragsKopf is parent (Auftrag* containing Position)
 }
@@ -70,22 +223,86 @@ void Position::fillFromForeignMap(const QVariantMap& positionMap)
  */
 void Position::fillFromCacheMap(const QVariantMap& positionMap)
 {
-	mUuid = positionMap.value(uuidKey).toString();
-	if (mUuid.isEmpty()) {
-		mUuid = QUuid::createUuid().toString();
-		mUuid = mUuid.right(mUuid.length() - 1);
-		mUuid = mUuid.left(mUuid.length() - 1);
-	}	
-	mBezeichnung = positionMap.value(bezeichnungKey).toString();
+	mUuid = uuidFromText(positionMap.value(uuidKey).toString());
+	mBezeichnung = bezeichnungStrings.intern(positionMap.value(bezeichnungKey).toString());
 	mPreis = positionMap.value(preisKey).toDouble();
 	// mAuftragsKopf is parent (Auftrag* containing Position)
 }
+/*
+ * initialize Position directly from JSON tokens
+ * reader must be positioned at BeginObject
+ * same properties as fillFromCacheMap() without QVariantMap
+ */
+void Position::fillFromCacheStream(JsonStreamReader& reader)
+{
+	bool hasUuid = false;
+	while (reader.readNext() == JsonStreamReader::Name) {
+		int key = reader.nameIndex(cacheKeys);
+		reader.readNext();
+		switch (key) {
+		case UuidCacheKey:
+			mUuid = uuidFromText(reader.stringValue());
+			hasUuid = true;
+			break;
+		case BezeichnungCacheKey:
+			mBezeichnung = bezeichnungStrings.intern(reader.stringValue());
+			break;
+		case PreisCacheKey:
+			mPreis = reader.numberValue();
+			break;
+		default:
+			reader.skipValue();
+			break;
+		}
+	}
+	if (!hasUuid) {
+		mUuid = UuidKey::createUuid();
+	}
+	// mAuftragsKopf is parent (Auftrag* containing Position)
+}
+/*
+ * Exports Properties from Position into binary snapshot
+ * fixed order - corresponding import: fillFromBinaryCache()
+ */
+void Position::toBinaryCache(BinaryCacheWriter& writer)
+{
+	writer.writeUuid(mUuid);
+	writer.writeString(mBezeichnung);
+	writer.writeDouble(mPreis);
+}
+/*
+ * value copy for background save (SnapshotWriter)
+ */
+PositionRecord Position::toRecord() const
+{
+	PositionRecord record;
+	record.uuid = mUuid;
+	record.bezeichnung = mBezeichnung;
+	record.preis = mPreis;
+	return record;
+}
+// setters: QML bound to this Position gets the changes
+void Position::fillFromRecord(const PositionRecord& record)
+{
+	setUuidAsKey(record.uuid);
+	setBezeichnung(record.bezeichnung);
+	setPreis(record.preis);
+}
+/*
+ * initialize Position from binary snapshot
+ * corresponding export method: toBinaryCache()
+ */
+void Position::fillFromBinaryCache(BinaryCacheReader& reader)
+{
+	mUuid = reader.readUuid();
+	mBezeichnung = bezeichnungStrings.intern(reader.readString());
+	mPreis = reader.readDouble();
+	// mAuftragsKopf is parent (Auftrag* containing Position)
+}
 
 void Position::prepareNew()
 {
-	mUuid = QUuid::createUuid().toString();
-	mUuid = mUuid.right(mUuid.length() - 1);
-	mUuid = mUuid.left(mUuid.length() - 1);
+	mUuid = UuidKey::createUuid();
 }
 
 /*
@@ -93,7 +310,7 @@ void Position::prepareNew()
  */
 bool Position::isValid()
 {
-	if (mUuid.isNull() || mUuid.isEmpty()) {
+	if (mUuid.isNull()) {
 		return false;
 	}
 	return true;
@@ -107,7 +324,7 @@ bool Position::isValid()
 QVariantMap Position::toMap()
 {
 	QVariantMap positionMap;
-	positionMap.insert(uuidKey, mUuid);
+	positionMap.insert(uuidKey, mUuid.toString());
 	positionMap.insert(bezeichnungKey, mBezeichnung);
 	positionMap.insert(preisKey, mPreis);
 	// mAuftragsKopf points to Auftrag* containing Position
@@ -122,7 +339,7 @@ QVariantMap Position::toMap()
 QVariantMap Position::toForeignMap()
 {
 	QVariantMap positionMap;
-	positionMap.insert(uuidForeignKey, mUuid);
+	positionMap.insert(uuidForeignKey, mUuid.toString());
 	positionMap.insert(bezeichnungForeignKey, mBezeichnung);
 	positionMap.insert(preisForeignKey, mPreis);
 	// mAuftragsKopf points to Auftrag* containing Position
@@ -141,19 +358,52 @@ QVariantMap Position::toCacheMap()
 	// use default toMao()
 	return toMap();
 }
+
+/*
+ * writes Position directly as JSON tokens
+ * same properties as toCacheMap() without QVariantMap
+ * corresponding import: fillFromCacheStream()
+ */
+void Position::toCacheStream(JsonStreamWriter& writer)
+{
+	writer.beginObject();
+	writer.writeName(uuidKey);
+	writer.writeString(mUuid.toString());
+	writer.writeName(bezeichnungKey);
+	writer.writeString(mBezeichnung);
+	writer.writeName(preisKey);
+	writer.writeDouble(mPreis);
+	// mAuftragsKopf is parent (Auftrag* containing Position)
+	writer.endObject();
+}
 // ATT 
 // Mandatory: uuid
 // Domain KEY: uuid
 QString Position::uuid() const
 {
-	return mUuid;
+	return mUuid.toString();
 }
 
 void Position::setUuid(QString uuid)
+{
+	UuidKey key = UuidKey::fromString(uuid, "Position::setUuid");
+	if (key.isNull() && !uuid.isEmpty()) {
+		// rejected: uuid stays unchanged
+		return;
+	}
+	setUuidAsKey(key);
+}
+UuidKey Position::uuidAsKey() const
+{
+	return mUuid;
+}
+
+void Position::setUuidAsKey(const UuidKey& uuid)
 {
 	if (uuid != mUuid) {
 		mUuid = uuid;
-		emit uuidChanged(uuid);
+		emit uuidChanged(mUuid.toString());
+		notifyAuftragsKopf();
 	}
 }
 // ATT 
@@ -163,11 +413,17 @@ QString Position::bezeichnung() const
 	return mBezeichnung;
 }
 
+StringPool& Position::bezeichnungPool()
+{
+	return bezeichnungStrings;
+}
+
 void Position::setBezeichnung(QString bezeichnung)
 {
 	if (bezeichnung != mBezeichnung) {
-		mBezeichnung = bezeichnung;
+		mBezeichnung = bezeichnungStrings.intern(bezeichnung);
 		emit bezeichnungChanged(bezeichnung);
+		notifyAuftragsKopf();
 	}
 }
 // ATT 
@@ -182,6 +438,7 @@ void Position::setPreis(double preis)
 	if (preis != mPreis) {
 		mPreis = preis;
 		emit preisChanged(preis);
+		notifyAuftragsKopf();
 	}
 }
 // REF
@@ -192,10 +449,41 @@ Auftrag* Position::auftragsKopf() const
 {
 	return qobject_cast<Auftrag*>(parent());
 }
+// changes of a Position are changes of the Auftrag (cascade)
+void Position::notifyAuftragsKopf()
+{
+	Auftrag* auftrag = auftragsKopf();
+	if (auftrag) {
+		auftrag->positionChanged(this);
+	}
+}
 
 
 Position::~Position()
 {
 	// place cleanUp code here
 }
+
+void* Position::operator new(size_t size)
+{
+	// a derived class doesn't fit into the pool
+	if (size != sizeof(Position)) {
+		return ::operator new(size);
+	}
+	return positionMemory.allocate();
+}
+
+void Position::operator delete(void* object, size_t size)
+{
+	if (size != sizeof(Position)) {
+		::operator delete(object);
+		return;
+	}
+	positionMemory.release(object);
+}
+
+ObjectPool& Position::allocationPool()
+{
+	return positionMemory;
+}
 	
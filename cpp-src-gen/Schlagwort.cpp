@@ -1,6 +1,5 @@
 #include "Schlagwort.hpp"
 #include <QDebug>
-#include <quuid.h>
 
 // keys of QVariantMap used in this APP
 static const QString uuidKey = "uuid";
@@ -9,12 +8,27 @@ static const QString textKey = "text";
 // keys used from Server API etc
 static const QString uuidForeignKey = "uuid";
 static const QString textForeignKey = "text";
+static StringPool textStrings("Schlagwort.text");
+// JSON cache stream
+enum SchlagwortCacheKey {
+	UuidCacheKey, TextCacheKey
+};
+static const JsonKeyTable cacheKeys(QStringList() << uuidKey << textKey);
+
+// empty: new uuid - invalid: logged, tags can't point to this Schlagwort
+static UuidKey uuidFromText(const QString& uuidString)
+{
+	if (uuidString.isEmpty()) {
+		return UuidKey::createUuid();
+	}
+	return UuidKey::fromString(uuidString, "Schlagwort");
+}
 
 /*
  * Default Constructor if Schlagwort not initialized from QVariantMap
  */
 Schlagwort::Schlagwort(QObject *parent) :
-        QObject(parent), mUuid(""), mText("")
+        QObject(parent), mUuid(), mText("")
 {
 }
 
@@ -27,13 +41,8 @@ Schlagwort::Schlagwort(QObject *parent) :
  */
 void Schlagwort::fillFromMap(const QVariantMap& schlagwortMap)
 {
-	mUuid = schlagwortMap.value(uuidKey).toString();
-	if (mUuid.isEmpty()) {
-		mUuid = QUuid::createUuid().toString();
-		mUuid = mUuid.right(mUuid.length() - 1);
-		mUuid = mUuid.left(mUuid.length() - 1);
-	}	
-	mText = schlagwortMap.value(textKey).toString();
+	mUuid = uuidFromText(schlagwortMap.value(uuidKey).toString());
+	mText = textStrings.intern(schlagwortMap.value(textKey).toString());
 }
 /*
  * initialize OrderData from QVariantMap
@@ -44,13 +53,8 @@ void Schlagwort::fillFromMap(const QVariantMap& schlagwortMap)
  */
 void Schlagwort::fillFromForeignMap(const QVariantMap& schlagwortMap)
 {
-	mUuid = schlagwortMap.value(uuidForeignKey).toString();
-	if (mUuid.isEmpty()) {
-		mUuid = QUuid::createUuid().toString();
-		mUuid = mUuid.right(mUuid.length() - 1);
-		mUuid = mUuid.left(mUuid.length() - 1);
-	}	
-	mText = schlagwortMap.value(textForeignKey).toString();
+	mUuid = uuidFromText(schlagwortMap.value(uuidForeignKey).toString());
+	mText = textStrings.intern(schlagwortMap.value(textForeignKey).toString());
 }
 /*
  * initialize OrderData from QVariantMap
@@ -61,20 +65,59 @@ void Schlagwort::fillFromForeignMap(const QVariantMap& schlagwortMap)
  */
 void Schlagwort::fillFromCacheMap(const QVariantMap& schlagwortMap)
 {
-	mUuid = schlagwortMap.value(uuidKey).toString();
-	if (mUuid.isEmpty()) {
-		mUuid = QUuid::createUuid().toString();
-		mUuid = mUuid.right(mUuid.length() - 1);
-		mUuid = mUuid.left(mUuid.length() - 1);
-	}	
-	mText = schlagwortMap.value(textKey).toString();
+	mUuid = uuidFromText(schlagwortMap.value(uuidKey).toString());
+	mText = textStrings.intern(schlagwortMap.value(textKey).toString());
+}
+/*
+ * initialize Schlagwort directly from JSON tokens
+ * reader must be positioned at BeginObject
+ * same properties as fillFromCacheMap() without QVariantMap
+ */
+void Schlagwort::fillFromCacheStream(JsonStreamReader& reader)
+{
+	bool hasUuid = false;
+	while (reader.readNext() == JsonStreamReader::Name) {
+		int key = reader.nameIndex(cacheKeys);
+		reader.readNext();
+		switch (key) {
+		case UuidCacheKey:
+			mUuid = uuidFromText(reader.stringValue());
+			hasUuid = true;
+			break;
+		case TextCacheKey:
+			mText = textStrings.intern(reader.stringValue());
+			break;
+		default:
+			reader.skipValue();
+			break;
+		}
+	}
+	if (!hasUuid) {
+		mUuid = UuidKey::createUuid();
+	}
+}
+/*
+ * Exports Properties from Schlagwort into binary snapshot
+ * fixed order - corresponding import: fillFromBinaryCache()
+ */
+void Schlagwort::toBinaryCache(BinaryCacheWriter& writer)
+{
+	writer.writeUuid(mUuid);
+	writer.writeString(mText);
+}
+/*
+ * initialize Schlagwort from binary snapshot
+ * corresponding export method: toBinaryCache()
+ */
+void Schlagwort::fillFromBinaryCache(BinaryCacheReader& reader)
+{
+	mUuid = reader.readUuid();
+	mText = textStrings.intern(reader.readString());
 }
 
 void Schlagwort::prepareNew()
 {
-	mUuid = QUuid::createUuid().toString();
-	mUuid = mUuid.right(mUuid.length() - 1);
-	mUuid = mUuid.left(mUuid.length() - 1);
+	mUuid = UuidKey::createUuid();
 }
 
 /*
@@ -82,7 +125,7 @@ void Schlagwort::prepareNew()
  */
 bool Schlagwort::isValid()
 {
-	if (mUuid.isNull() || mUuid.isEmpty()) {
+	if (mUuid.isNull()) {
 		return false;
 	}
 	return true;
@@ -96,7 +139,7 @@ bool Schlagwort::isValid()
 QVariantMap Schlagwort::toMap()
 {
 	QVariantMap schlagwortMap;
-	schlagwortMap.insert(uuidKey, mUuid);
+	schlagwortMap.insert(uuidKey, mUuid.toString());
 	schlagwortMap.insert(textKey, mText);
 	return schlagwortMap;
 }
@@ -109,7 +152,7 @@ QVariantMap Schlagwort::toMap()
 QVariantMap Schlagwort::toForeignMap()
 {
 	QVariantMap schlagwortMap;
-	schlagwortMap.insert(uuidForeignKey, mUuid);
+	schlagwortMap.insert(uuidForeignKey, mUuid.toString());
 	schlagwortMap.insert(textForeignKey, mText);
 	return schlagwortMap;
 }
@@ -126,19 +169,48 @@ QVariantMap Schlagwort::toCacheMap()
 	// use default toMao()
 	return toMap();
 }
+
+/*
+ * writes Schlagwort directly as JSON tokens
+ * same properties as toCacheMap() without QVariantMap
+ * corresponding import: fillFromCacheStream()
+ */
+void Schlagwort::toCacheStream(JsonStreamWriter& writer)
+{
+	writer.beginObject();
+	writer.writeName(uuidKey);
+	writer.writeString(mUuid.toString());
+	writer.writeName(textKey);
+	writer.writeString(mText);
+	writer.endObject();
+}
 // ATT 
 // Mandatory: uuid
 // Domain KEY: uuid
 QString Schlagwort::uuid() const
 {
-	return mUuid;
+	return mUuid.toString();
 }
 
 void Schlagwort::setUuid(QString uuid)
+{
+	UuidKey key = UuidKey::fromString(uuid, "Schlagwort::setUuid");
+	if (key.isNull() && !uuid.isEmpty()) {
+		// rejected: uuid stays unchanged
+		return;
+	}
+	setUuidAsKey(key);
+}
+UuidKey Schlagwort::uuidAsKey() const
+{
+	return mUuid;
+}
+
+void Schlagwort::setUuidAsKey(const UuidKey& uuid)
 {
 	if (uuid != mUuid) {
 		mUuid = uuid;
-		emit uuidChanged(uuid);
+		emit uuidChanged(mUuid.toString());
 	}
 }
 // ATT 
@@ -148,10 +220,15 @@ QString Schlagwort::text() const
 	return mText;
 }
 
+StringPool& Schlagwort::textPool()
+{
+	return textStrings;
+}
+
 void Schlagwort::setText(QString text)
 {
 	if (text != mText) {
-		mText = text;
+		mText = textStrings.intern(text);
 		emit textChanged(text);
 	}
 }
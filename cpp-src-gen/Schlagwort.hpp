@@ -4,6 +4,12 @@
 #include <QObject>
 #include <qvariant.h>
 
+#include "UuidKey.hpp"
+#include "BinaryCache.hpp"
+#include "StringPool.hpp"
+#include "JsonStreamReader.hpp"
+#include "JsonStreamWriter.hpp"
+
 
 
 
@@ -22,6 +28,11 @@ public:
 	void fillFromMap(const QVariantMap& schlagwortMap);
 	void fillFromForeignMap(const QVariantMap& schlagwortMap);
 	void fillFromCacheMap(const QVariantMap& schlagwortMap);
+	void fillFromCacheStream(JsonStreamReader& reader);
+
+	// binary snapshot
+	void toBinaryCache(BinaryCacheWriter& writer);
+	void fillFromBinaryCache(BinaryCacheReader& reader);
 	
 	void prepareNew();
 	
@@ -31,11 +42,17 @@ public:
 	QVariantMap toMap();
 	QVariantMap toForeignMap();
 	QVariantMap toCacheMap();
+	void toCacheStream(JsonStreamWriter& writer);
 
 	QString uuid() const;
 	void setUuid(QString uuid);
+	// binary DomainKey - uuid() as String only for QML and foreign APIs
+	UuidKey uuidAsKey() const;
+	void setUuidAsKey(const UuidKey& uuid);
 	QString text() const;
 	void setText(QString text);
+	// interned text values
+	static StringPool& textPool();
 
 
 
@@ -49,7 +66,7 @@ public:
 
 private:
 
-	QString mUuid;
+	UuidKey mUuid;
 	QString mText;
 
 	Q_DISABLE_COPY (Schlagwort)
@@ -0,0 +1,268 @@
+#include "SnapshotWriter.hpp"
+#include <QDebug>
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QSet>
+
+#include "BinaryCache.hpp"
+
+SnapshotWriter::SnapshotWriter(QObject *parent) :
+		QObject(parent), mHasKunde(false), mKundeSaved(false), mKundeDelta(false), mHasAuftrag(false), mAuftragSaved(
+				false), mAuftragGeneration(0), mAppendAuftragJournal(false), mAborted(0)
+{
+}
+
+void SnapshotWriter::setKundeRecords(const QString& kundeFile, const QList<KundeRecord>& records)
+{
+	mKundeFile = kundeFile;
+	mKundeRecords = records;
+	mHasKunde = true;
+}
+
+void SnapshotWriter::setKundeDelta(const QString& kundeFile, const QList<int>& deletedNrs,
+		const QList<KundeRecord>& records)
+{
+	mKundeFile = kundeFile;
+	mKundeDeletedNrs = deletedNrs;
+	mKundeRecords = records;
+	mKundeDelta = true;
+	mHasKunde = true;
+}
+
+void SnapshotWriter::setAuftragRecords(const QString& auftragFile,
+		const QList<AuftragRecord>& records)
+{
+	mAuftragFile = auftragFile;
+	mAuftragRecords = records;
+	mHasAuftrag = true;
+}
+
+void SnapshotWriter::setAuftragPriorityRecords(const QString& priorityFile,
+		const QList<AuftragRecord>& records)
+{
+	mAuftragPriorityFile = priorityFile;
+	mAuftragPriorityRecords = records;
+}
+
+void SnapshotWriter::setAuftragGeneration(const quint32& generation,
+		const QString& obsoleteJournalFile)
+{
+	mAuftragGeneration = generation;
+	mAuftragJournalFile = obsoleteJournalFile;
+}
+
+void SnapshotWriter::setAuftragJournalRecords(const QString& journalFile,
+		const quint32& generation, const QList<int>& deletedNrs,
+		const QList<AuftragRecord>& records)
+{
+	mAuftragJournalFile = journalFile;
+	mAuftragGeneration = generation;
+	mAuftragDeletedNrs = deletedNrs;
+	mAuftragRecords = records;
+	mAppendAuftragJournal = true;
+	mHasAuftrag = true;
+}
+
+bool SnapshotWriter::hasKunde() const
+{
+	return mHasKunde;
+}
+
+bool SnapshotWriter::hasAuftrag() const
+{
+	return mHasAuftrag;
+}
+
+bool SnapshotWriter::kundeSaved() const
+{
+	return mKundeSaved;
+}
+
+bool SnapshotWriter::auftragSaved() const
+{
+	return mAuftragSaved;
+}
+
+void SnapshotWriter::abort()
+{
+	mAborted.fetchAndStoreOrdered(1);
+}
+
+bool SnapshotWriter::isAborted() const
+{
+	return mAborted != 0;
+}
+
+/*
+ * BinaryCacheWriter writes into a temp file, fsyncs
+ * and renames - the old snapshot stays valid until commit()
+ */
+void SnapshotWriter::save()
+{
+	QElapsedTimer elapsedTimer;
+	elapsedTimer.start();
+	if (mHasKunde) {
+		mKundeSaved = mKundeDelta ? mergeKundeDelta() : saveKundeSnapshot();
+		qDebug() << "SnapshotWriter Kunde #" << mKundeRecords.size() << " delta: " << mKundeDelta
+				<< " saved: " << mKundeSaved;
+	}
+	if (mHasAuftrag) {
+		if (mAppendAuftragJournal) {
+			mAuftragSaved = appendAuftragJournal();
+		} else {
+			mAuftragSaved = saveAuftragSnapshot();
+		}
+	}
+	qDebug() << "SnapshotWriter finished in ms: " << elapsedTimer.elapsed();
+	emit finished();
+}
+
+bool SnapshotWriter::saveKundeSnapshot()
+{
+	BinaryCacheWriter writer(mKundeFile);
+	if (!writer.open(BinaryCache::KundeType)) {
+		return false;
+	}
+	for (int i = 0; i < mKundeRecords.size() && !isAborted(); ++i) {
+		mKundeRecords.at(i).toBinaryCache(writer);
+		writer.recordWritten();
+	}
+	// aborted: the temp file is removed by the writer
+	return !isAborted() && writer.commit();
+}
+
+/*
+ * old snapshot is read (memory mapped) and written again with the changes:
+ * changed records at their old position, inserted ones at the end
+ * the old snapshot stays valid until commit()
+ */
+bool SnapshotWriter::mergeKundeDelta()
+{
+	BinaryCacheReader reader(mKundeFile);
+	if (!reader.open(BinaryCache::KundeType)) {
+		return false;
+	}
+	QHash<int, int> changed;
+	changed.reserve(mKundeRecords.size());
+	for (int i = 0; i < mKundeRecords.size(); ++i) {
+		changed.insert(mKundeRecords.at(i).nr, i);
+	}
+	QSet<int> deleted = mKundeDeletedNrs.toSet();
+	BinaryCacheWriter writer(mKundeFile);
+	if (!writer.open(BinaryCache::KundeType)) {
+		return false;
+	}
+	for (quint32 i = 0; i < reader.recordCount() && !isAborted(); ++i) {
+		KundeRecord record;
+		record.fillFromBinaryCache(reader);
+		if (reader.hasError()) {
+			qWarning() << "SnapshotWriter: Kunde snapshot truncated - not merged";
+			return false;
+		}
+		int pos = changed.value(record.nr, -1);
+		if (pos >= 0) {
+			mKundeRecords.at(pos).toBinaryCache(writer);
+			changed.remove(record.nr);
+		} else if (deleted.contains(record.nr)) {
+			continue;
+		} else {
+			record.toBinaryCache(writer);
+		}
+		writer.recordWritten();
+	}
+	for (int i = 0; i < mKundeRecords.size() && !isAborted(); ++i) {
+		if (changed.contains(mKundeRecords.at(i).nr)) {
+			mKundeRecords.at(i).toBinaryCache(writer);
+			writer.recordWritten();
+		}
+	}
+	reader.close();
+	return !isAborted() && writer.commit();
+}
+
+/*
+ * the journal is only valid for the snapshot it was appended to
+ * new snapshot has a new generation: old journal isn't needed anymore
+ */
+bool SnapshotWriter::saveAuftragSnapshot()
+{
+	bool saved = false;
+	BinaryCacheWriter writer(mAuftragFile);
+	writer.setGeneration(mAuftragGeneration);
+	if (writer.open(BinaryCache::AuftragType)) {
+		for (int i = 0; i < mAuftragRecords.size() && !isAborted(); ++i) {
+			mAuftragRecords.at(i).toBinaryCache(writer);
+			writer.recordWritten();
+		}
+		saved = !isAborted() && writer.commit();
+	}
+	qDebug() << "SnapshotWriter Auftrag #" << mAuftragRecords.size() << " generation: "
+			<< mAuftragGeneration << " saved: " << saved;
+	if (!saved) {
+		return false;
+	}
+	if (!mAuftragJournalFile.isEmpty()) {
+		QFile::remove(mAuftragJournalFile);
+	}
+	saveAuftragPriority();
+	return true;
+}
+
+/*
+ * 2PhaseInit: written after snapshot or journal,
+ * so phase one shows the same state as snapshot + journal
+ */
+void SnapshotWriter::saveAuftragPriority()
+{
+	if (mAuftragPriorityFile.isEmpty()) {
+		return;
+	}
+	BinaryCacheWriter priorityWriter(mAuftragPriorityFile);
+	if (priorityWriter.open(BinaryCache::AuftragType)) {
+		for (int i = 0; i < mAuftragPriorityRecords.size() && !isAborted(); ++i) {
+			mAuftragPriorityRecords.at(i).toBinaryCache(priorityWriter);
+			priorityWriter.recordWritten();
+		}
+		if (!isAborted()) {
+			priorityWriter.commit();
+		}
+	}
+}
+
+/*
+ * sequential write of the changed records only
+ * a few hundred Bytes per Auftrag instead of the complete snapshot
+ */
+bool SnapshotWriter::appendAuftragJournal()
+{
+	BinaryCacheWriter writer(mAuftragJournalFile);
+	writer.setGeneration(mAuftragGeneration);
+	if (!writer.openForAppend(BinaryCache::AuftragJournalType)) {
+		return false;
+	}
+	for (int i = 0; i < mAuftragDeletedNrs.size() && !isAborted(); ++i) {
+		writer.writeInt(BinaryCache::JournalDelete);
+		writer.writeInt(mAuftragDeletedNrs.at(i));
+		writer.recordWritten();
+	}
+	for (int i = 0; i < mAuftragRecords.size() && !isAborted(); ++i) {
+		writer.writeInt(BinaryCache::JournalUpsert);
+		mAuftragRecords.at(i).toBinaryCache(writer);
+		writer.recordWritten();
+	}
+	// aborted: entries still buffered are dropped, a cut off entry ends the replay
+	bool saved = !isAborted() && writer.sync();
+	qDebug() << "SnapshotWriter Auftrag journal entries #" << writer.recordCount() << " saved: "
+			<< saved;
+	if (saved) {
+		saveAuftragPriority();
+	}
+	return saved;
+}
+
+SnapshotWriter::~SnapshotWriter()
+{
+	// clean up
+}
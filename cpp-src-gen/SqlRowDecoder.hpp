@@ -0,0 +1,89 @@
+#ifndef SQLROWDECODER_HPP_
+#define SQLROWDECODER_HPP_
+
+#include <QDate>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
+#include <QtSql/QSqlRecord>
+
+struct sqlite3_stmt;
+
+/*
+ * column positions of one table (SELECT *)
+ * looked up in the QSqlRecord only if the schema version changed
+ * (PRAGMA schema_version - changes with every CREATE / DROP TABLE)
+ *
+ * one static binding per DTO, used from UI thread and CacheLoader:
+ * guarded by a mutex, decoders get a copy of the positions
+ */
+class SqlColumnBinding
+{
+public:
+	SqlColumnBinding(const QStringList& columns);
+
+	QVector<int> positions(const QSqlRecord& record, const int& schemaVersion);
+
+private:
+	QStringList mColumns;
+	QVector<int> mPositions;
+	int mSchemaVersion;
+	bool mBound;
+	QMutex mMutex;
+
+	Q_DISABLE_COPY (SqlColumnBinding)
+};
+
+/*
+ * typed reads of the rows of an executed forward-only query
+ *
+ * QSQLITE: the rows are stepped directly on the sqlite3_stmt of the query
+ * and read with sqlite3_column_int() / _double() / _text16() / _blob()
+ * no QVariant per value
+ * only if the linked SQLite has the version of the plugin (checked once)
+ * other drivers or other version: QSqlQuery::next() and value() as before
+ *
+ * columns are the indexes of the DTO (per ex. Kunde: nr, name, ort)
+ * mapped to the positions of the record by bind()
+ * without bind() column == position (own SELECT with fixed columns)
+ *
+ * after the last row call finish() of the query: releases the read lock
+ */
+class SqlRowDecoder
+{
+public:
+	SqlRowDecoder(QSqlQuery& query);
+
+	void bind(SqlColumnBinding& binding, const int& schemaVersion);
+	// positions on the first / next row - false at end
+	bool next();
+	int rows() const;
+	bool isNative() const;
+	int position(const int& column) const;
+
+	bool isNull(const int& column) const;
+	int intValue(const int& column) const;
+	double doubleValue(const int& column) const;
+	QString stringValue(const int& column) const;
+	QByteArray blobValue(const int& column) const;
+	// TEXT yyyy-MM-dd, NULL: invalid QDate
+	QDate dateValue(const int& column) const;
+
+	// -1 if not available
+	static int schemaVersion(const QSqlDatabase& database);
+
+private:
+	QSqlQuery& mQuery;
+	sqlite3_stmt* mStatement;
+	QVector<int> mPositions;
+	bool mFirstRowPending;
+	bool mDone;
+	int mRows;
+
+	Q_DISABLE_COPY (SqlRowDecoder)
+};
+
+#endif /* SQLROWDECODER_HPP_ */
@@ -0,0 +1,243 @@
+#include "TagIndex.hpp"
+#include <QtAlgorithms>
+
+TagIndex::TagIndex() :
+		mDocumentCount(0)
+{
+}
+
+void TagIndex::clear()
+{
+	mDocuments.clear();
+	mDocumentTags.clear();
+	mDocumentIds.clear();
+	mPostings.clear();
+	mDocumentCount = 0;
+}
+
+/*
+ * new Auftrag* get the next document id, so loading in order
+ * appends to the end of the posting lists
+ * unchanged tags (per ex. while resolving the lazy keys) are a no-op
+ */
+void TagIndex::update(Auftrag* auftrag, const QList<UuidKey>& tags)
+{
+	quint32 documentId;
+	if (mDocumentIds.contains(auftrag)) {
+		documentId = mDocumentIds.value(auftrag);
+		const QList<UuidKey>& oldTags = mDocumentTags.at(documentId);
+		if (oldTags == tags) {
+			return;
+		}
+		for (int i = 0; i < oldTags.size(); ++i) {
+			removePosting(oldTags.at(i), documentId);
+		}
+	} else {
+		documentId = mDocuments.size();
+		mDocuments.append(auftrag);
+		mDocumentTags.append(QList<UuidKey>());
+		mDocumentIds.insert(auftrag, documentId);
+		mDocumentCount++;
+	}
+	mDocumentTags[documentId] = tags;
+	for (int i = 0; i < tags.size(); ++i) {
+		addPosting(tags.at(i), documentId);
+	}
+}
+
+/*
+ * document ids of removed Auftrag* are not reused
+ */
+void TagIndex::remove(Auftrag* auftrag)
+{
+	if (!mDocumentIds.contains(auftrag)) {
+		return;
+	}
+	quint32 documentId = mDocumentIds.take(auftrag);
+	const QList<UuidKey>& oldTags = mDocumentTags.at(documentId);
+	for (int i = 0; i < oldTags.size(); ++i) {
+		removePosting(oldTags.at(i), documentId);
+	}
+	mDocumentTags[documentId] = QList<UuidKey>();
+	mDocuments[documentId] = 0;
+	mDocumentCount--;
+}
+
+QList<Auftrag*> TagIndex::query(const QList<UuidKey>& allOf, const QList<UuidKey>& anyOf,
+		const QList<UuidKey>& noneOf) const
+{
+	PostingList result;
+	bool restricted = false;
+	if (!allOf.isEmpty()) {
+		// start with the shortest posting list - intersections can only shrink
+		QList<const PostingList*> lists;
+		for (int i = 0; i < allOf.size(); ++i) {
+			QHash<UuidKey, PostingList>::const_iterator it = mPostings.constFind(allOf.at(i));
+			if (it == mPostings.constEnd()) {
+				return QList<Auftrag*>();
+			}
+			lists.append(&it.value());
+		}
+		int shortest = 0;
+		for (int i = 1; i < lists.size(); ++i) {
+			if (lists.at(i)->size() < lists.at(shortest)->size()) {
+				shortest = i;
+			}
+		}
+		result = *lists.at(shortest);
+		for (int i = 0; i < lists.size() && !result.isEmpty(); ++i) {
+			if (i != shortest) {
+				result = intersect(result, *lists.at(i));
+			}
+		}
+		restricted = true;
+	}
+	if (!anyOf.isEmpty()) {
+		PostingList anyResult;
+		for (int i = 0; i < anyOf.size(); ++i) {
+			QHash<UuidKey, PostingList>::const_iterator it = mPostings.constFind(anyOf.at(i));
+			if (it != mPostings.constEnd()) {
+				anyResult = unite(anyResult, it.value());
+			}
+		}
+		result = restricted ? intersect(result, anyResult) : anyResult;
+		restricted = true;
+	}
+	if (!restricted) {
+		result = allDocuments();
+	}
+	for (int i = 0; i < noneOf.size() && !result.isEmpty(); ++i) {
+		QHash<UuidKey, PostingList>::const_iterator it = mPostings.constFind(noneOf.at(i));
+		if (it != mPostings.constEnd()) {
+			result = subtract(result, it.value());
+		}
+	}
+	QList<Auftrag*> auftragList;
+	auftragList.reserve(result.size());
+	for (int i = 0; i < result.size(); ++i) {
+		auftragList.append(mDocuments.at(result.at(i)));
+	}
+	return auftragList;
+}
+
+int TagIndex::countForTag(const UuidKey& tag) const
+{
+	return mPostings.value(tag).size();
+}
+
+int TagIndex::documentCount() const
+{
+	return mDocumentCount;
+}
+
+void TagIndex::addPosting(const UuidKey& tag, quint32 documentId)
+{
+	PostingList& postings = mPostings[tag];
+	if (postings.isEmpty() || postings.last() < documentId) {
+		postings.append(documentId);
+		return;
+	}
+	PostingList::iterator it = qLowerBound(postings.begin(), postings.end(), documentId);
+	if (it == postings.end() || *it != documentId) {
+		postings.insert(it, documentId);
+	}
+}
+
+void TagIndex::removePosting(const UuidKey& tag, quint32 documentId)
+{
+	QHash<UuidKey, PostingList>::iterator found = mPostings.find(tag);
+	if (found == mPostings.end()) {
+		return;
+	}
+	PostingList& postings = found.value();
+	PostingList::iterator it = qLowerBound(postings.begin(), postings.end(), documentId);
+	if (it != postings.end() && *it == documentId) {
+		postings.erase(it);
+	}
+	if (postings.isEmpty()) {
+		mPostings.erase(found);
+	}
+}
+
+TagIndex::PostingList TagIndex::allDocuments() const
+{
+	PostingList documents;
+	documents.reserve(mDocumentCount);
+	for (int i = 0; i < mDocuments.size(); ++i) {
+		if (mDocuments.at(i)) {
+			documents.append(i);
+		}
+	}
+	return documents;
+}
+
+TagIndex::PostingList TagIndex::intersect(const PostingList& first, const PostingList& second)
+{
+	PostingList result;
+	result.reserve(qMin(first.size(), second.size()));
+	int i = 0;
+	int j = 0;
+	while (i < first.size() && j < second.size()) {
+		if (first.at(i) < second.at(j)) {
+			++i;
+		} else if (second.at(j) < first.at(i)) {
+			++j;
+		} else {
+			result.append(first.at(i));
+			++i;
+			++j;
+		}
+	}
+	return result;
+}
+
+TagIndex::PostingList TagIndex::unite(const PostingList& first, const PostingList& second)
+{
+	if (first.isEmpty()) {
+		return second;
+	}
+	if (second.isEmpty()) {
+		return first;
+	}
+	PostingList result;
+	result.reserve(first.size() + second.size());
+	int i = 0;
+	int j = 0;
+	while (i < first.size() && j < second.size()) {
+		if (first.at(i) < second.at(j)) {
+			result.append(first.at(i++));
+		} else if (second.at(j) < first.at(i)) {
+			result.append(second.at(j++));
+		} else {
+			result.append(first.at(i));
+			++i;
+			++j;
+		}
+	}
+	while (i < first.size()) {
+		result.append(first.at(i++));
+	}
+	while (j < second.size()) {
+		result.append(second.at(j++));
+	}
+	return result;
+}
+
+TagIndex::PostingList TagIndex::subtract(const PostingList& first, const PostingList& second)
+{
+	PostingList result;
+	result.reserve(first.size());
+	int i = 0;
+	int j = 0;
+	while (i < first.size()) {
+		if (j >= second.size() || first.at(i) < second.at(j)) {
+			result.append(first.at(i++));
+		} else if (second.at(j) < first.at(i)) {
+			++j;
+		} else {
+			++i;
+			++j;
+		}
+	}
+	return result;
+}
@@ -0,0 +1,58 @@
+#ifndef TAGINDEX_HPP_
+#define TAGINDEX_HPP_
+
+#include <QHash>
+#include <QList>
+#include <QVector>
+
+#include "UuidKey.hpp"
+
+class Auftrag;
+
+/*
+ * inverted index: Schlagwort uuid -> Auftrag*
+ * each Auftrag* gets a dense document id
+ * posting lists are sorted vectors of document ids
+ * so AND / OR / NOT queries are linear merges of the posting lists
+ * the index doesn't own the Auftrag* - DataManager keeps it in sync
+ */
+class TagIndex
+{
+public:
+	TagIndex();
+
+	void clear();
+
+	// (re)index the tags of an Auftrag - replaces previous tags
+	void update(Auftrag* auftrag, const QList<UuidKey>& tags);
+	void remove(Auftrag* auftrag);
+
+	// allOf: AND, anyOf: OR, noneOf: NOT
+	// empty allOf and anyOf means: all indexed Auftrag
+	QList<Auftrag*> query(const QList<UuidKey>& allOf, const QList<UuidKey>& anyOf,
+			const QList<UuidKey>& noneOf) const;
+
+	int countForTag(const UuidKey& tag) const;
+	int documentCount() const;
+
+private:
+	typedef QVector<quint32> PostingList;
+
+	// document id -> Auftrag*, 0 if removed
+	QVector<Auftrag*> mDocuments;
+	// document id -> indexed tags
+	QVector<QList<UuidKey> > mDocumentTags;
+	QHash<Auftrag*, quint32> mDocumentIds;
+	QHash<UuidKey, PostingList> mPostings;
+	int mDocumentCount;
+
+	void addPosting(const UuidKey& tag, quint32 documentId);
+	void removePosting(const UuidKey& tag, quint32 documentId);
+	PostingList allDocuments() const;
+
+	static PostingList intersect(const PostingList& first, const PostingList& second);
+	static PostingList unite(const PostingList& first, const PostingList& second);
+	static PostingList subtract(const PostingList& first, const PostingList& second);
+};
+
+#endif /* TAGINDEX_HPP_ */
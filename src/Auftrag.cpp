@@ -17,6 +17,25 @@ static const QString bemerkungForeignKey = "bemerkung";
 static const QString positionenForeignKey = "positionen";
 static const QString tagsForeignKey = "tags";
 static const QString auftraggeberForeignKey = "auftraggeber";
+// SQL
+static const QString tagsAuftragNrColumn = "auftrag_nr";
+static const QString tagsIndexColumn = "tag_index";
+static const QString tagsUuidColumn = "schlagwort";
+static int nrQueryPos;
+static int datumQueryPos;
+static int bemerkungQueryPos;
+static int auftraggeberQueryPos;
+enum AuftragColumn {
+	NrColumn, DatumColumn, BemerkungColumn, AuftraggeberColumn
+};
+static SqlColumnBinding sqlColumns(
+		QStringList() << nrKey << datumKey << bemerkungKey << auftraggeberKey);
+// JSON cache stream
+enum AuftragCacheKey {
+	NrCacheKey, DatumCacheKey, BemerkungCacheKey, AuftraggeberCacheKey, PositionenCacheKey, TagsCacheKey
+};
+static const JsonKeyTable cacheKeys(
+		QStringList() << nrKey << datumKey << bemerkungKey << auftraggeberKey << positionenKey << tagsKey);
 
 /*
  * Default Constructor if Auftrag not initialized from QVariantMap
@@ -34,6 +53,243 @@ Auftrag::Auftrag(QObject *parent) :
 		mTagsKeysResolved = false;
 }
 
+// S Q L
+const QString Auftrag::createTableCommand()
+{
+	QString createSQL = "CREATE TABLE auftrag (";
+	// nr
+	createSQL.append(nrKey).append(" INTEGER");
+	createSQL.append(" PRIMARY KEY");
+	createSQL.append(", ");
+	// datum
+	createSQL.append(datumKey).append(" TEXT");
+	createSQL.append(", ");
+	// bemerkung
+	createSQL.append(bemerkungKey).append(" TEXT");
+	createSQL.append(", ");
+	// auftraggeber lazy pointing to Kunde* (domainKey: nr)
+	createSQL.append(auftraggeberKey).append(" INTEGER");
+	createSQL.append(", ");
+	//
+    createSQL = createSQL.left(createSQL.length()-2);
+    createSQL.append(");");
+    return createSQL;
+}
+static QString buildParameterizedInsertPosBinding()
+{
+	QString insertSQL;
+    QString valueSQL;
+    insertSQL = "INSERT INTO auftrag (";
+    valueSQL = " VALUES (";
+// nr 
+	insertSQL.append(nrKey);
+	insertSQL.append(", ");
+	valueSQL.append("?, ");
+// datum 
+	insertSQL.append(datumKey);
+	insertSQL.append(", ");
+	valueSQL.append("?, ");
+// bemerkung 
+	insertSQL.append(bemerkungKey);
+	insertSQL.append(", ");
+	valueSQL.append("?, ");
+// auftraggeber 
+	insertSQL.append(auftraggeberKey);
+	insertSQL.append(", ");
+	valueSQL.append("?, ");
+//
+    insertSQL = insertSQL.left(insertSQL.length()-2);
+    insertSQL.append(") ");
+    valueSQL = valueSQL.left(valueSQL.length()-2);
+    valueSQL.append(") ");
+    insertSQL.append(valueSQL);
+    return insertSQL;
+}
+const QString Auftrag::createParameterizedInsertPosBinding()
+{
+	static const QString sql = buildParameterizedInsertPosBinding();
+	return sql;
+}
+static QString buildParameterizedInsertOrReplacePosBinding()
+{
+	QString insertSQL = Auftrag::createParameterizedInsertPosBinding();
+	insertSQL.replace(0, 11, "INSERT OR REPLACE INTO");
+	return insertSQL;
+}
+const QString Auftrag::createParameterizedInsertOrReplacePosBinding()
+{
+	static const QString sql = buildParameterizedInsertOrReplacePosBinding();
+	return sql;
+}
+// UPSERT updates the row in place (SQLite 3.24+)
+static QString buildParameterizedUpsertPosBinding()
+{
+	QString upsertSQL = Auftrag::createParameterizedInsertPosBinding();
+	upsertSQL.append("ON CONFLICT(").append(nrKey).append(") DO UPDATE SET ");
+	upsertSQL.append(datumKey).append(" = excluded.").append(datumKey).append(", ");
+	upsertSQL.append(bemerkungKey).append(" = excluded.").append(bemerkungKey).append(", ");
+	upsertSQL.append(auftraggeberKey).append(" = excluded.").append(auftraggeberKey);
+	return upsertSQL;
+}
+const QString Auftrag::createParameterizedUpsertPosBinding()
+{
+	static const QString sql = buildParameterizedUpsertPosBinding();
+	return sql;
+}
+// DELETE ... WHERE nr IN (?, ?, ...) with keyCount parameters
+const QString Auftrag::createParameterizedDeleteByKeys(const int& keyCount)
+{
+	QString deleteSQL = "DELETE FROM auftrag WHERE ";
+	deleteSQL.append(nrKey).append(" IN (");
+	for (int i = 0; i < keyCount; ++i) {
+		deleteSQL.append(i == 0 ? "?" : ", ?");
+	}
+	deleteSQL.append(")");
+	return deleteSQL;
+}
+/*
+ * SQL values are taken from records: the caller may process events
+ * between two chunks, so no Auftrag* is touched while writing
+ */
+void Auftrag::toSqlCache(const AuftragRecord& record, QVariantList& nrList, QVariantList& datumList,
+		QVariantList& bemerkungList, QVariantList& auftraggeberList)
+{
+	nrList << record.nr;
+	if (record.datum.isValid()) {
+		datumList << record.datum.toString("yyyy-MM-dd");
+	} else {
+		datumList << QVariant(QVariant::String);
+	}
+	bemerkungList << record.bemerkung;
+	auftraggeberList << record.auftraggeber;
+}
+void Auftrag::fillSqlQueryPos(const QSqlRecord& record)
+{
+nrQueryPos = record.indexOf(nrKey);
+datumQueryPos = record.indexOf(datumKey);
+bemerkungQueryPos = record.indexOf(bemerkungKey);
+auftraggeberQueryPos = record.indexOf(auftraggeberKey);
+}
+/*
+ * positionen and tags are added by the reader (see AuftragSqlReader)
+ */
+void Auftrag::fillFromSqlQuery(const QSqlQuery& sqlQuery)
+{
+	mNr = sqlQuery.value(nrQueryPos).toInt();
+	QVariant datumValue = sqlQuery.value(datumQueryPos);
+	if (datumValue.isNull()) {
+		mDatum = QDate();
+	} else {
+		mDatum = QDate::fromString(datumValue.toString(), "yyyy-MM-dd");
+	}
+	mBemerkung = sqlQuery.value(bemerkungQueryPos).toString();
+	// auftraggeber lazy pointing to Kunde* (domainKey: nr)
+	mAuftraggeber = sqlQuery.value(auftraggeberQueryPos).toInt();
+	mPositionen.clear();
+	mTagsKeys.clear();
+	mTagsKeysResolved = true;
+	mTags.clear();
+}
+void Auftrag::bindSqlColumns(SqlRowDecoder& decoder, const int& schemaVersion)
+{
+	decoder.bind(sqlColumns, schemaVersion);
+}
+void Auftrag::fillFromSqlRow(const SqlRowDecoder& decoder)
+{
+	mNr = decoder.intValue(NrColumn);
+	mDatum = decoder.dateValue(DatumColumn);
+	mBemerkung = decoder.stringValue(BemerkungColumn);
+	mAuftraggeber = decoder.intValue(AuftraggeberColumn);
+	mPositionen.clear();
+	mTagsKeys.clear();
+	mTagsKeysResolved = true;
+	mTags.clear();
+}
+void Auftrag::addToPositionenFromSqlRow(const SqlRowDecoder& decoder)
+{
+	Position* position = new Position();
+	position->setParent(this);
+	position->fillFromSqlRow(decoder);
+	mPositionen.append(position);
+}
+void Auftrag::positionenToSqlCache(const AuftragRecord& record, QVariantList& uuidList,
+		QVariantList& auftragNrList, QVariantList& posIndexList, QVariantList& bezeichnungList,
+		QVariantList& preisList)
+{
+	for (int i = 0; i < record.positionen.size(); ++i) {
+		Position::toSqlCache(record.positionen.at(i), record.nr, i, uuidList, auftragNrList,
+				posIndexList, bezeichnungList, preisList);
+	}
+}
+void Auftrag::addToPositionenFromSqlQuery(const QSqlQuery& sqlQuery)
+{
+	Position* position = new Position();
+	position->setParent(this);
+	position->fillFromSqlQuery(sqlQuery);
+	mPositionen.append(position);
+}
+const QString Auftrag::createTagsTableCommand()
+{
+	QString createSQL = "CREATE TABLE auftrag_tag (";
+	createSQL.append(tagsAuftragNrColumn).append(" INTEGER, ");
+	createSQL.append(tagsIndexColumn).append(" INTEGER, ");
+	createSQL.append(tagsUuidColumn).append(" BLOB, ");
+	createSQL.append("PRIMARY KEY (").append(tagsAuftragNrColumn).append(", ").append(
+			tagsIndexColumn).append("));");
+	return createSQL;
+}
+static QString buildParameterizedInsertTagsPosBinding()
+{
+	QString insertSQL = "INSERT INTO auftrag_tag (";
+	insertSQL.append(tagsAuftragNrColumn).append(", ");
+	insertSQL.append(tagsIndexColumn).append(", ");
+	insertSQL.append(tagsUuidColumn).append(") VALUES (?, ?, ?)");
+	return insertSQL;
+}
+const QString Auftrag::createParameterizedInsertTagsPosBinding()
+{
+	static const QString sql = buildParameterizedInsertTagsPosBinding();
+	return sql;
+}
+const QString Auftrag::createParameterizedDeleteTagsByKeys(const int& keyCount)
+{
+	QString deleteSQL = "DELETE FROM auftrag_tag WHERE ";
+	deleteSQL.append(tagsAuftragNrColumn).append(" IN (");
+	for (int i = 0; i < keyCount; ++i) {
+		deleteSQL.append(i == 0 ? "?" : ", ?");
+	}
+	deleteSQL.append(")");
+	return deleteSQL;
+}
+static QString buildSelectTagsCommand()
+{
+	QString selectSQL = "SELECT ";
+	selectSQL.append(tagsAuftragNrColumn).append(", ").append(tagsUuidColumn);
+	selectSQL.append(" FROM auftrag_tag ORDER BY ");
+	selectSQL.append(tagsAuftragNrColumn).append(", ").append(tagsIndexColumn);
+	return selectSQL;
+}
+const QString Auftrag::createSelectTagsCommand()
+{
+	static const QString sql = buildSelectTagsCommand();
+	return sql;
+}
+void Auftrag::tagsToSqlCache(const AuftragRecord& record, QVariantList& auftragNrList,
+		QVariantList& tagIndexList, QVariantList& uuidList)
+{
+	for (int i = 0; i < record.tags.size(); ++i) {
+		auftragNrList << record.nr;
+		tagIndexList << i;
+		uuidList << record.tags.at(i).toRfc4122();
+	}
+}
+// tags from SQL: only keys - must be resolved later
+void Auftrag::addToTagsKeysFromSqlCache(const UuidKey& uuid)
+{
+	mTagsKeys.append(uuid);
+	mTagsKeysResolved = false;
+}
+
 bool Auftrag::isAllResolved()
 {
 	if (hasAuftraggeber() && !isAuftraggeberResolvedAsDataObject()) {
@@ -85,7 +341,7 @@ void Auftrag::fillFromMap(const QVariantMap& auftragMap)
 		mPositionen.append(position);
 	}
 	// mTags is (lazy loaded) Array of Schlagwort*
-	mTagsKeys = auftragMap.value(tagsKey).toStringList();
+	fillTagsKeysFromList(auftragMap.value(tagsKey).toList());
 	// mTags must be resolved later if there are keys
 	mTagsKeysResolved = (mTagsKeys.size() == 0);
 	mTags.clear();
@@ -130,7 +386,7 @@ void Auftrag::fillFromForeignMap(const QVariantMap& auftragMap)
 		mPositionen.append(position);
 	}
 	// mTags is (lazy loaded) Array of Schlagwort*
-	mTagsKeys = auftragMap.value(tagsForeignKey).toStringList();
+	fillTagsKeysFromList(auftragMap.value(tagsForeignKey).toList());
 	// mTags must be resolved later if there are keys
 	mTagsKeysResolved = (mTagsKeys.size() == 0);
 	mTags.clear();
@@ -175,7 +431,190 @@ void Auftrag::fillFromCacheMap(const QVariantMap& auftragMap)
 		mPositionen.append(position);
 	}
 	// mTags is (lazy loaded) Array of Schlagwort*
-	mTagsKeys = auftragMap.value(tagsKey).toStringList();
+	fillTagsKeysFromList(auftragMap.value(tagsKey).toList());
+	// mTags must be resolved later if there are keys
+	mTagsKeysResolved = (mTagsKeys.size() == 0);
+	mTags.clear();
+}
+/*
+ * initialize Auftrag directly from JSON tokens
+ * reader must be positioned at BeginObject
+ * same properties as fillFromCacheMap() without QVariantMap
+ * positionen are created directly from the token stream
+ */
+void Auftrag::fillFromCacheStream(JsonStreamReader& reader)
+{
+	mPositionen.clear();
+	mTagsKeys.clear();
+	mTags.clear();
+	while (reader.readNext() == JsonStreamReader::Name) {
+		int cacheKey = reader.nameIndex(cacheKeys);
+		reader.readNext();
+		switch (cacheKey) {
+		case NrCacheKey:
+			mNr = reader.intValue();
+			break;
+		case DatumCacheKey:
+			// always getting the Date as a String (from server or JSON)
+			mDatum = QDate::fromString(reader.stringValue(), "yyyy-MM-dd");
+			if (!mDatum.isValid()) {
+				mDatum = QDate();
+				qDebug() << "mDatum is not valid for String: " << reader.stringValue();
+			}
+			break;
+		case BemerkungCacheKey:
+			mBemerkung = reader.stringValue();
+			break;
+		case AuftraggeberCacheKey:
+			// auftraggeber lazy pointing to Kunde* (domainKey: nr)
+			mAuftraggeber = reader.intValue();
+			break;
+		case PositionenCacheKey:
+			if (reader.tokenType() != JsonStreamReader::BeginArray) {
+				reader.skipValue();
+				break;
+			}
+			// mPositionen is List of Position*
+			while (reader.readNext() == JsonStreamReader::BeginObject) {
+				Position* position = new Position();
+				position->setParent(this);
+				position->fillFromCacheStream(reader);
+				if (reader.hasError()) {
+					delete position;
+					break;
+				}
+				mPositionen.append(position);
+			}
+			break;
+		case TagsCacheKey:
+			if (reader.tokenType() != JsonStreamReader::BeginArray) {
+				reader.skipValue();
+				break;
+			}
+			// mTags is (lazy loaded) Array of Schlagwort*
+			while (reader.readNext() == JsonStreamReader::String) {
+				UuidKey key = UuidKey::fromString(reader.stringValue(), "Auftrag tags");
+				if (!key.isNull()) {
+					mTagsKeys.append(key);
+				}
+			}
+			break;
+		default:
+			reader.skipValue();
+			break;
+		}
+	}
+	// mTags must be resolved later if there are keys
+	mTagsKeysResolved = (mTagsKeys.size() == 0);
+}
+/*
+ * Exports Properties from Auftrag into binary snapshot
+ * contained positionen are written inline
+ * lazy tags: only the keys are written
+ * corresponding import: fillFromBinaryCache()
+ */
+void Auftrag::toBinaryCache(BinaryCacheWriter& writer)
+{
+	writer.writeInt(mNr);
+	writer.writeDate(mDatum);
+	writer.writeString(mBemerkung);
+	// auftraggeber lazy pointing to Kunde* (domainKey: nr)
+	writer.writeInt(mAuftraggeber);
+	// mPositionen is List of Position*
+	writer.writeCount(mPositionen.size());
+	for (int i = 0; i < mPositionen.size(); ++i) {
+		mPositionen.at(i)->toBinaryCache(writer);
+	}
+	// mTags is (lazy loaded) Array of Schlagwort*
+	syncTagsKeys();
+	writer.writeCount(mTagsKeys.size());
+	for (int i = 0; i < mTagsKeys.size(); ++i) {
+		writer.writeUuid(mTagsKeys.at(i));
+	}
+}
+/*
+ * value copy for background save (SnapshotWriter)
+ * contains value copies of positionen and the tags keys
+ */
+AuftragRecord Auftrag::toRecord()
+{
+	AuftragRecord record;
+	record.nr = mNr;
+	record.datum = mDatum;
+	record.bemerkung = mBemerkung;
+	record.auftraggeber = mAuftraggeber;
+	record.positionen.reserve(mPositionen.size());
+	for (int i = 0; i < mPositionen.size(); ++i) {
+		record.positionen.append(mPositionen.at(i)->toRecord());
+	}
+	syncTagsKeys();
+	record.tags = mTagsKeys;
+	return record;
+}
+/*
+ * updates an existing Auftrag with the values of a record (same nr)
+ * setters emit the changes - existing Position* are updated in place,
+ * only Positionen no longer in the record are removed
+ */
+void Auftrag::fillFromRecord(const AuftragRecord& record)
+{
+	setDatum(record.datum);
+	setBemerkung(record.bemerkung);
+	setAuftraggeber(record.auftraggeber);
+	bool positionenCountChanged = mPositionen.size() != record.positionen.size();
+	while (mPositionen.size() > record.positionen.size()) {
+		// QML may still hold it until the next event loop
+		mPositionen.takeLast()->deleteLater();
+	}
+	for (int i = 0; i < record.positionen.size(); ++i) {
+		if (i < mPositionen.size()) {
+			mPositionen.at(i)->fillFromRecord(record.positionen.at(i));
+		} else {
+			Position* position = new Position();
+			position->setParent(this);
+			position->fillFromRecord(record.positionen.at(i));
+			mPositionen.append(position);
+		}
+	}
+	if (positionenCountChanged) {
+		emit positionenChanged(mPositionen);
+	}
+	syncTagsKeys();
+	if (mTagsKeys != record.tags) {
+		// mTags must be resolved again
+		mTagsKeys = record.tags;
+		mTags.clear();
+		mTagsKeysResolved = (mTagsKeys.size() == 0);
+		emit tagsChanged(mTags);
+	}
+}
+/*
+ * initialize Auftrag from binary snapshot
+ * Date is stored as julian day - no parsing of Strings
+ * corresponding export method: toBinaryCache()
+ */
+void Auftrag::fillFromBinaryCache(BinaryCacheReader& reader)
+{
+	mNr = reader.readInt();
+	mDatum = reader.readDate();
+	mBemerkung = reader.readString();
+	// auftraggeber lazy pointing to Kunde* (domainKey: nr)
+	mAuftraggeber = reader.readInt();
+	// mPositionen is List of Position*
+	quint32 positionenCount = reader.readCount();
+	mPositionen.clear();
+	for (quint32 i = 0; i < positionenCount && !reader.hasError(); ++i) {
+		Position* position = new Position();
+		position->setParent(this);
+		position->fillFromBinaryCache(reader);
+		mPositionen.append(position);
+	}
+	// mTags is (lazy loaded) Array of Schlagwort*
+	quint32 tagsCount = reader.readCount();
+	mTagsKeys.clear();
+	for (quint32 i = 0; i < tagsCount && !reader.hasError(); ++i) {
+		mTagsKeys.append(reader.readUuid());
+	}
 	// mTags must be resolved later if there are keys
 	mTagsKeysResolved = (mTagsKeys.size() == 0);
 	mTags.clear();
@@ -217,15 +656,8 @@ QVariantMap Auftrag::toMap()
 	}
 	// mTags points to Schlagwort*
 	// lazy array: persist only keys
-	if(mTagsKeysResolved || (mTagsKeys.size() == 0 && mTags.size() != 0)) {
-		mTagsKeys.clear();
-		for (int i = 0; i < mTags.size(); ++i) {
-			Schlagwort* schlagwort;
-			schlagwort = mTags.at(i);
-			mTagsKeys << schlagwort->uuid();
-		}
-	}
-	auftragMap.insert(tagsKey, mTagsKeys);
+	syncTagsKeys();
+	auftragMap.insert(tagsKey, tagsKeysAsStringList());
 	auftragMap.insert(nrKey, mNr);
 	if (hasDatum()) {
 		auftragMap.insert(datumKey, mDatum.toString("yyyy-MM-dd"));
@@ -250,15 +682,8 @@ QVariantMap Auftrag::toForeignMap()
 	}
 	// mTags points to Schlagwort*
 	// lazy array: persist only keys
-	if(mTagsKeysResolved || (mTagsKeys.size() == 0 && mTags.size() != 0)) {
-		mTagsKeys.clear();
-		for (int i = 0; i < mTags.size(); ++i) {
-			Schlagwort* schlagwort;
-			schlagwort = mTags.at(i);
-			mTagsKeys << schlagwort->uuid();
-		}
-	}
-	auftragMap.insert(tagsKey, mTagsKeys);
+	syncTagsKeys();
+	auftragMap.insert(tagsKey, tagsKeysAsStringList());
 	auftragMap.insert(nrForeignKey, mNr);
 	if (hasDatum()) {
 		auftragMap.insert(datumForeignKey, mDatum.toString("yyyy-MM-dd"));
@@ -281,6 +706,47 @@ QVariantMap Auftrag::toCacheMap()
 	// use default toMao()
 	return toMap();
 }
+
+/*
+ * writes Auftrag directly as JSON tokens
+ * same properties as toCacheMap() without QVariantMap
+ * positionen are written one by one - no positionenAsQVariantList()
+ * corresponding import: fillFromCacheStream()
+ */
+void Auftrag::toCacheStream(JsonStreamWriter& writer)
+{
+	writer.beginObject();
+	// auftraggeber lazy pointing to Kunde* (domainKey: nr)
+	if (mAuftraggeber != -1) {
+		writer.writeName(auftraggeberKey);
+		writer.writeInt(mAuftraggeber);
+	}
+	// mTags points to Schlagwort*
+	// lazy array: persist only keys
+	syncTagsKeys();
+	writer.writeName(tagsKey);
+	writer.beginArray();
+	for (int i = 0; i < mTagsKeys.size(); ++i) {
+		writer.writeString(mTagsKeys.at(i).toString());
+	}
+	writer.endArray();
+	writer.writeName(nrKey);
+	writer.writeInt(mNr);
+	if (hasDatum()) {
+		writer.writeName(datumKey);
+		writer.writeString(mDatum.toString("yyyy-MM-dd"));
+	}
+	writer.writeName(bemerkungKey);
+	writer.writeString(mBemerkung);
+	// mPositionen points to Position*
+	writer.writeName(positionenKey);
+	writer.beginArray();
+	for (int i = 0; i < mPositionen.size(); ++i) {
+		mPositionen.at(i)->toCacheStream(writer);
+	}
+	writer.endArray();
+	writer.endObject();
+}
 // REF
 // Lazy: auftraggeber
 // Mandatory: auftraggeber
@@ -344,9 +810,22 @@ void Auftrag::resolveAuftraggeberAsDataObject(Kunde* kunde)
         mAuftraggeberInvalid = false;
     }
 }
+// Kunde not found or deleted: forget the resolved Data Object
 void Auftrag::markAuftraggeberAsInvalid()
 {
     mAuftraggeberInvalid = true;
+    if (mAuftraggeberAsDataObject) {
+        mAuftraggeberAsDataObject = 0;
+        emit auftraggeberAsDataObjectChanged(0);
+    }
+}
+// Kunde evicted from memory: the reference stays valid
+void Auftrag::releaseAuftraggeberAsDataObject()
+{
+    if (mAuftraggeberAsDataObject) {
+        mAuftraggeberAsDataObject = 0;
+        emit auftraggeberAsDataObjectChanged(0);
+    }
 }
 // ATT 
 // Mandatory: nr
@@ -478,23 +957,36 @@ void Auftrag::addToPositionenFromMap(const QVariantMap& positionMap)
     emit addedToPositionen(position);
 }
 bool Auftrag::removeFromPositionenByUuid(const QString& uuid)
+{
+    return removeFromPositionenByUuidKey(UuidKey::fromString(uuid));
+}
+bool Auftrag::removeFromPositionenByUuidKey(const UuidKey& uuid)
 {
     for (int i = 0; i < mPositionen.size(); ++i) {
     	Position* position;
         position = mPositionen.at(i);
-        if (position->uuid() == uuid) {
+        if (position->uuidAsKey() == uuid) {
         	mPositionen.removeAt(i);
-        	emit removedFromPositionenByUuid(uuid);
+        	emit removedFromPositionenByUuid(uuid.toString());
         	// positionen are contained - so we must delete them
         	position->deleteLater();
         	position = 0;
         	return true;
         }
     }
-    qDebug() << "uuid not found in positionen: " << uuid;
+    qDebug() << "uuid not found in positionen: " << uuid.toString();
     return false;
 }
 
+/**
+ * Position has no SIGNAL connection to its Auftrag
+ * (would cost a connection per Position) - Position calls this method
+ */
+void Auftrag::positionChanged(Position* position)
+{
+    emit changedInPositionen(position);
+}
+
 int Auftrag::positionenCount()
 {
     return mPositionen.size();
@@ -601,6 +1093,7 @@ bool Auftrag::removeFromTags(Schlagwort* schlagwort)
     	qDebug() << "Schlagwort* not found in tags";
     	return false;
     }
+    emit removedFromTags(schlagwort);
     // tags are independent - DON'T delete them
     return true;
 }
@@ -627,9 +1120,58 @@ bool Auftrag::areTagsKeysResolved()
 
 QStringList Auftrag::tagsKeys()
 {
+    syncTagsKeys();
+    return tagsKeysAsStringList();
+}
+
+QList<UuidKey> Auftrag::tagsUuidKeys()
+{
+    syncTagsKeys();
     return mTagsKeys;
 }
 
+/**
+ * if tags are resolved (or only added, never loaded as keys)
+ * the keys are taken from the Schlagwort* - else the lazy keys are valid
+ */
+void Auftrag::syncTagsKeys()
+{
+	if(mTagsKeysResolved || (mTagsKeys.size() == 0 && mTags.size() != 0)) {
+		mTagsKeys.clear();
+		for (int i = 0; i < mTags.size(); ++i) {
+			Schlagwort* schlagwort;
+			schlagwort = mTags.at(i);
+			mTagsKeys << schlagwort->uuidAsKey();
+		}
+	}
+}
+
+/**
+ * keys are persisted as uuid Strings (JSON, Server API)
+ * but stored as binary UuidKey
+ */
+void Auftrag::fillTagsKeysFromList(const QVariantList& tagsList)
+{
+    mTagsKeys.clear();
+    mTagsKeys.reserve(tagsList.size());
+    for (int i = 0; i < tagsList.size(); ++i) {
+        UuidKey key = UuidKey::fromString(tagsList.at(i).toString(), "Auftrag tags");
+        if (key.isNull()) {
+            continue;
+        }
+        mTagsKeys.append(key);
+    }
+}
+QStringList Auftrag::tagsKeysAsStringList()
+{
+    QStringList keyList;
+    keyList.reserve(mTagsKeys.size());
+    for (int i = 0; i < mTagsKeys.size(); ++i) {
+        keyList.append(mTagsKeys.at(i).toString());
+    }
+    return keyList;
+}
+
 void Auftrag::resolveTagsKeys(QList<Schlagwort*> tags)
 {
     if(mTagsKeysResolved){
@@ -713,7 +1255,11 @@ void Auftrag::clearTagsProperty(QDeclarativeListProperty<Schlagwort> *tagsList)
     Auftrag *auftrag = qobject_cast<Auftrag *>(tagsList->object);
     if (auftrag) {
         // tags are independent - DON'T delete them
+        QList<Schlagwort*> removedTags = auftrag->mTags;
         auftrag->mTags.clear();
+        for (int i = 0; i < removedTags.size(); ++i) {
+            emit auftrag->removedFromTags(removedTags.at(i));
+        }
     } else {
         qWarning() << "cannot clear tags " << "Object is not of type Auftrag*";
     }
@@ -0,0 +1,91 @@
+#include "AuftragSqlReader.hpp"
+#include <QDebug>
+#include <QStringList>
+#include <QtSql/QSqlError>
+#include <QtSql/QSqlRecord>
+
+#include "Auftrag.hpp"
+
+AuftragSqlReader::AuftragSqlReader(const QSqlDatabase& database) :
+		mDatabase(database), mAuftragQuery(database), mPositionQuery(database), mTagsQuery(
+				database), mAuftragRows(0), mPositionRows(0), mTagsRows(0), mHasPosition(false), mHasTag(
+				false)
+{
+}
+
+AuftragSqlReader::~AuftragSqlReader()
+{
+	delete mAuftragRows;
+	delete mPositionRows;
+	delete mTagsRows;
+}
+
+bool AuftragSqlReader::open()
+{
+	QStringList tables = mDatabase.tables();
+	if (!tables.contains("auftrag") || !tables.contains("position")
+			|| !tables.contains("auftrag_tag")) {
+		return false;
+	}
+	int schemaVersion = SqlRowDecoder::schemaVersion(mDatabase);
+	mAuftragQuery.setForwardOnly(true);
+	if (!mAuftragQuery.exec("SELECT * FROM auftrag ORDER BY nr")) {
+		qWarning() << "NO SUCCESS query auftrag " << mAuftragQuery.lastError().text();
+		return false;
+	}
+	mAuftragRows = new SqlRowDecoder(mAuftragQuery);
+	Auftrag::bindSqlColumns(*mAuftragRows, schemaVersion);
+	mPositionQuery.setForwardOnly(true);
+	if (!mPositionQuery.exec("SELECT * FROM position ORDER BY auftrag_nr, pos_index")) {
+		qWarning() << "NO SUCCESS query position " << mPositionQuery.lastError().text();
+		return false;
+	}
+	mPositionRows = new SqlRowDecoder(mPositionQuery);
+	Position::bindSqlColumns(*mPositionRows, schemaVersion);
+	mTagsQuery.setForwardOnly(true);
+	if (!mTagsQuery.exec(Auftrag::createSelectTagsCommand())) {
+		qWarning() << "NO SUCCESS query auftrag_tag " << mTagsQuery.lastError().text();
+		return false;
+	}
+	// fixed columns: auftrag_nr, tag uuid
+	mTagsRows = new SqlRowDecoder(mTagsQuery);
+	mHasPosition = mPositionRows->next();
+	mHasTag = mTagsRows->next();
+	return true;
+}
+
+int AuftragSqlReader::count()
+{
+	QSqlQuery countQuery(mDatabase);
+	if (countQuery.exec("SELECT COUNT(*) FROM auftrag") && countQuery.next()) {
+		return countQuery.value(0).toInt();
+	}
+	return -1;
+}
+
+Auftrag* AuftragSqlReader::next()
+{
+	if (!mAuftragRows || !mAuftragRows->next()) {
+		return 0;
+	}
+	Auftrag* auftrag = new Auftrag();
+	auftrag->fillFromSqlRow(*mAuftragRows);
+	int nr = auftrag->nr();
+	int auftragNrColumn = Position::auftragNrSqlColumn();
+	// rows of deleted Auftrag are skipped
+	while (mHasPosition && mPositionRows->intValue(auftragNrColumn) < nr) {
+		mHasPosition = mPositionRows->next();
+	}
+	while (mHasPosition && mPositionRows->intValue(auftragNrColumn) == nr) {
+		auftrag->addToPositionenFromSqlRow(*mPositionRows);
+		mHasPosition = mPositionRows->next();
+	}
+	while (mHasTag && mTagsRows->intValue(0) < nr) {
+		mHasTag = mTagsRows->next();
+	}
+	while (mHasTag && mTagsRows->intValue(0) == nr) {
+		auftrag->addToTagsKeysFromSqlCache(UuidKey::fromRfc4122(mTagsRows->blobValue(1)));
+		mHasTag = mTagsRows->next();
+	}
+	return auftrag;
+}
@@ -0,0 +1,387 @@
+#include "BinaryCache.hpp"
+#include <QDebug>
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+static const char magic[4] = { 'E', 'M', 'B', 'C' };
+static const quint32 byteOrderMark = 0x01020304;
+// write buffer is flushed to the file at this size
+static const int bufferSize = 256 * 1024;
+// each record starts with at least one qint32, quint32 or uuid
+static const int minRecordSize = 4;
+
+const quint16 BinaryCache::formatVersion = 1;
+const int BinaryCache::headerSize = 24;
+
+// W R I T E R
+
+BinaryCacheWriter::BinaryCacheWriter(const QString& filePath) :
+		mFilePath(filePath), mFile(filePath + ".tmp"), mRecordCount(0), mDtoType(0), mGeneration(
+				0), mFailed(false), mAppend(false)
+{
+}
+
+BinaryCacheWriter::~BinaryCacheWriter()
+{
+	if (mFile.isOpen()) {
+		if (mAppend) {
+			// entries not synced are lost - never remove the journal
+			mFile.close();
+		} else {
+			cancel();
+		}
+	}
+}
+
+/*
+ * snapshot is written into a temp file
+ * only commit() replaces the existing snapshot
+ */
+bool BinaryCacheWriter::open(const BinaryCache::DtoType& dtoType)
+{
+	mDtoType = dtoType;
+	mRecordCount = 0;
+	mFailed = false;
+	if (!mFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		qWarning() << "cannot open " << mFile.fileName() << ":" << mFile.errorString();
+		return false;
+	}
+	mBuffer.reserve(bufferSize + 1024);
+	mBuffer.append(header());
+	return true;
+}
+
+QByteArray BinaryCacheWriter::header() const
+{
+	QByteArray headerData;
+	headerData.reserve(BinaryCache::headerSize);
+	headerData.append(magic, 4);
+	headerData.append((const char*) &byteOrderMark, 4);
+	headerData.append((const char*) &BinaryCache::formatVersion, 2);
+	headerData.append((const char*) &mDtoType, 2);
+	headerData.append((const char*) &mRecordCount, 4);
+	headerData.append((const char*) &mGeneration, 4);
+	quint32 reserved = 0;
+	headerData.append((const char*) &reserved, 4);
+	return headerData;
+}
+
+bool BinaryCacheWriter::commit()
+{
+	flushBuffer();
+	// now we know the number of records
+	if (!mFailed && mFile.seek(0)) {
+		QByteArray headerData = header();
+		mFailed = mFile.write(headerData) != headerData.size();
+	} else {
+		mFailed = true;
+	}
+	if (!mFailed) {
+		mFailed = !mFile.flush() || ::fsync(mFile.handle()) != 0;
+	}
+	mFile.close();
+	if (mFailed) {
+		qWarning() << "cannot write binary cache " << mFilePath;
+		mFile.remove();
+		return false;
+	}
+	// rename() replaces the old snapshot atomically
+	if (::rename(QFile::encodeName(mFile.fileName()).constData(),
+			QFile::encodeName(mFilePath).constData()) != 0) {
+		qWarning() << "cannot rename binary cache to " << mFilePath;
+		mFile.remove();
+		return false;
+	}
+	return true;
+}
+
+void BinaryCacheWriter::setGeneration(const quint32& generation)
+{
+	mGeneration = generation;
+}
+
+/*
+ * journal is written without temp file
+ * a crash can only cut off the last entries - reader stops there
+ */
+bool BinaryCacheWriter::openForAppend(const BinaryCache::DtoType& dtoType)
+{
+	mDtoType = dtoType;
+	mRecordCount = 0;
+	mFailed = false;
+	mAppend = true;
+	mFile.setFileName(mFilePath);
+	if (!mFile.open(QIODevice::WriteOnly | QIODevice::Append)) {
+		qWarning() << "cannot open " << mFile.fileName() << ":" << mFile.errorString();
+		return false;
+	}
+	mBuffer.reserve(bufferSize + 1024);
+	if (mFile.size() == 0) {
+		mBuffer.append(header());
+	}
+	return true;
+}
+
+bool BinaryCacheWriter::sync()
+{
+	flushBuffer();
+	if (!mFailed) {
+		mFailed = !mFile.flush() || ::fsync(mFile.handle()) != 0;
+	}
+	mFile.close();
+	if (mFailed) {
+		qWarning() << "cannot append to journal " << mFilePath;
+		return false;
+	}
+	return true;
+}
+
+void BinaryCacheWriter::cancel()
+{
+	mFile.close();
+	mFile.remove();
+	mBuffer.clear();
+}
+
+void BinaryCacheWriter::append(const void* data, int length)
+{
+	mBuffer.append((const char*) data, length);
+	if (mBuffer.size() >= bufferSize) {
+		flushBuffer();
+	}
+}
+
+void BinaryCacheWriter::flushBuffer()
+{
+	if (mBuffer.isEmpty()) {
+		return;
+	}
+	if (mFile.write(mBuffer) != mBuffer.size()) {
+		mFailed = true;
+	}
+	mBuffer.resize(0);
+}
+
+void BinaryCacheWriter::writeInt(const qint32& value)
+{
+	append(&value, sizeof(qint32));
+}
+
+void BinaryCacheWriter::writeDouble(const double& value)
+{
+	append(&value, sizeof(double));
+}
+
+void BinaryCacheWriter::writeDate(const QDate& value)
+{
+	qint32 julianDay = 0;
+	if (!value.isNull() && value.isValid()) {
+		julianDay = value.toJulianDay();
+	}
+	writeInt(julianDay);
+}
+
+void BinaryCacheWriter::writeString(const QString& value)
+{
+	writeCount(value.length());
+	append(value.constData(), value.length() * sizeof(QChar));
+}
+
+void BinaryCacheWriter::writeUuid(const UuidKey& value)
+{
+	quint64 high = value.high();
+	quint64 low = value.low();
+	append(&high, sizeof(quint64));
+	append(&low, sizeof(quint64));
+}
+
+void BinaryCacheWriter::writeCount(const quint32& count)
+{
+	append(&count, sizeof(quint32));
+}
+
+void BinaryCacheWriter::recordWritten()
+{
+	mRecordCount++;
+}
+
+quint32 BinaryCacheWriter::recordCount() const
+{
+	return mRecordCount;
+}
+
+// R E A D E R
+
+BinaryCacheReader::BinaryCacheReader(const QString& filePath) :
+		mFile(filePath), mData(0), mSize(0), mPos(0), mRecordCount(0), mGeneration(0), mMapped(
+				false), mError(false)
+{
+}
+
+BinaryCacheReader::~BinaryCacheReader()
+{
+	close();
+}
+
+/*
+ * maps the snapshot into memory and checks the header
+ * if mapping isn't possible the file is read into memory
+ */
+bool BinaryCacheReader::open(const BinaryCache::DtoType& dtoType)
+{
+	if (!mFile.exists()) {
+		return false;
+	}
+	if (!mFile.open(QIODevice::ReadOnly)) {
+		qWarning() << "cannot open " << mFile.fileName() << ":" << mFile.errorString();
+		return false;
+	}
+	mSize = mFile.size();
+	if (mSize < BinaryCache::headerSize) {
+		qWarning() << "binary cache too small: " << mFile.fileName();
+		close();
+		return false;
+	}
+	mData = mFile.map(0, mSize);
+	mMapped = (mData != 0);
+	if (!mMapped) {
+		mFallback = mFile.readAll();
+		mData = reinterpret_cast<const uchar*>(mFallback.constData());
+	}
+	mPos = 0;
+	mError = false;
+	char fileMagic[4];
+	quint32 fileByteOrderMark;
+	quint16 fileFormatVersion;
+	quint16 fileDtoType;
+	quint32 reserved;
+	read(fileMagic, 4);
+	read(&fileByteOrderMark, 4);
+	read(&fileFormatVersion, 2);
+	read(&fileDtoType, 2);
+	read(&mRecordCount, 4);
+	read(&mGeneration, 4);
+	read(&reserved, 4);
+	if (memcmp(fileMagic, magic, 4) != 0 || fileByteOrderMark != byteOrderMark) {
+		qWarning() << "not a binary cache: " << mFile.fileName();
+		close();
+		return false;
+	}
+	if (fileFormatVersion != BinaryCache::formatVersion || fileDtoType != dtoType) {
+		qWarning() << "binary cache version " << fileFormatVersion << " type " << fileDtoType
+				<< " not supported: " << mFile.fileName();
+		close();
+		return false;
+	}
+	// corrupt header: record count is used to reserve memory
+	if (dtoType != BinaryCache::AuftragJournalType
+			&& mRecordCount > (mSize - BinaryCache::headerSize) / minRecordSize) {
+		qWarning() << "binary cache record count " << mRecordCount << " exceeds file size: "
+				<< mFile.fileName();
+		close();
+		return false;
+	}
+	return true;
+}
+
+void BinaryCacheReader::close()
+{
+	if (mMapped) {
+		mFile.unmap(const_cast<uchar*>(mData));
+		mMapped = false;
+	}
+	mData = 0;
+	mFallback.clear();
+	mFile.close();
+}
+
+quint32 BinaryCacheReader::recordCount() const
+{
+	return mRecordCount;
+}
+
+quint32 BinaryCacheReader::generation() const
+{
+	return mGeneration;
+}
+
+bool BinaryCacheReader::hasError() const
+{
+	return mError;
+}
+
+bool BinaryCacheReader::atEnd() const
+{
+	return mPos >= mSize;
+}
+
+/*
+ * memcpy - values are not aligned inside the snapshot
+ */
+bool BinaryCacheReader::read(void* data, int length)
+{
+	if (mError || mPos + length > mSize) {
+		mError = true;
+		memset(data, 0, length);
+		return false;
+	}
+	memcpy(data, mData + mPos, length);
+	mPos += length;
+	return true;
+}
+
+qint32 BinaryCacheReader::readInt()
+{
+	qint32 value;
+	read(&value, sizeof(qint32));
+	return value;
+}
+
+double BinaryCacheReader::readDouble()
+{
+	double value;
+	read(&value, sizeof(double));
+	return value;
+}
+
+QDate BinaryCacheReader::readDate()
+{
+	qint32 julianDay = readInt();
+	if (julianDay == 0) {
+		return QDate();
+	}
+	return QDate::fromJulianDay(julianDay);
+}
+
+QString BinaryCacheReader::readString()
+{
+	quint32 length = readCount();
+	if (length == 0) {
+		return QString("");
+	}
+	if (mError || mPos + qint64(length) * 2 > mSize) {
+		mError = true;
+		return QString("");
+	}
+	QString value(length, Qt::Uninitialized);
+	read(value.data(), length * sizeof(QChar));
+	return value;
+}
+
+UuidKey BinaryCacheReader::readUuid()
+{
+	quint64 high;
+	quint64 low;
+	read(&high, sizeof(quint64));
+	read(&low, sizeof(quint64));
+	return UuidKey(high, low);
+}
+
+quint32 BinaryCacheReader::readCount()
+{
+	quint32 count;
+	read(&count, sizeof(quint32));
+	return count;
+}
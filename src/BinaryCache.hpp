@@ -0,0 +1,132 @@
+#ifndef BINARYCACHE_HPP_
+#define BINARYCACHE_HPP_
+
+#include <QFile>
+#include <QByteArray>
+#include <QString>
+#include <QDate>
+
+#include "UuidKey.hpp"
+
+/*
+ * versioned binary snapshot of a list of DTOs
+ *
+ * Header (24 Bytes):
+ * magic "EMBC" | byte order mark quint32 | format version quint16 |
+ * dto type quint16 | record count quint32 | generation quint32 | reserved quint32
+ *
+ * Records are written by the DTOs (toBinaryCache / fillFromBinaryCache):
+ * int: qint32, double: 8 Bytes, Date: qint32 julian day (0: null),
+ * String: quint32 length + UTF-16 data, UuidKey: 16 Bytes,
+ * lists: quint32 count + elements
+ *
+ * values are stored in native byte order, the byte order mark
+ * rejects snapshots from a device with different byte order
+ * Reader maps the file into memory (mmap) and reads without copying the file
+ *
+ * journal (AuftragJournalType): same header, generation of the snapshot
+ * the journal belongs to, record count not used
+ * entries are appended: operation qint32 | record (Upsert) or key (Delete)
+ */
+class BinaryCache
+{
+public:
+	enum DtoType {
+		KundeType = 1,
+		AuftragType = 2,
+		PositionType = 3,
+		SchlagwortType = 4,
+		AuftragJournalType = 5
+	};
+	enum JournalOperation {
+		JournalUpsert = 1,
+		JournalDelete = 2
+	};
+	static const quint16 formatVersion;
+	static const int headerSize;
+};
+
+class BinaryCacheWriter
+{
+public:
+	BinaryCacheWriter(const QString& filePath);
+	~BinaryCacheWriter();
+
+	bool open(const BinaryCache::DtoType& dtoType);
+	// patches the record count, syncs and replaces the old snapshot
+	bool commit();
+	void cancel();
+	// journal: appends to the file itself, header only if the file is new
+	bool openForAppend(const BinaryCache::DtoType& dtoType);
+	// journal: writes the buffer and syncs
+	bool sync();
+	// must be set before open() / openForAppend()
+	void setGeneration(const quint32& generation);
+
+	void writeInt(const qint32& value);
+	void writeDouble(const double& value);
+	void writeDate(const QDate& value);
+	void writeString(const QString& value);
+	void writeUuid(const UuidKey& value);
+	void writeCount(const quint32& count);
+	void recordWritten();
+
+	quint32 recordCount() const;
+
+private:
+	QString mFilePath;
+	QFile mFile;
+	QByteArray mBuffer;
+	quint32 mRecordCount;
+	quint16 mDtoType;
+	quint32 mGeneration;
+	bool mFailed;
+	bool mAppend;
+
+	void append(const void* data, int length);
+	void flushBuffer();
+	QByteArray header() const;
+
+	Q_DISABLE_COPY (BinaryCacheWriter)
+};
+
+class BinaryCacheReader
+{
+public:
+	BinaryCacheReader(const QString& filePath);
+	~BinaryCacheReader();
+
+	bool open(const BinaryCache::DtoType& dtoType);
+	void close();
+
+	quint32 recordCount() const;
+	quint32 generation() const;
+	bool hasError() const;
+	// journal: all entries read
+	bool atEnd() const;
+
+	qint32 readInt();
+	double readDouble();
+	QDate readDate();
+	QString readString();
+	UuidKey readUuid();
+	quint32 readCount();
+
+private:
+	QFile mFile;
+	// mapped file or (fallback) data read into mFallback
+	const uchar* mData;
+	QByteArray mFallback;
+	qint64 mSize;
+	qint64 mPos;
+	quint32 mRecordCount;
+	quint32 mGeneration;
+	bool mMapped;
+	bool mError;
+
+	bool read(void* data, int length);
+
+	Q_DISABLE_COPY (BinaryCacheReader)
+};
+
+#endif /* BINARYCACHE_HPP_ */
@@ -0,0 +1,298 @@
+#include "CacheCodec.hpp"
+#include <QDebug>
+
+#include <QFile>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+static const char magic[4] = { 'E', 'M', 'C', 'Z' };
+static const quint8 formatVersion = 1;
+
+const int CacheCodec::headerSize = 8;
+const int CacheCodec::blockSize = 256 * 1024;
+
+// qCompress() of a full block: 4 Bytes uncompressed size + zlib stream
+// zlib compressBound() of the block - anything longer is corrupt
+static const quint32 maxBlockLength = 4 + CacheCodec::blockSize + (CacheCodec::blockSize >> 12)
+		+ (CacheCodec::blockSize >> 14) + 13;
+
+// a corrupt length must not allocate more than one block
+static bool isValidBlock(const uchar* block, const quint32& blockLength)
+{
+	if (blockLength < 4 || blockLength > maxBlockLength) {
+		return false;
+	}
+	quint32 uncompressedLength = (quint32(block[0]) << 24) | (quint32(block[1]) << 16)
+			| (quint32(block[2]) << 8) | quint32(block[3]);
+	return uncompressedLength <= (quint32) CacheCodec::blockSize;
+}
+
+static QByteArray header(const CacheCodec::Codec& codec)
+{
+	QByteArray headerData(magic, 4);
+	headerData.append((char) formatVersion);
+	headerData.append((char) codec);
+	headerData.append((char) 0);
+	headerData.append((char) 0);
+	return headerData;
+}
+
+// length of the compressed block followed by the block
+static QByteArray compressBlock(const char* data, const int& length, const CacheCodec::Codec& codec)
+{
+	int level = (codec == CacheCodec::ZlibBestCodec) ? 9 : 1;
+	QByteArray block = qCompress(reinterpret_cast<const uchar*>(data), length, level);
+	quint32 blockLength = block.size();
+	block.prepend(QByteArray((const char*) &blockLength, 4));
+	return block;
+}
+
+QByteArray CacheCodec::encode(const QByteArray& data, const Codec& codec)
+{
+	if (codec == PlainCodec) {
+		return data;
+	}
+	QByteArray encoded = header(codec);
+	// roughly: JSON of the caches compresses to 1/5 .. 1/10
+	encoded.reserve(headerSize + data.size() / 4);
+	for (int pos = 0; pos < data.size(); pos += blockSize) {
+		int length = qMin(blockSize, data.size() - pos);
+		encoded.append(compressBlock(data.constData() + pos, length, codec));
+	}
+	return encoded;
+}
+
+bool CacheCodec::isCompressed(const QByteArray& data)
+{
+	return data.size() >= headerSize && memcmp(data.constData(), magic, 4) == 0;
+}
+
+bool CacheCodec::isCompressed(QIODevice* device)
+{
+	return isCompressed(device->peek(headerSize));
+}
+
+QByteArray CacheCodec::decode(const QByteArray& data, bool* ok)
+{
+	if (ok) {
+		*ok = true;
+	}
+	if (!isCompressed(data)) {
+		return data;
+	}
+	QByteArray decoded;
+	int pos = headerSize;
+	while (pos + 4 <= data.size()) {
+		quint32 blockLength;
+		memcpy(&blockLength, data.constData() + pos, 4);
+		pos += 4;
+		if (pos + (qint64) blockLength > data.size()
+				|| !isValidBlock(reinterpret_cast<const uchar*>(data.constData() + pos), blockLength)) {
+			break;
+		}
+		QByteArray block = qUncompress(
+				reinterpret_cast<const uchar*>(data.constData() + pos), blockLength);
+		if (block.isEmpty()) {
+			break;
+		}
+		decoded.append(block);
+		pos += blockLength;
+	}
+	if (pos != data.size()) {
+		qWarning() << "compressed cache is truncated or corrupt";
+		if (ok) {
+			*ok = false;
+		}
+	}
+	return decoded;
+}
+
+/*
+ * written to <filePath>.tmp, synced and renamed
+ * same as JsonStreamWriter::commit(): the old cache stays if writing fails
+ */
+bool CacheCodec::writeFile(const QString& filePath, const QByteArray& data, const Codec& codec)
+{
+	QFile file(filePath + ".tmp");
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		qWarning() << "cannot open " << file.fileName() << ":" << file.errorString();
+		return false;
+	}
+	QByteArray encoded = encode(data, codec);
+	bool failed = file.write(encoded) != encoded.size();
+	if (!failed) {
+		failed = !file.flush() || ::fsync(file.handle()) != 0;
+	}
+	file.close();
+	if (failed) {
+		qWarning() << "cannot write " << file.fileName() << ":" << file.errorString();
+		file.remove();
+		return false;
+	}
+	// rename() replaces the old cache atomically
+	if (::rename(QFile::encodeName(file.fileName()).constData(),
+			QFile::encodeName(filePath).constData()) != 0) {
+		qWarning() << "cannot rename cache to " << filePath;
+		file.remove();
+		return false;
+	}
+	return true;
+}
+
+QByteArray CacheCodec::readFile(const QString& filePath, bool* ok)
+{
+	QFile file(filePath);
+	if (!file.open(QIODevice::ReadOnly)) {
+		qWarning() << "cannot open " << filePath << ":" << file.errorString();
+		if (ok) {
+			*ok = false;
+		}
+		return QByteArray();
+	}
+	return decode(file.readAll(), ok);
+}
+
+// D E V I C E
+
+CacheCodecDevice::CacheCodecDevice(QIODevice* source, QObject *parent) :
+		QIODevice(parent), mSource(source), mBlockPos(0), mError(false), mCodec(
+				CacheCodec::ZlibFastCodec)
+{
+}
+
+CacheCodecDevice::~CacheCodecDevice()
+{
+	if (isOpen() && isWritable()) {
+		close();
+	}
+}
+
+void CacheCodecDevice::setCodec(const CacheCodec::Codec& codec)
+{
+	mCodec = codec;
+}
+
+bool CacheCodecDevice::open(OpenMode mode)
+{
+	if (mode == QIODevice::WriteOnly) {
+		if (mCodec == CacheCodec::PlainCodec) {
+			return false;
+		}
+		QByteArray headerData = header(mCodec);
+		mBlock.clear();
+		mBlock.reserve(CacheCodec::blockSize);
+		mError = mSource->write(headerData) != headerData.size();
+		return !mError && QIODevice::open(mode);
+	}
+	if (mode != QIODevice::ReadOnly || !CacheCodec::isCompressed(mSource)) {
+		return false;
+	}
+	QByteArray headerData = mSource->read(CacheCodec::headerSize);
+	if ((quint8) headerData.at(4) != formatVersion) {
+		qWarning() << "compressed cache version not supported: " << (int) headerData.at(4);
+		return false;
+	}
+	mBlock.clear();
+	mBlockPos = 0;
+	mError = false;
+	return QIODevice::open(mode);
+}
+
+bool CacheCodecDevice::isSequential() const
+{
+	return true;
+}
+
+bool CacheCodecDevice::atEnd() const
+{
+	return mBlockPos >= mBlock.size() && mSource->atEnd() && QIODevice::atEnd();
+}
+
+bool CacheCodecDevice::hasError() const
+{
+	return mError;
+}
+
+bool CacheCodecDevice::readBlock()
+{
+	mBlock.clear();
+	mBlockPos = 0;
+	if (mError || mSource->atEnd()) {
+		return false;
+	}
+	quint32 blockLength;
+	if (mSource->read((char*) &blockLength, 4) != 4 || blockLength > maxBlockLength) {
+		mError = true;
+		return false;
+	}
+	QByteArray compressed = mSource->read(blockLength);
+	if (compressed.size() != (int) blockLength
+			|| !isValidBlock(reinterpret_cast<const uchar*>(compressed.constData()), blockLength)) {
+		mError = true;
+		return false;
+	}
+	mBlock = qUncompress(compressed);
+	if (mBlock.isEmpty()) {
+		mError = true;
+		return false;
+	}
+	return true;
+}
+
+qint64 CacheCodecDevice::readData(char* data, qint64 maxSize)
+{
+	qint64 copied = 0;
+	while (copied < maxSize) {
+		if (mBlockPos >= mBlock.size() && !readBlock()) {
+			break;
+		}
+		qint64 length = qMin(maxSize - copied, (qint64) (mBlock.size() - mBlockPos));
+		memcpy(data + copied, mBlock.constData() + mBlockPos, length);
+		mBlockPos += length;
+		copied += length;
+	}
+	if (mError) {
+		qWarning() << "compressed cache is truncated or corrupt";
+		if (copied == 0) {
+			return -1;
+		}
+	}
+	return copied;
+}
+
+/*
+ * collects the data until a block is complete
+ * so compressed files written as stream look like encode()
+ */
+qint64 CacheCodecDevice::writeData(const char* data, qint64 maxSize)
+{
+	if (mError) {
+		return -1;
+	}
+	mBlock.append(data, maxSize);
+	while (mBlock.size() >= CacheCodec::blockSize) {
+		if (!writeBlock(CacheCodec::blockSize)) {
+			return -1;
+		}
+	}
+	return maxSize;
+}
+
+bool CacheCodecDevice::writeBlock(const int& length)
+{
+	QByteArray block = compressBlock(mBlock.constData(), length, mCodec);
+	mError = mSource->write(block) != block.size();
+	mBlock.remove(0, length);
+	return !mError;
+}
+
+// writing: the last (not complete) block is written
+void CacheCodecDevice::close()
+{
+	if (isOpen() && isWritable() && !mBlock.isEmpty() && !mError) {
+		writeBlock(mBlock.size());
+	}
+	mBlock.clear();
+	QIODevice::close();
+}
@@ -0,0 +1,456 @@
+#include "CacheLoader.hpp"
+#include <QDebug>
+
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
+#include <QtSql/QSqlRecord>
+#include <QtSql/QSqlError>
+#include <QElapsedTimer>
+#include <QFile>
+
+#include "Kunde.hpp"
+#include "Auftrag.hpp"
+#include "Schlagwort.hpp"
+#include "BinaryCache.hpp"
+#include "JsonStreamReader.hpp"
+#include "AuftragSqlReader.hpp"
+#include "CacheCodec.hpp"
+
+// the worker uses its own connection to the SQLite database
+static QString connectionName = "cacheLoader";
+
+/*
+ * keys of the first count records of a snapshot
+ * only read if the snapshot is truncated - no cost while loading
+ */
+template<typename T, typename K>
+static QSet<K> keysOfSnapshot(const QString& filePath, const BinaryCache::DtoType& dtoType,
+		const int& count, K (T::*key)() const)
+{
+	QSet<K> keys;
+	BinaryCacheReader reader(filePath);
+	if (!reader.open(dtoType)) {
+		return keys;
+	}
+	keys.reserve(count);
+	for (int i = 0; i < count && !reader.hasError(); ++i) {
+		T dto;
+		dto.fillFromBinaryCache(reader);
+		keys.insert((dto.*key)());
+	}
+	return keys;
+}
+
+CacheLoader::CacheLoader(QThread* targetThread, QObject *parent) :
+		QObject(parent), mTargetThread(targetThread), mBatchSize(1000), mLoadKunde(true), mLoadAuftrag(
+				true), mLoadSchlagwort(true)
+{
+}
+
+void CacheLoader::setBinaryCacheFiles(const QString& kundeFile, const QString& auftragFile,
+		const QString& schlagwortFile)
+{
+	mKundeBinaryFile = kundeFile;
+	mAuftragBinaryFile = auftragFile;
+	mSchlagwortBinaryFile = schlagwortFile;
+}
+
+void CacheLoader::setDatabaseFile(const QString& databaseFile)
+{
+	mDatabaseFile = databaseFile;
+}
+
+void CacheLoader::setJsonCacheFiles(const QString& auftragFile, const QString& schlagwortFile)
+{
+	mAuftragJsonFile = auftragFile;
+	mSchlagwortJsonFile = schlagwortFile;
+}
+
+void CacheLoader::setBatchSize(const int& batchSize)
+{
+	mBatchSize = qMax(1, batchSize);
+}
+
+void CacheLoader::setDtosToLoad(const bool& kunde, const bool& auftrag, const bool& schlagwort)
+{
+	mLoadKunde = kunde;
+	mLoadAuftrag = auftrag;
+	mLoadSchlagwort = schlagwort;
+}
+
+/*
+ * runs on the worker thread
+ * Kunde first: Auftrag can resolve auftraggeber while Auftrag are loading
+ * truncated snapshot: the complete records are already handed over,
+ * the rest is loaded from SQLite or JSON and <dto>Done() reports that source,
+ * so DataManager rewrites the snapshot
+ */
+void CacheLoader::load()
+{
+	QElapsedTimer elapsedTimer;
+	elapsedTimer.start();
+	if (mLoadKunde) {
+		if (mKundeBinaryFile.isEmpty() || !loadKundeFromBinaryCache()) {
+			loadKundeFromSqlCache();
+			emit kundeDone(SqlSource);
+		} else {
+			emit kundeDone(BinarySource);
+		}
+	}
+	if (mLoadAuftrag) {
+		if (!mAuftragBinaryFile.isEmpty() && loadAuftragFromBinaryCache()) {
+			emit auftragDone(BinarySource);
+		} else if (loadAuftragFromSqlCache()) {
+			emit auftragDone(SqlSource);
+		} else {
+			loadAuftragFromCacheStream();
+			emit auftragDone(JsonSource);
+		}
+	}
+	if (mLoadSchlagwort) {
+		if (mSchlagwortBinaryFile.isEmpty() || !loadSchlagwortFromBinaryCache()) {
+			loadSchlagwortFromCacheStream();
+			emit schlagwortDone(JsonSource);
+		} else {
+			emit schlagwortDone(BinarySource);
+		}
+	}
+	qDebug() << "CacheLoader finished in ms: " << elapsedTimer.elapsed();
+	emit finished();
+}
+
+/*
+ * objects were created on the worker thread without parent
+ * move them (and their children) to the thread of DataManager
+ * before DataManager gets them
+ */
+void CacheLoader::handOver(QList<QObject*>& batch)
+{
+	for (int i = 0; i < batch.size(); ++i) {
+		batch.at(i)->moveToThread(mTargetThread);
+	}
+}
+
+bool CacheLoader::loadKundeFromBinaryCache()
+{
+	BinaryCacheReader reader(mKundeBinaryFile);
+	if (!reader.open(BinaryCache::KundeType)) {
+		return false;
+	}
+	int total = reader.recordCount();
+	int loaded = 0;
+	QList<QObject*> batch;
+	batch.reserve(mBatchSize);
+	for (quint32 i = 0; i < reader.recordCount() && !reader.hasError(); ++i) {
+		Kunde* kunde = new Kunde();
+		kunde->fillFromBinaryCache(reader);
+		if (reader.hasError()) {
+			// half read: never handed over
+			delete kunde;
+			break;
+		}
+		batch.append(kunde);
+		loaded++;
+		if (batch.size() == mBatchSize) {
+			handOver(batch);
+			emit kundeLoaded(batch, total);
+			batch.clear();
+		}
+	}
+	if (!batch.isEmpty()) {
+		handOver(batch);
+		emit kundeLoaded(batch, total);
+	}
+	if (reader.hasError()) {
+		qWarning() << "binary cache Kunde is truncated - rest is loaded from the other caches";
+		mLoadedKundeNr = keysOfSnapshot<Kunde, int>(mKundeBinaryFile, BinaryCache::KundeType, loaded,
+				&Kunde::nr);
+		return false;
+	}
+	return true;
+}
+
+void CacheLoader::loadKundeFromSqlCache()
+{
+	{
+		QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+		database.setDatabaseName(mDatabaseFile);
+		if (!database.open()) {
+			qWarning() << "CacheLoader cannot open " << mDatabaseFile << ":"
+					<< database.lastError().text();
+		} else {
+			QSqlQuery query(database);
+			query.setForwardOnly(true);
+			int total = -1;
+			if (query.exec("SELECT COUNT(*) FROM kunde") && query.next()) {
+				total = query.value(0).toInt();
+			}
+			int schemaVersion = SqlRowDecoder::schemaVersion(database);
+			if (query.exec("SELECT * FROM kunde")) {
+				SqlRowDecoder rows(query);
+				Kunde::bindSqlColumns(rows, schemaVersion);
+				QList<QObject*> batch;
+				batch.reserve(mBatchSize);
+				while (rows.next()) {
+					Kunde* kunde = new Kunde();
+					kunde->fillFromSqlRow(rows);
+					if (mLoadedKundeNr.contains(kunde->nr())) {
+						// from the truncated snapshot
+						delete kunde;
+						continue;
+					}
+					batch.append(kunde);
+					if (batch.size() == mBatchSize) {
+						handOver(batch);
+						emit kundeLoaded(batch, total);
+						batch.clear();
+					}
+				}
+				if (!batch.isEmpty()) {
+					handOver(batch);
+					emit kundeLoaded(batch, total);
+				}
+			} else {
+				qDebug() << "NO SUCCESS query kunde";
+			}
+		}
+		database.close();
+	}
+	// database and query must be out of scope
+	QSqlDatabase::removeDatabase(connectionName);
+}
+
+bool CacheLoader::loadAuftragFromBinaryCache()
+{
+	BinaryCacheReader reader(mAuftragBinaryFile);
+	if (!reader.open(BinaryCache::AuftragType)) {
+		return false;
+	}
+	int total = reader.recordCount();
+	int loaded = 0;
+	QList<QObject*> batch;
+	batch.reserve(mBatchSize);
+	for (quint32 i = 0; i < reader.recordCount() && !reader.hasError(); ++i) {
+		Auftrag* auftrag = new Auftrag();
+		auftrag->fillFromBinaryCache(reader);
+		if (reader.hasError()) {
+			// half read: never handed over
+			delete auftrag;
+			break;
+		}
+		batch.append(auftrag);
+		loaded++;
+		if (batch.size() == mBatchSize) {
+			handOver(batch);
+			emit auftragLoaded(batch, total);
+			batch.clear();
+		}
+	}
+	if (!batch.isEmpty()) {
+		handOver(batch);
+		emit auftragLoaded(batch, total);
+	}
+	if (reader.hasError()) {
+		qWarning() << "binary cache Auftrag is truncated - rest is loaded from the other caches";
+		mLoadedAuftragNr = keysOfSnapshot<Auftrag, int>(mAuftragBinaryFile, BinaryCache::AuftragType, loaded,
+				&Auftrag::nr);
+		return false;
+	}
+	return true;
+}
+
+/*
+ * returns false if there are no auftrag tables in SQLite
+ */
+bool CacheLoader::loadAuftragFromSqlCache()
+{
+	bool loaded = false;
+	{
+		QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+		database.setDatabaseName(mDatabaseFile);
+		if (database.open()) {
+			AuftragSqlReader reader(database);
+			if (reader.open()) {
+				loaded = true;
+				int total = reader.count();
+				QList<QObject*> batch;
+				batch.reserve(mBatchSize);
+				Auftrag* auftrag;
+				while ((auftrag = reader.next()) != 0) {
+					if (mLoadedAuftragNr.contains(auftrag->nr())) {
+						// from the truncated snapshot
+						delete auftrag;
+						continue;
+					}
+					batch.append(auftrag);
+					if (batch.size() == mBatchSize) {
+						handOver(batch);
+						emit auftragLoaded(batch, total);
+						batch.clear();
+					}
+				}
+				if (!batch.isEmpty()) {
+					handOver(batch);
+					emit auftragLoaded(batch, total);
+				}
+			}
+		}
+		database.close();
+	}
+	// database and queries must be out of scope
+	QSqlDatabase::removeDatabase(connectionName);
+	return loaded;
+}
+
+/*
+ * number of Auftrag in JSON stream is unknown: total is -1
+ */
+void CacheLoader::loadAuftragFromCacheStream()
+{
+	QFile dataFile(mAuftragJsonFile);
+	if (!dataFile.open(QIODevice::ReadOnly)) {
+		qWarning() << "cannot open " << mAuftragJsonFile << ":" << dataFile.errorString();
+		return;
+	}
+	QIODevice* device = &dataFile;
+	CacheCodecDevice codecDevice(&dataFile);
+	if (CacheCodec::isCompressed(&dataFile)) {
+		if (!codecDevice.open(QIODevice::ReadOnly)) {
+			return;
+		}
+		device = &codecDevice;
+	}
+	JsonStreamReader reader(device);
+	if (reader.readNext() != JsonStreamReader::BeginArray) {
+		qWarning() << "no JSON Array found in " << mAuftragJsonFile;
+		return;
+	}
+	QList<QObject*> batch;
+	batch.reserve(mBatchSize);
+	while (reader.readNext() == JsonStreamReader::BeginObject) {
+		Auftrag* auftrag = new Auftrag();
+		auftrag->fillFromCacheStream(reader);
+		if (reader.hasError()) {
+			// half filled: never handed over
+			delete auftrag;
+			break;
+		}
+		if (mLoadedAuftragNr.contains(auftrag->nr())) {
+			// from the truncated snapshot
+			delete auftrag;
+			continue;
+		}
+		batch.append(auftrag);
+		if (batch.size() == mBatchSize) {
+			handOver(batch);
+			emit auftragLoaded(batch, -1);
+			batch.clear();
+		}
+	}
+	if (reader.hasError()) {
+		qWarning() << "error reading " << mAuftragJsonFile << ":" << reader.errorString();
+	}
+	if (!batch.isEmpty()) {
+		handOver(batch);
+		emit auftragLoaded(batch, -1);
+	}
+}
+
+bool CacheLoader::loadSchlagwortFromBinaryCache()
+{
+	BinaryCacheReader reader(mSchlagwortBinaryFile);
+	if (!reader.open(BinaryCache::SchlagwortType)) {
+		return false;
+	}
+	int total = reader.recordCount();
+	int loaded = 0;
+	QList<QObject*> batch;
+	batch.reserve(mBatchSize);
+	for (quint32 i = 0; i < reader.recordCount() && !reader.hasError(); ++i) {
+		Schlagwort* schlagwort = new Schlagwort();
+		schlagwort->fillFromBinaryCache(reader);
+		if (reader.hasError()) {
+			// half read: never handed over
+			delete schlagwort;
+			break;
+		}
+		batch.append(schlagwort);
+		loaded++;
+		if (batch.size() == mBatchSize) {
+			handOver(batch);
+			emit schlagwortLoaded(batch, total);
+			batch.clear();
+		}
+	}
+	if (!batch.isEmpty()) {
+		handOver(batch);
+		emit schlagwortLoaded(batch, total);
+	}
+	if (reader.hasError()) {
+		qWarning() << "binary cache Schlagwort is truncated - rest is loaded from the other caches";
+		mLoadedSchlagwortUuid = keysOfSnapshot<Schlagwort, UuidKey>(mSchlagwortBinaryFile, BinaryCache::SchlagwortType, loaded,
+				&Schlagwort::uuidAsKey);
+		return false;
+	}
+	return true;
+}
+
+void CacheLoader::loadSchlagwortFromCacheStream()
+{
+	if (!QFile::exists(mSchlagwortJsonFile)) {
+		return;
+	}
+	QFile dataFile(mSchlagwortJsonFile);
+	if (!dataFile.open(QIODevice::ReadOnly)) {
+		qWarning() << "cannot open " << mSchlagwortJsonFile << ":" << dataFile.errorString();
+		return;
+	}
+	QIODevice* device = &dataFile;
+	CacheCodecDevice codecDevice(&dataFile);
+	if (CacheCodec::isCompressed(&dataFile)) {
+		if (!codecDevice.open(QIODevice::ReadOnly)) {
+			return;
+		}
+		device = &codecDevice;
+	}
+	// streamed: number of Schlagwort is unknown
+	JsonStreamReader reader(device);
+	if (reader.readNext() != JsonStreamReader::BeginArray) {
+		qWarning() << "no JSON Array found in " << mSchlagwortJsonFile;
+		return;
+	}
+	QList<QObject*> batch;
+	batch.reserve(mBatchSize);
+	while (reader.readNext() == JsonStreamReader::BeginObject) {
+		Schlagwort* schlagwort = new Schlagwort();
+		schlagwort->fillFromCacheStream(reader);
+		if (reader.hasError()) {
+			// half filled: never handed over
+			delete schlagwort;
+			break;
+		}
+		if (mLoadedSchlagwortUuid.contains(schlagwort->uuidAsKey())) {
+			// from the truncated snapshot
+			delete schlagwort;
+			continue;
+		}
+		batch.append(schlagwort);
+		if (batch.size() == mBatchSize) {
+			handOver(batch);
+			emit schlagwortLoaded(batch, -1);
+			batch.clear();
+		}
+	}
+	if (reader.hasError()) {
+		qWarning() << "error reading " << mSchlagwortJsonFile << ":" << reader.errorString();
+	}
+	if (!batch.isEmpty()) {
+		handOver(batch);
+		emit schlagwortLoaded(batch, -1);
+	}
+}
+
+CacheLoader::~CacheLoader()
+{
+	// clean up
+}
@@ -0,0 +1,41 @@
+#include "CacheRecords.hpp"
+
+// same layout as Kunde::toBinaryCache()
+void KundeRecord::toBinaryCache(BinaryCacheWriter& writer) const
+{
+	writer.writeInt(nr);
+	writer.writeString(name);
+	writer.writeString(ort);
+}
+// record storage: ort is interned by DataManager
+void KundeRecord::fillFromBinaryCache(BinaryCacheReader& reader)
+{
+	nr = reader.readInt();
+	name = reader.readString();
+	ort = reader.readString();
+}
+
+// same layout as Position::toBinaryCache()
+void PositionRecord::toBinaryCache(BinaryCacheWriter& writer) const
+{
+	writer.writeUuid(uuid);
+	writer.writeString(bezeichnung);
+	writer.writeDouble(preis);
+}
+
+// same layout as Auftrag::toBinaryCache()
+void AuftragRecord::toBinaryCache(BinaryCacheWriter& writer) const
+{
+	writer.writeInt(nr);
+	writer.writeDate(datum);
+	writer.writeString(bemerkung);
+	writer.writeInt(auftraggeber);
+	writer.writeCount(positionen.size());
+	for (int i = 0; i < positionen.size(); ++i) {
+		positionen.at(i).toBinaryCache(writer);
+	}
+	writer.writeCount(tags.size());
+	for (int i = 0; i < tags.size(); ++i) {
+		writer.writeUuid(tags.at(i));
+	}
+}
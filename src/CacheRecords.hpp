@@ -0,0 +1,54 @@
+#ifndef CACHERECORDS_HPP_
+#define CACHERECORDS_HPP_
+
+#include <QString>
+#include <QDate>
+#include <QList>
+
+#include "UuidKey.hpp"
+#include "BinaryCache.hpp"
+
+/*
+ * immutable value copies of the DTOs
+ * taken on the UI thread (cheap: QString and QList are implicitly shared)
+ * and written to the binary snapshot on a worker thread (SnapshotWriter)
+ * without touching the QObject DTOs
+ *
+ * toBinaryCache() writes the same layout as the DTO,
+ * so snapshots are read with <dto>::fillFromBinaryCache()
+ *
+ * KundeRecord is also the storage of Kunde without QObject
+ * (DataManager::setKundeRecordStorage())
+ */
+struct KundeRecord
+{
+	int nr;
+	QString name;
+	QString ort;
+
+	void toBinaryCache(BinaryCacheWriter& writer) const;
+	void fillFromBinaryCache(BinaryCacheReader& reader);
+};
+
+struct PositionRecord
+{
+	UuidKey uuid;
+	QString bezeichnung;
+	double preis;
+
+	void toBinaryCache(BinaryCacheWriter& writer) const;
+};
+
+struct AuftragRecord
+{
+	int nr;
+	QDate datum;
+	QString bemerkung;
+	int auftraggeber;
+	QList<PositionRecord> positionen;
+	QList<UuidKey> tags;
+
+	void toBinaryCache(BinaryCacheWriter& writer) const;
+};
+
+#endif /* CACHERECORDS_HPP_ */
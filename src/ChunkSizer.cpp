@@ -0,0 +1,64 @@
+#include "ChunkSizer.hpp"
+#include <QDebug>
+
+const int ChunkSizer::minChunkSize = 100;
+const int ChunkSizer::maxChunkSize = 100000;
+
+ChunkSizer::ChunkSizer(const int& initialSize, const bool& adaptive, const int& minLatencyMs,
+		const int& maxLatencyMs) :
+		mChunkSize(qMax(1, initialSize)), mAdaptive(adaptive), mMinLatencyMs(minLatencyMs), mMaxLatencyMs(
+				qMax(minLatencyMs, maxLatencyMs)), mChunks(0), mRows(0), mTotalMs(0), mMaxChunkLatencyMs(
+				0), mSmallestChunk(0), mLargestChunk(0)
+{
+	if (mAdaptive) {
+		mChunkSize = qBound(minChunkSize, mChunkSize, maxChunkSize);
+	}
+}
+
+int ChunkSizer::chunkSize() const
+{
+	return mChunkSize;
+}
+
+void ChunkSizer::chunkDone(const int& rows, const qint64& latencyMs)
+{
+	mChunks++;
+	mRows += rows;
+	mTotalMs += latencyMs;
+	mMaxChunkLatencyMs = qMax(mMaxChunkLatencyMs, latencyMs);
+	if (mChunks == 1) {
+		mSmallestChunk = rows;
+		mLargestChunk = rows;
+	} else {
+		mSmallestChunk = qMin(mSmallestChunk, rows);
+		mLargestChunk = qMax(mLargestChunk, rows);
+	}
+	if (!mAdaptive || rows < mChunkSize) {
+		// fixed or last (smaller) chunk: nothing to learn
+		return;
+	}
+	if (latencyMs >= mMinLatencyMs && latencyMs <= mMaxLatencyMs) {
+		return;
+	}
+	// rows per ms of this chunk -> rows for the middle of the bounds
+	qint64 targetMs = (mMinLatencyMs + mMaxLatencyMs) / 2;
+	qint64 nextSize = rows * targetMs / qMax(Q_INT64_C(1), latencyMs);
+	nextSize = qBound((qint64) mChunkSize / 2, nextSize, (qint64) mChunkSize * 2);
+	mChunkSize = qBound(minChunkSize, (int) nextSize, maxChunkSize);
+	qDebug() << "chunk latency ms: " << latencyMs << " next chunk size: " << mChunkSize;
+}
+
+QVariantMap ChunkSizer::stats() const
+{
+	QVariantMap statsMap;
+	statsMap.insert("adaptive", mAdaptive);
+	statsMap.insert("chunks", mChunks);
+	statsMap.insert("rows", mRows);
+	statsMap.insert("totalMs", mTotalMs);
+	statsMap.insert("maxChunkMs", mMaxChunkLatencyMs);
+	statsMap.insert("rowsPerSecond", mTotalMs > 0 ? (qint64) mRows * 1000 / mTotalMs : 0);
+	statsMap.insert("smallestChunk", mSmallestChunk);
+	statsMap.insert("largestChunk", mLargestChunk);
+	statsMap.insert("lastChunkSize", mChunkSize);
+	return statsMap;
+}
@@ -0,0 +1,46 @@
+#ifndef CHUNKSIZER_HPP_
+#define CHUNKSIZER_HPP_
+
+#include <QtGlobal>
+#include <QVariantMap>
+
+/*
+ * chunk size for bulk imports into SQLite
+ * one chunk is one transaction
+ *
+ * fixed: always the initial chunk size (setChunkSize())
+ * adaptive: rows per second of the last chunk are measured
+ * and the next chunk is sized to take the middle of the latency bounds
+ * growth and shrink per step are limited to factor 2 - no oscillation
+ *
+ * statistics are reported by DataManager::chunkStats()
+ */
+class ChunkSizer
+{
+public:
+	ChunkSizer(const int& initialSize, const bool& adaptive, const int& minLatencyMs,
+			const int& maxLatencyMs);
+
+	int chunkSize() const;
+	// measured after COMMIT
+	void chunkDone(const int& rows, const qint64& latencyMs);
+
+	QVariantMap stats() const;
+
+	static const int minChunkSize;
+	static const int maxChunkSize;
+
+private:
+	int mChunkSize;
+	bool mAdaptive;
+	int mMinLatencyMs;
+	int mMaxLatencyMs;
+	int mChunks;
+	int mRows;
+	qint64 mTotalMs;
+	qint64 mMaxChunkLatencyMs;
+	int mSmallestChunk;
+	int mLargestChunk;
+};
+
+#endif /* CHUNKSIZER_HPP_ */
@@ -3,11 +3,21 @@
 
 #include <qobject.h>
 #include <QtSql/QtSql>
+#include <QElapsedTimer>
+#include <QPointer>
 
 #include "Kunde.hpp"
 #include "Auftrag.hpp"
 #include "Position.hpp"
 #include "Schlagwort.hpp"
+#include "TagIndex.hpp"
+#include "SqlStatementCache.hpp"
+
+class CacheLoader;
+class WalCheckpointer;
+class SnapshotWriter;
+class KundePager;
+class CacheCodecDevice;
 
 class DataManager: public QObject
 {
@@ -19,11 +29,28 @@ Q_PROPERTY(QDeclarativeListProperty<Auftrag> auftragPropertyList READ auftragPro
 Q_PROPERTY(QDeclarativeListProperty<Schlagwort> schlagwortPropertyList READ schlagwortPropertyList CONSTANT)
 
 public:
+	// RollbackJournalDurability (default): journal_mode DELETE, synchronous FULL
+	//    bulk imports switch to MEMORY / OFF
+	// WalDurability: journal_mode WAL, synchronous NORMAL
+	//    checkpoints run on a worker thread
+	enum DurabilityProfile {
+		RollbackJournalDurability, WalDurability
+	};
+
     DataManager(QObject *parent = 0);
     virtual ~DataManager();
     Q_INVOKABLE
     void init();
 
+    // loads the caches on a worker thread
+    // progress: <dto>InitProgress(), completion: <dto>InitDone() and initDone()
+    // loaded DTOs are available immediately
+    Q_INVOKABLE
+    void initAsync();
+
+    Q_INVOKABLE
+    bool isInitRunning();
+
 	
 	Q_INVOKABLE
 	void fillKundeDataModel(QString objectName);
@@ -40,6 +67,8 @@ public:
 	Q_INVOKABLE
 	QList<Kunde*> listOfKundeForKeys(QStringList keyList);
 
+	QList<Kunde*> resolveKundeKeys(const QList<int>& keys, QList<int>& missingKeys);
+
 	Q_INVOKABLE
 	QVariantList kundeAsQVariantList();
 
@@ -64,14 +93,31 @@ public:
 	Q_INVOKABLE
 	void insertKundeFromMap(const QVariantMap& kundeMap, const bool& useForeignProperties);
 
+	// constant time: the last Kunde takes the place of the deleted one,
+	// so the order of allKunde() is not kept
 	Q_INVOKABLE
 	bool deleteKunde(Kunde* kunde);
 
 	Q_INVOKABLE
 	bool deleteKundeByNr(const int& nr);
 
+	// lazy Kunde: a Kunde* returned by findKundeByNr(), findKundeByOrt() or
+	// listOfKundeForKeys() stays valid until control returns to the event loop
+	// kept longer while bound in QML or between retainKunde() and releaseKunde()
+	// anything else must hold it as QPointer: it may be evicted (deleteLater)
 	Q_INVOKABLE
     Kunde* findKundeByNr(const int& nr);
+
+	// counted: each retainKunde() needs one releaseKunde()
+	Q_INVOKABLE
+	void retainKunde(Kunde* kunde);
+
+	Q_INVOKABLE
+	void releaseKunde(Kunde* kunde);
+
+	// ort is interned: compared by shared buffer, not char by char
+	Q_INVOKABLE
+	QList<QObject*> findKundeByOrt(const QString& ort);
 	
 	Q_INVOKABLE
 	void fillAuftragDataModel(QString objectName);
@@ -94,6 +140,8 @@ public:
 	Q_INVOKABLE
 	QList<Auftrag*> listOfAuftragForKeys(QStringList keyList);
 
+	QList<Auftrag*> resolveAuftragKeys(const QList<int>& keys, QList<int>& missingKeys);
+
 	Q_INVOKABLE
 	QVariantList auftragAsQVariantList();
 
@@ -118,6 +166,8 @@ public:
 	Q_INVOKABLE
 	void insertAuftragFromMap(const QVariantMap& auftragMap, const bool& useForeignProperties);
 
+	// constant time: the last Auftrag takes the place of the deleted one,
+	// so the order of allAuftrag() is not kept
 	Q_INVOKABLE
 	bool deleteAuftrag(Auftrag* auftrag);
 
@@ -126,6 +176,19 @@ public:
 
 	Q_INVOKABLE
     Auftrag* findAuftragByNr(const int& nr);
+
+	// all Auftrag where auftraggeber is the Kunde with this nr
+	Q_INVOKABLE
+	QList<QObject*> listOfAuftragForAuftraggeber(const int& nr);
+
+	// filter Auftrag by tags (Schlagwort uuids) using the inverted tag index
+	// allOfTags: AND, anyOfTags: OR, noneOfTags: NOT
+	Q_INVOKABLE
+	QList<QObject*> listOfAuftragForTags(const QStringList& allOfTags,
+			const QStringList& anyOfTags, const QStringList& noneOfTags);
+
+	QList<Auftrag*> listOfAuftragForTagKeys(const QList<UuidKey>& allOfTags,
+			const QList<UuidKey>& anyOfTags, const QList<UuidKey>& noneOfTags);
 	
 	Q_INVOKABLE
 	void fillSchlagwortDataModel(QString objectName);
@@ -142,6 +205,8 @@ public:
 	Q_INVOKABLE
 	QList<Schlagwort*> listOfSchlagwortForKeys(QStringList keyList);
 
+	QList<Schlagwort*> resolveSchlagwortKeys(const QList<UuidKey>& keys, QList<UuidKey>& missingKeys);
+
 	Q_INVOKABLE
 	QVariantList schlagwortAsQVariantList();
 
@@ -175,13 +240,167 @@ public:
 	Q_INVOKABLE
 	Schlagwort* findSchlagwortByUuid(const QString& uuid);
 
+	Schlagwort* findSchlagwortByUuidKey(const UuidKey& uuid);
+
 	Q_INVOKABLE
 	void setChunkSize(const int& newChunkSize);
 
+	// adaptive: chunk size follows the measured latency per transaction
+	// setChunkSize() is the size of the first chunk
+	Q_INVOKABLE
+	void setAdaptiveChunkSize(const bool& adaptive);
+
+	// adaptive: target latency per chunk (default 50 - 200 ms)
+	Q_INVOKABLE
+	void setChunkLatencyBounds(const int& minLatencyMs, const int& maxLatencyMs);
+
+	// statistics of the last bulk import into SQLite
+	Q_INVOKABLE
+	QVariantMap chunkStats();
+
+	// true (default): JSON caches are parsed and written as token stream
+	// false: JsonDataAccess loads and saves a QVariantList of QVariantMap
+	Q_INVOKABLE
+	void setStreamingJsonCache(const bool& streaming);
+
+	// true (default): caches are loaded from and saved to binary snapshots
+	// JSON is only used if there's no snapshot yet (import)
+	Q_INVOKABLE
+	void setBinaryCache(const bool& binary);
+
+	// 2PhaseInit: number of most recent Auftrag loaded in phase one
+	Q_INVOKABLE
+	void setAuftragPriorityCount(const int& priorityCount);
+
+	// true (default): SQLite caches are synchronized incrementally (UPSERT / DELETE)
+	// false: tables are rebuilt at exit
+	Q_INVOKABLE
+	void setIncrementalSqlSync(const bool& incremental);
+
+	// DurabilityProfile - must be set before init() or initAsync()
+	Q_INVOKABLE
+	void setDurabilityProfile(const int& profile);
+
+	// WalDurability: interval of background checkpoints (default 5000 ms)
+	Q_INVOKABLE
+	void setWalCheckpointInterval(const int& intervalMs);
+
+	// WalDurability: runs a checkpoint on the worker thread now
+	Q_INVOKABLE
+	void checkpointWal();
+
+	// WalDurability: current size of the WAL file
+	Q_INVOKABLE
+	int walSizeKb();
+
+	// JSON caches: CacheCodec::Codec - PlainCodec (default), ZlibFastCodec, ZlibBestCodec
+	// compressed or plain caches are always detected on read
+	Q_INVOKABLE
+	void setCacheCodec(const int& codec);
+
+	// size and time of all codecs for the current Auftrag* - see qDebug log
+	Q_INVOKABLE
+	QVariantList benchmarkCacheCodecs();
+
+	// lazy: only the keys of table kunde are loaded at init
+	// Kunde* are read page by page and evicted above the budget (least recently used)
+	// kundePropertyList and findKundeByNr() work as before
+	// allKunde() and fillKundeDataModel() read all pages and stop the eviction
+	// SQLite cache only: not used with binary snapshots - call before init()
+	Q_INVOKABLE
+	void setLazyKunde(const bool& lazy);
+
+	// max Kunde* in memory (dirty Kunde* and Kunde* handed out and still bound in QML are never evicted)
+	Q_INVOKABLE
+	void setLazyKundeBudget(const int& maxKunde);
+
+	Q_INVOKABLE
+	QVariantMap lazyKundeStats();
+
+	// record storage: all Kunde as KundeRecord (no QObject)
+	// Kunde* are created page by page like lazy Kunde and evicted above the budget
+	// works with binary snapshots, SQLite and JSON - call before init()
+	// lazy Kunde (SQLite) is used if both are set
+	Q_INVOKABLE
+	void setKundeRecordStorage(const bool& recordStorage);
+
+	// interned Strings: distinct values and bytes saved per property
+	Q_INVOKABLE
+	QVariantList stringPoolStats();
+
+	// removes interned values no longer used - per ex. after deleting many DTOs
+	Q_INVOKABLE
+	void purgeStringPools();
+
+	// creates and deletes count Position* from heap and from ObjectPool
+	// allocations per second and heap in use - see qDebug log
+	Q_INVOKABLE
+	QVariantMap benchmarkPositionAllocation(const int& count);
+
+	// rows per second of table kunde: QVariant values vs SqlRowDecoder - see qDebug log
+	Q_INVOKABLE
+	QVariantMap benchmarkSqlDecoding(const int& rounds);
+
+	// objects per second parsed from JSON cache data of each DTO:
+	// fillFromCacheMap() (JsonDataAccess) vs fillFromCacheStream() - see qDebug log
+	Q_INVOKABLE
+	QVariantMap benchmarkJsonParsing(const int& rounds);
+
+	// lookups per second of auftraggeber and tags of all Auftrag*:
+	// primary key index vs linear scan of mAllKunde / mAllSchlagwort
+	// sizes: ns per lookup for 1k - 500k synthetic keys - see qDebug log
+	Q_INVOKABLE
+	QVariantMap benchmarkReferenceResolution(const int& rounds);
+
+	// periodic saveInBackground(), 0: no autosave (default)
+	Q_INVOKABLE
+	void setAutosaveInterval(const int& intervalMs);
+
+	// exit: max time to wait for the background save (default 3000 ms)
+	// if exceeded a journal is written
+	Q_INVOKABLE
+	void setSaveTimeout(const int& timeoutMs);
+
+	// binary snapshot: changes of Auftrag are appended to a journal
+	// until it reaches the limit (default 512 kB), then a full snapshot is written
+	// 0: always full snapshot
+	Q_INVOKABLE
+	void setAuftragJournalLimit(const int& limitKb);
+
+	// folds the Auftrag journal into a new snapshot (background save)
+	Q_INVOKABLE
+	void compactAuftragJournal();
+
+	// rebuilds the SQLite caches and VACUUMs the database
+	Q_INVOKABLE
+	bool compactSqlCache();
+
+	// dirty tracking: true if finish() would write something
+	Q_INVOKABLE
+	bool hasUnsavedChanges();
+
+	// JSON import / export of all caches
+	Q_INVOKABLE
+	void exportCacheToJson();
+
+	Q_INVOKABLE
+	void importCacheFromJson();
+
     void initKundeFromCache();
+    void initKundeFromCacheStream();
     void initKundeFromSqlCache();
     void initAuftragFromCache();
+    void initAuftragFromCacheMap();
+    void initAuftragFromCacheStream();
+    bool initAuftragFromSqlCache();
     void initSchlagwortFromCache();
+    void initSchlagwortFromCacheStream();
+    // plain or compressed JSON cache as device for JsonStreamReader - 0 if no cache
+    QIODevice* openCacheStream(QString& fileName, QFile& dataFile, CacheCodecDevice& codecDevice);
+    bool initKundeFromBinaryCache();
+    bool initAuftragFromBinaryCache();
+    bool initSchlagwortFromBinaryCache();
+    bool initAuftragPriorityFromBinaryCache();
 
 Q_SIGNALS:
 
@@ -194,15 +413,93 @@ Q_SIGNALS:
 	void addedToAllSchlagwort(Schlagwort* schlagwort);
 	void deletedFromAllSchlagwortByUuid(QString uuid);
 	void deletedFromAllSchlagwort(Schlagwort* schlagwort);
+	// initAsync(): total is -1 if not known
+	void kundeInitProgress(int loaded, int total);
+	void kundeInitDone();
+	void auftragInitProgress(int loaded, int total);
+	void auftragInitDone();
+	void schlagwortInitProgress(int loaded, int total);
+	void schlagwortInitDone();
+	void initDone();
+	// WalDurability: emitted after each background checkpoint
+	void walCheckpointDone(int latencyMs, int walSizeKb);
+	// saveInBackground(): false if a snapshot couldn't be written
+	void backgroundSaveDone(bool success);
     
 public slots:
     void onManualExit();
+    // saves dirty snapshots on a worker thread
+    void saveInBackground();
+
+private slots:
+    void onKundeNrChanged(int nr);
+    void onAuftragNrChanged(int nr);
+    void onKundeChanged();
+    void onAuftragChanged();
+    void onWalCheckpointDone(int latencyMs, qint64 walSize, int walFrames, int checkpointedFrames);
+    void onSnapshotThreadFinished();
+    void onKundePinsExpired();
+    void onAuftragAuftraggeberChanged(int auftraggeber);
+    void onAuftragTagsChanged();
+    void onSchlagwortUuidChanged(QString uuid);
+    // initAsync(): batches from CacheLoader
+    void onKundeLoaded(QList<QObject*> kundeBatch, int total);
+    void onKundeLoadDone(int source);
+    void onAuftragLoaded(QList<QObject*> auftragBatch, int total);
+    void onAuftragLoadDone(int source);
+    void onSchlagwortLoaded(QList<QObject*> schlagwortBatch, int total);
+    void onSchlagwortLoadDone(int source);
+    void onCacheLoaderFinished();
 
 private:
 
 	// DataObject stored in List of QObject*
 	// GroupDataModel only supports QObject*
     QList<QObject*> mAllKunde;
+    // primary key index: domainKey nr -> Kunde*
+    QHash<int, Kunde*> mKundeByNr;
+    // position in mAllKunde: deleted Kunde* are replaced by the last one
+    QHash<Kunde*, int> mKundePosition;
+    bool removeFromAllKunde(Kunde* kunde);
+    void indexKunde(Kunde* kunde);
+    void unindexKunde(Kunde* kunde);
+    // lazy Kunde: key index and pages from SQLite
+    bool mLazyKunde;
+    int mLazyKundeBudget;
+    KundePager* mKundePager;
+    int mEvictedKunde;
+    // allKunde() handed out every Kunde*: no eviction
+    bool mAllKundeHandedOut;
+    // Kunde* returned to QML or callers: not evicted while observed
+    QSet<Kunde*> mHandedOutKunde;
+    // handed out in the current event loop turn: never evicted
+    QSet<Kunde*> mPinnedKunde;
+    // retainKunde() count
+    QHash<Kunde*, int> mRetainedKunde;
+    // > 0 while a result list is built: pages are read, nothing is evicted
+    int mKundeEvictionSuspended;
+    void handOutKunde(Kunde* kunde);
+    void evictKundeAboveBudget();
+    bool openLazyKunde();
+    // record storage: KundeRecord in mKundePager
+    bool mKundeRecordStorage;
+    bool openKundeRecords();
+    bool isKundeOnlyInSqlCache();
+    void appendKunde(Kunde* kunde);
+    Kunde* kundeAt(const int& pos);
+    void materializeKundePage(const int& page);
+    void evictKunde();
+    // dirty tracking: changed or inserted, deleted keys
+    // outdated: cache must be rewritten completely
+    QSet<Kunde*> mDirtyKunde;
+    QSet<int> mDeletedKundeNr;
+    bool mKundeCacheOutdated;
+    void markKundeDeleted(Kunde* kunde);
+    void markAllKundeDeleted();
+    bool isKundeCacheDirty();
+    void clearKundeDirtyState();
+    void restoreKundeDirtyState(const QSet<Kunde*>& dirtyKunde, const QSet<int>& deletedKundeNr,
+            const bool& outdated);
     // implementation for QDeclarativeListProperty to use
     // QML functions for List of All Kunde*
     static void appendToKundeProperty(
@@ -215,6 +512,33 @@ private:
     static void clearKundeProperty(
     	QDeclarativeListProperty<Kunde> *kundeList);
     QList<QObject*> mAllAuftrag;
+    // primary key index: domainKey nr -> Auftrag*
+    QHash<int, Auftrag*> mAuftragByNr;
+    // position in mAllAuftrag: deleted Auftrag* are replaced by the last one
+    QHash<Auftrag*, int> mAuftragPosition;
+    bool removeFromAllAuftrag(Auftrag* auftrag);
+    void indexAuftrag(Auftrag* auftrag);
+    void unindexAuftrag(Auftrag* auftrag);
+    // dirty tracking: changed or inserted, deleted keys
+    // outdated: cache must be rewritten completely
+    QSet<Auftrag*> mDirtyAuftrag;
+    QSet<int> mDeletedAuftragNr;
+    bool mAuftragCacheOutdated;
+    bool mResolvingReferences;
+    void markAuftragDeleted(Auftrag* auftrag);
+    void markAllAuftragDeleted();
+    bool isAuftragCacheDirty();
+    void clearAuftragDirtyState();
+    void restoreAuftragDirtyState(const QSet<Auftrag*>& dirtyAuftrag,
+            const QSet<int>& deletedAuftragNr, const bool& outdated);
+    // reverse index: Kunde nr -> Auftrag* (auftraggeber)
+    QMultiHash<int, Auftrag*> mAuftragByAuftraggeber;
+    // auftraggeber each Auftrag* is indexed with
+    QHash<Auftrag*, int> mIndexedAuftraggeber;
+    // inverted index: Schlagwort uuid -> Auftrag* (tags)
+    TagIndex mTagIndex;
+    void clearAuftragIndex();
+    void invalidateAuftraggeberReferences(Kunde* kunde);
     // implementation for QDeclarativeListProperty to use
     // QML functions for List of All Auftrag*
     static void appendToAuftragProperty(
@@ -227,6 +551,10 @@ private:
     static void clearAuftragProperty(
     	QDeclarativeListProperty<Auftrag> *auftragList);
     QList<QObject*> mAllSchlagwort;
+    // primary key index: domainKey uuid -> Schlagwort*
+    QHash<UuidKey, Schlagwort*> mSchlagwortByUuid;
+    void indexSchlagwort(Schlagwort* schlagwort);
+    void unindexSchlagwort(Schlagwort* schlagwort);
     // implementation for QDeclarativeListProperty to use
     // QML functions for List of All Schlagwort*
     static void appendToSchlagwortProperty(
@@ -239,21 +567,93 @@ private:
     static void clearSchlagwortProperty(
     	QDeclarativeListProperty<Schlagwort> *schlagwortList);
 
-    void saveKundeToCache();
-    	void saveKundeToSqlCache();
-    void saveAuftragToCache();
+    bool saveKundeToCache();
+    bool saveKundeToCacheStream();
+    	bool saveKundeToSqlCache();
+    bool saveKundeDeltaToSqlCache(const QSet<Kunde*>& dirtyKunde, const QSet<int>& deletedKundeNr,
+            const bool& outdated);
+    bool saveAuftragToCache();
+    bool saveAuftragToCacheStream();
+    bool saveAuftragToSqlCache();
+    bool saveAuftragDeltaToSqlCache(const QSet<Auftrag*>& dirtyAuftrag,
+            const QSet<int>& deletedAuftragNr, const bool& outdated);
+    bool isPositionTableOutdated();
+    bool insertAuftragIntoSqlCache(const QList<AuftragRecord>& records, const int& fromPos,
+            const int& toPos, const QString& insertSQL, const QString& insertPositionSQL,
+            const QString& insertTagsSQL);
     void saveSchlagwortToCache();
+    bool saveSchlagwortToCacheStream();
+    void saveSchlagwortToBinaryCache();
+    // background save
+    SnapshotWriter* mSnapshotWriter;
+    QThread* mSnapshotThread;
+    bool mSnapshotPending;
+    int mSaveTimeoutMs;
+    QTimer* mAutosaveTimer;
+    QList<KundeRecord> kundeRecords();
+    QList<KundeRecord> dirtyKundeRecords();
+    QList<AuftragRecord> auftragRecords();
+    QList<AuftragRecord> auftragPriorityRecords();
+    void startSnapshotSave();
+    void snapshotSaveDone();
+    bool waitForSnapshotSave();
+    void abandonSnapshotWriter();
+    void saveSnapshotsAtExit();
+    void recoverSnapshotJournal();
+    bool promoteSnapshotJournal(const QString& fileName);
+    // Auftrag journal
+    int mAuftragJournalLimitKb;
+    bool useAuftragJournal();
+    quint32 auftragSnapshotGeneration();
+    QList<int> deletedAuftragNrs();
+    QList<AuftragRecord> dirtyAuftragRecords();
+    void replayAuftragJournal();
 
 // S Q L
 	QSqlDatabase mDatabase;
     bool mDatabaseAvailable;
     bool initDatabase();
     void bulkImport(const bool& tuneJournalAndSync);
+    SqlStatementCache mStatements;
+    QVariant execPragma(const QString& pragma, bool& success);
+    QString syncModeName(const QVariant& syncMode);
+    bool mIncrementalSqlSync;
+    bool mSqlUpsertSupported;
+    bool isSqlUpsertSupported();
+    bool deleteKeysFromSqlCache(const QString (*deleteCommand)(const int&), const QVariantList& keys);
+    int mDurabilityProfile;
+    int mWalCheckpointInterval;
+    WalCheckpointer* mWalCheckpointer;
+    QThread* mWalCheckpointerThread;
+    void applyDurabilityProfile();
+    void startWalCheckpointer();
+    void stopWalCheckpointer();
     int mChunkSize;
-
+    bool mAdaptiveChunkSize;
+    int mChunkMinLatencyMs;
+    int mChunkMaxLatencyMs;
+    bool mSqlImportRunning;
+    QVariantMap mChunkStats;
+    void yieldBetweenChunks();
+
+	bool mStreamingJsonCache;
+	bool mBinaryCache;
+	bool mInitRunning;
+	QElapsedTimer mInitElapsedTimer;
+	// deleted (deleteLater) when loading is finished
+	QPointer<QThread> mCacheLoaderThread;
+	void startCacheLoader(CacheLoader* cacheLoader);
+	void waitForCacheLoader();
+	// 2PhaseInit
+	bool mAuftragPhaseTwo;
+	int mAuftragPriorityCount;
+	void startAuftragPhaseTwo();
+	bool prepareCacheFile(QString& fileName);
 	QVariantList readFromCache(QString& fileName);
-	void writeToCache(QString& fileName, QVariantList& data);
+	bool writeToCache(QString& fileName, QVariantList& data);
+	int mCacheCodec;
 	void finish();
+	void saveCaches();
 };
 
 #endif /* DATAMANAGER_HPP_ */
@@ -0,0 +1,115 @@
+#ifndef JSONSTREAMREADER_HPP_
+#define JSONSTREAMREADER_HPP_
+
+#include <QIODevice>
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/*
+ * property names of one DTO, precomputed as UTF-8
+ * names are matched against the bytes read by JsonStreamReader,
+ * so no QString is created for a name
+ * index is the position in keys - DTOs switch on it
+ */
+class JsonKeyTable
+{
+public:
+	JsonKeyTable(const QStringList& keys);
+
+	// -1: unknown name
+	int indexOf(const char* name, const int& size) const;
+
+private:
+	QVector<QByteArray> mKeys;
+	// length and first byte: only equal tags are compared
+	QVector<quint32> mTags;
+};
+
+/*
+ * pull parser (SAX-style) for JSON (UTF-8)
+ * reads the device in chunks and delivers one token at a time
+ * DTOs fill their members directly from the tokens,
+ * so no QVariantList / QVariantMap tree is built
+ *
+ * usage: position the reader at BeginObject, then
+ * while (reader.readNext() == JsonStreamReader::Name) {
+ *     name = reader.stringValue(); reader.readNext(); ... value ...
+ * }
+ * unknown values are skipped with skipValue()
+ * DTOs use nameIndex() with a JsonKeyTable instead of stringValue()
+ */
+class JsonStreamReader
+{
+public:
+	enum TokenType {
+		NoToken,
+		BeginObject,
+		EndObject,
+		BeginArray,
+		EndArray,
+		Name,
+		String,
+		Number,
+		Bool,
+		Null,
+		EndDocument,
+		Invalid
+	};
+
+	JsonStreamReader(QIODevice* device);
+
+	TokenType readNext();
+	TokenType tokenType() const;
+
+	// Name or String
+	const QString& stringValue() const;
+	// Name: index in keys or -1
+	int nameIndex(const JsonKeyTable& keys) const;
+	double numberValue() const;
+	int intValue() const;
+	bool boolValue() const;
+
+	// current token is first token of a value: skip the complete value
+	void skipValue();
+
+	bool hasError() const;
+	QString errorString() const;
+
+private:
+	QIODevice* mDevice;
+	QByteArray mBuffer;
+	int mPos;
+	bool mAtEnd;
+
+	TokenType mTokenType;
+	// decoded from mScratch on first access
+	mutable QString mString;
+	mutable bool mStringDecoded;
+	QByteArray mScratch;
+	double mNumber;
+	bool mBool;
+
+	// '{' or '[' for each open container
+	QVector<char> mContainers;
+	bool mExpectName;
+	// separator expected before the next token: 0, ',' or ':'
+	// '$' if the document is complete
+	char mSeparator;
+	QString mError;
+
+	bool fill();
+	int peekChar();
+	int nextChar();
+	bool readString();
+	bool readNumber(int firstChar);
+	bool readLiteral(const char* rest);
+	bool readHex4(uint& codeUnit);
+	void appendUtf8(uint codePoint);
+	void valueCompleted();
+	TokenType failSeparator();
+	TokenType fail(const QString& error);
+};
+
+#endif /* JSONSTREAMREADER_HPP_ */
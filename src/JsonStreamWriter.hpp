@@ -0,0 +1,65 @@
+#ifndef JSONSTREAMWRITER_HPP_
+#define JSONSTREAMWRITER_HPP_
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+#include "CacheCodec.hpp"
+
+/*
+ * writes a JSON cache (UTF-8) token by token
+ * counterpart of JsonStreamReader: DTOs write their members directly,
+ * so no QVariantList / QVariantMap tree of the whole cache is built
+ * output is buffered and written in chunks - compressed block by block
+ * (CacheCodecDevice) if a codec is set
+ *
+ * written to <filePath>.tmp - only commit() replaces the existing cache
+ * ',' and ':' are inserted by the writer
+ */
+class JsonStreamWriter
+{
+public:
+	JsonStreamWriter(const QString& filePath, const CacheCodec::Codec& codec);
+	~JsonStreamWriter();
+
+	bool open();
+
+	void beginArray();
+	void endArray();
+	void beginObject();
+	void endObject();
+
+	void writeName(const QString& name);
+	void writeString(const QString& value);
+	void writeInt(const int& value);
+	void writeDouble(const double& value);
+	void writeBool(const bool& value);
+	void writeNull();
+
+	// flush, sync and rename - false if anything failed
+	bool commit();
+	bool hasError() const;
+
+private:
+	QString mFilePath;
+	QFile mFile;
+	CacheCodecDevice mCodecDevice;
+	CacheCodec::Codec mCodec;
+	QIODevice* mDevice;
+	QByteArray mBuffer;
+	// one entry for each open container: true until the first value
+	QVector<bool> mFirstValue;
+	bool mAfterName;
+	bool mFailed;
+
+	void separate();
+	void valueWritten();
+	void appendEscaped(const QString& value);
+	void flushBuffer();
+
+	Q_DISABLE_COPY (JsonStreamWriter)
+};
+
+#endif /* JSONSTREAMWRITER_HPP_ */
@@ -6,6 +6,13 @@
 #include <QtSql/QSqlQuery>
 #include <QtSql/QSqlRecord>
 
+#include "BinaryCache.hpp"
+#include "CacheRecords.hpp"
+#include "SqlRowDecoder.hpp"
+#include "StringPool.hpp"
+#include "JsonStreamReader.hpp"
+#include "JsonStreamWriter.hpp"
+
 
 
 
@@ -25,6 +32,7 @@ public:
 	void fillFromMap(const QVariantMap& kundeMap);
 	void fillFromForeignMap(const QVariantMap& kundeMap);
 	void fillFromCacheMap(const QVariantMap& kundeMap);
+	void fillFromCacheStream(JsonStreamReader& reader);
 	
 	void prepareNew();
 	
@@ -34,6 +42,7 @@ public:
 	QVariantMap toMap();
 	QVariantMap toForeignMap();
 	QVariantMap toCacheMap();
+	void toCacheStream(JsonStreamWriter& writer);
 
 	int nr() const;
 	void setNr(int nr);
@@ -41,15 +50,37 @@ public:
 	void setName(QString name);
 	QString ort() const;
 	void setOrt(QString ort);
+	// interned ort values
+	static StringPool& ortPool();
 
 
 	// SQL
 	static const QString createTableCommand();
 	static const QString createParameterizedInsertNameBinding();
 	static const QString createParameterizedInsertPosBinding();
+	static const QString createParameterizedInsertOrReplacePosBinding();
+	static const QString createParameterizedUpsertPosBinding();
+	static const QString createParameterizedDeleteByKeys(const int& keyCount);
 	void toSqlCache(QVariantList& nrList, QVariantList& nameList, QVariantList& ortList);
 	void fillFromSqlQuery(const QSqlQuery& sqlQuery);
 	static void fillSqlQueryPos(const QSqlRecord& record);
+	// typed: column positions bound once per schema version
+	static void bindSqlColumns(SqlRowDecoder& decoder, const int& schemaVersion);
+	void fillFromSqlRow(const SqlRowDecoder& decoder);
+
+	// binary snapshot
+	void toBinaryCache(BinaryCacheWriter& writer);
+	KundeRecord toRecord() const;
+	// record storage: Kunde* created on demand
+	void fillFromRecord(const KundeRecord& record);
+	static KundeRecord recordFromSqlRow(const SqlRowDecoder& decoder);
+	static KundeRecord recordFromCacheMap(const QVariantMap& kundeMap);
+	static QVariantMap cacheMapFromRecord(const KundeRecord& record);
+	static void recordToCacheStream(const KundeRecord& record, JsonStreamWriter& writer);
+	void fillFromBinaryCache(BinaryCacheReader& reader);
+
+	// lazy Kunde: evicted only if not observed
+	bool isObserved() const;
 
 	virtual ~Kunde();
 
@@ -0,0 +1,220 @@
+#include "KundePager.hpp"
+#include <QDebug>
+
+#include <QElapsedTimer>
+#include <QPair>
+#include <QtSql/QSqlError>
+#include <algorithm>
+
+#include "Kunde.hpp"
+#include "SqlRowDecoder.hpp"
+
+const int KundePager::pageSize = 50;
+
+KundePager::KundePager(SqlStatementCache& statements, const QSqlDatabase& database) :
+		mStatements(statements), mDatabase(database), mSchemaVersion(-1), mRecordStorage(false), mTick(0), mPagesLoaded(0)
+{
+}
+
+static bool lessByNr(const KundeRecord& record, const KundeRecord& other)
+{
+	return record.nr < other.nr;
+}
+
+bool KundePager::open()
+{
+	mKeys.clear();
+	mLastUse.clear();
+	mRecordStorage = false;
+	mRecords.clear();
+	if (!mDatabase.tables().contains("kunde")) {
+		return false;
+	}
+	QElapsedTimer elapsedTimer;
+	elapsedTimer.start();
+	mSchemaVersion = SqlRowDecoder::schemaVersion(mDatabase);
+	QSqlQuery countQuery(mDatabase);
+	if (countQuery.exec("SELECT COUNT(*) FROM kunde") && countQuery.next()) {
+		mKeys.reserve(countQuery.value(0).toInt());
+	}
+	countQuery.finish();
+	QSqlQuery& query = mStatements.prepared("SELECT nr FROM kunde ORDER BY nr");
+	if (!query.exec()) {
+		qWarning() << "NO SUCCESS query keys kunde " << query.lastError().text();
+		return false;
+	}
+	SqlRowDecoder rows(query);
+	while (rows.next()) {
+		mKeys.append(rows.intValue(0));
+	}
+	query.finish();
+	qDebug() << "Kunde keys #" << mKeys.size() << " in ms: " << elapsedTimer.elapsed();
+	return true;
+}
+
+void KundePager::openRecords(QVector<KundeRecord>& records)
+{
+	std::sort(records.begin(), records.end(), lessByNr);
+	mRecords = records;
+	records.clear();
+	mRecordStorage = true;
+	mLastUse.clear();
+	mKeys.clear();
+	mKeys.reserve(mRecords.size());
+	for (int i = 0; i < mRecords.size(); ++i) {
+		mKeys.append(mRecords.at(i).nr);
+	}
+}
+
+bool KundePager::hasRecords() const
+{
+	return mRecordStorage;
+}
+
+void KundePager::storeRecord(const KundeRecord& record)
+{
+	int pos = positionOf(record.nr);
+	if (pos >= 0 && mRecordStorage) {
+		mRecords[pos] = record;
+	}
+}
+
+QList<KundeRecord> KundePager::records() const
+{
+	return mRecords.toList();
+}
+
+int KundePager::count() const
+{
+	return mKeys.size();
+}
+
+int KundePager::keyAt(const int& pos) const
+{
+	return mKeys.at(pos);
+}
+
+int KundePager::positionOf(const int& nr) const
+{
+	QVector<int>::const_iterator it = qLowerBound(mKeys.constBegin(), mKeys.constEnd(), nr);
+	if (it == mKeys.constEnd() || *it != nr) {
+		return -1;
+	}
+	return it - mKeys.constBegin();
+}
+
+bool KundePager::containsKey(const int& nr) const
+{
+	return positionOf(nr) >= 0;
+}
+
+void KundePager::insertKey(const int& nr)
+{
+	QVector<int>::iterator it = qLowerBound(mKeys.begin(), mKeys.end(), nr);
+	if (it != mKeys.end() && *it == nr) {
+		return;
+	}
+	if (mRecordStorage) {
+		// values are stored when the Kunde* is evicted or saved
+		KundeRecord record;
+		record.nr = nr;
+		mRecords.insert(it - mKeys.begin(), record);
+	}
+	mKeys.insert(it, nr);
+}
+
+bool KundePager::removeKey(const int& nr)
+{
+	int pos = positionOf(nr);
+	if (pos < 0) {
+		return false;
+	}
+	mKeys.remove(pos);
+	if (mRecordStorage) {
+		mRecords.remove(pos);
+	}
+	return true;
+}
+
+QVector<int> KundePager::keys() const
+{
+	return mKeys;
+}
+
+void KundePager::clearKeys()
+{
+	mKeys.clear();
+	mRecords.clear();
+	mLastUse.clear();
+}
+
+QList<Kunde*> KundePager::loadPage(const int& page)
+{
+	QList<Kunde*> kundeList;
+	int fromPos = page * pageSize;
+	if (page < 0 || fromPos >= mKeys.size()) {
+		return kundeList;
+	}
+	int toPos = qMin(fromPos + pageSize, mKeys.size()) - 1;
+	if (mRecordStorage) {
+		for (int i = fromPos; i <= toPos; ++i) {
+			Kunde* kunde = new Kunde();
+			kunde->fillFromRecord(mRecords.at(i));
+			kundeList.append(kunde);
+		}
+		mPagesLoaded++;
+		return kundeList;
+	}
+	QSqlQuery& query = mStatements.prepared(
+			"SELECT * FROM kunde WHERE nr >= ? AND nr <= ? ORDER BY nr");
+	query.bindValue(0, mKeys.at(fromPos));
+	query.bindValue(1, mKeys.at(toPos));
+	if (!query.exec()) {
+		qWarning() << "NO SUCCESS query page kunde " << query.lastError().text();
+		return kundeList;
+	}
+	SqlRowDecoder rows(query);
+	Kunde::bindSqlColumns(rows, mSchemaVersion);
+	while (rows.next()) {
+		Kunde* kunde = new Kunde();
+		kunde->fillFromSqlRow(rows);
+		kundeList.append(kunde);
+	}
+	query.finish();
+	mPagesLoaded++;
+	return kundeList;
+}
+
+void KundePager::touch(const int& nr)
+{
+	mLastUse.insert(nr, ++mTick);
+}
+
+void KundePager::forget(const int& nr)
+{
+	mLastUse.remove(nr);
+}
+
+QList<int> KundePager::leastRecentlyUsed(const int& count, const QSet<int>& pinned) const
+{
+	QVector<QPair<quint32, int> > byLastUse;
+	byLastUse.reserve(mLastUse.size());
+	QHash<int, quint32>::const_iterator it;
+	for (it = mLastUse.constBegin(); it != mLastUse.constEnd(); ++it) {
+		if (!pinned.contains(it.key())) {
+			byLastUse.append(qMakePair(it.value(), it.key()));
+		}
+	}
+	int resultSize = qMin(count, byLastUse.size());
+	std::partial_sort(byLastUse.begin(), byLastUse.begin() + resultSize, byLastUse.end());
+	QList<int> keys;
+	for (int i = 0; i < resultSize; ++i) {
+		keys.append(byLastUse.at(i).second);
+	}
+	return keys;
+}
+
+int KundePager::pagesLoaded() const
+{
+	return mPagesLoaded;
+}
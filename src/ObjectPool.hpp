@@ -0,0 +1,57 @@
+#ifndef OBJECTPOOL_HPP_
+#define OBJECTPOOL_HPP_
+
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QVariantMap>
+#include <stddef.h>
+
+/*
+ * memory for DTOs created in bulk while loading (Position)
+ * used by class specific operator new / delete
+ *
+ * objects of one size are cut from slabs (objectsPerSlab per malloc)
+ * released objects go to a free list and are used again
+ * so deleting an Auftrag (and its Positionen) doesn't fragment the heap
+ *
+ * only the memory comes from the pool - QObject construction is unchanged
+ * (children are deleted by the parent as before)
+ *
+ * UI thread and CacheLoader allocate: guarded by a mutex
+ */
+class ObjectPool
+{
+public:
+	ObjectPool(const QString& name, const size_t& objectSize, const int& objectsPerSlab);
+	~ObjectPool();
+
+	void* allocate();
+	void release(void* object);
+	// frees all slabs if no object is in use
+	bool trim();
+
+	QVariantMap stats();
+
+private:
+	struct FreeObject
+	{
+		FreeObject* next;
+	};
+
+	QString mName;
+	size_t mObjectSize;
+	int mObjectsPerSlab;
+	QList<char*> mSlabs;
+	FreeObject* mFreeList;
+	int mInUse;
+	int mPeakInUse;
+	qint64 mAllocations;
+	QMutex mMutex;
+
+	void addSlab();
+
+	Q_DISABLE_COPY (ObjectPool)
+};
+
+#endif /* OBJECTPOOL_HPP_ */
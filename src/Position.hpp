@@ -3,6 +3,17 @@
 
 #include <QObject>
 #include <qvariant.h>
+#include <QtSql/QSqlQuery>
+#include <QtSql/QSqlRecord>
+
+#include "UuidKey.hpp"
+#include "BinaryCache.hpp"
+#include "CacheRecords.hpp"
+#include "SqlRowDecoder.hpp"
+#include "StringPool.hpp"
+#include "ObjectPool.hpp"
+#include "JsonStreamReader.hpp"
+#include "JsonStreamWriter.hpp"
 
 
 // forward declaration to avoid circular dependencies
@@ -26,6 +37,29 @@ public:
 	void fillFromMap(const QVariantMap& positionMap);
 	void fillFromForeignMap(const QVariantMap& positionMap);
 	void fillFromCacheMap(const QVariantMap& positionMap);
+	void fillFromCacheStream(JsonStreamReader& reader);
+
+	// SQL - Position is stored in table position with
+	// key of auftragsKopf (auftrag_nr) and index inside positionen (pos_index)
+	static const QString createTableCommand();
+	static bool isOutdatedTableCommand(const QString& tableSQL);
+	static const QString createParameterizedInsertPosBinding();
+	static const QString createParameterizedDeleteByAuftragNrs(const int& keyCount);
+	static void toSqlCache(const PositionRecord& record, const int& auftragNr, const int& posIndex,
+			QVariantList& uuidList, QVariantList& auftragNrList, QVariantList& posIndexList,
+			QVariantList& bezeichnungList, QVariantList& preisList);
+	void fillFromSqlQuery(const QSqlQuery& sqlQuery);
+	static void fillSqlQueryPos(const QSqlRecord& record);
+	static void bindSqlColumns(SqlRowDecoder& decoder, const int& schemaVersion);
+	void fillFromSqlRow(const SqlRowDecoder& decoder);
+	// column of auftrag_nr for SqlRowDecoder::intValue()
+	static int auftragNrSqlColumn();
+
+	// binary snapshot
+	void toBinaryCache(BinaryCacheWriter& writer);
+	PositionRecord toRecord() const;
+	void fillFromRecord(const PositionRecord& record);
+	void fillFromBinaryCache(BinaryCacheReader& reader);
 	
 	void prepareNew();
 	
@@ -35,11 +69,17 @@ public:
 	QVariantMap toMap();
 	QVariantMap toForeignMap();
 	QVariantMap toCacheMap();
+	void toCacheStream(JsonStreamWriter& writer);
 
 	QString uuid() const;
 	void setUuid(QString uuid);
+	// binary DomainKey - uuid() as String only for QML and foreign APIs
+	UuidKey uuidAsKey() const;
+	void setUuidAsKey(const UuidKey& uuid);
 	QString bezeichnung() const;
 	void setBezeichnung(QString bezeichnung);
+	// interned bezeichnung values
+	static StringPool& bezeichnungPool();
 	double preis() const;
 	void setPreis(double preis);
 	Auftrag* auftragsKopf() const;
@@ -49,6 +89,11 @@ public:
 
 	virtual ~Position();
 
+	// memory from ObjectPool - Positionen are created in bulk while loading
+	static void* operator new(size_t size);
+	static void operator delete(void* object, size_t size);
+	static ObjectPool& allocationPool();
+
 	Q_SIGNALS:
 
 	void uuidChanged(QString uuid);
@@ -59,10 +104,11 @@ public:
 
 private:
 
-	QString mUuid;
+	UuidKey mUuid;
 	QString mBezeichnung;
 	double mPreis;
 	// no MEMBER mAuftragsKopf it's the parent
+	void notifyAuftragsKopf();
 
 	Q_DISABLE_COPY (Position)
 };
@@ -0,0 +1,92 @@
+#ifndef SNAPSHOTWRITER_HPP_
+#define SNAPSHOTWRITER_HPP_
+
+#include <QObject>
+#include <QList>
+#include <QAtomicInt>
+
+#include "CacheRecords.hpp"
+
+/*
+ * writes binary snapshots from value records on a worker thread
+ * used by DataManager::saveInBackground() and at exit
+ *
+ * DataManager takes the records (cheap copies) on the UI thread,
+ * SnapshotWriter serializes and fsyncs them - the event loop keeps running
+ * Kunde delta: only the changed records are taken,
+ * SnapshotWriter merges them into the existing snapshot
+ * save() can also be called directly (fallback journal at exit)
+ * abort() stops writing snapshots from another thread - the old ones stay
+ */
+class SnapshotWriter: public QObject
+{
+	Q_OBJECT
+
+public:
+	SnapshotWriter(QObject *parent = 0);
+	virtual ~SnapshotWriter();
+
+	// only the snapshots with records set are written
+	void setKundeRecords(const QString& kundeFile, const QList<KundeRecord>& records);
+	// changed or inserted records replace or extend the snapshot, deleted keys are removed
+	// not saved if there's no valid snapshot to merge with
+	void setKundeDelta(const QString& kundeFile, const QList<int>& deletedNrs,
+			const QList<KundeRecord>& records);
+	void setAuftragRecords(const QString& auftragFile, const QList<AuftragRecord>& records);
+	// 2PhaseInit priority snapshot, written together with Auftrag
+	void setAuftragPriorityRecords(const QString& priorityFile,
+			const QList<AuftragRecord>& records);
+	// full Auftrag snapshot: generation of the new snapshot
+	// the journal of the old snapshot is removed if the snapshot was written
+	void setAuftragGeneration(const quint32& generation, const QString& obsoleteJournalFile);
+	// instead of a full snapshot: changes are appended to the Auftrag journal
+	// deleted keys first, then the changed or inserted records
+	void setAuftragJournalRecords(const QString& journalFile, const quint32& generation,
+			const QList<int>& deletedNrs, const QList<AuftragRecord>& records);
+
+	bool hasKunde() const;
+	bool hasAuftrag() const;
+	// results - valid after save() or finished()
+	bool kundeSaved() const;
+	bool auftragSaved() const;
+
+	// thread safe: snapshots not committed yet are not written
+	// entries not yet appended to the Auftrag journal are skipped
+	// a running fsync can't be interrupted
+	void abort();
+
+public slots:
+	void save();
+
+Q_SIGNALS:
+	void finished();
+
+private:
+	QString mKundeFile;
+	QList<KundeRecord> mKundeRecords;
+	bool mHasKunde;
+	bool mKundeSaved;
+	bool mKundeDelta;
+	QList<int> mKundeDeletedNrs;
+	QString mAuftragFile;
+	QList<AuftragRecord> mAuftragRecords;
+	bool mHasAuftrag;
+	bool mAuftragSaved;
+	QString mAuftragPriorityFile;
+	QList<AuftragRecord> mAuftragPriorityRecords;
+	quint32 mAuftragGeneration;
+	QString mAuftragJournalFile;
+	bool mAppendAuftragJournal;
+	QList<int> mAuftragDeletedNrs;
+	QAtomicInt mAborted;
+
+	bool isAborted() const;
+
+	bool saveKundeSnapshot();
+	bool mergeKundeDelta();
+	bool saveAuftragSnapshot();
+	void saveAuftragPriority();
+	bool appendAuftragJournal();
+};
+
+#endif /* SNAPSHOTWRITER_HPP_ */
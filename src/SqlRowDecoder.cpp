@@ -0,0 +1,244 @@
+#include "SqlRowDecoder.hpp"
+#include <QDebug>
+
+#include <QMutexLocker>
+#include <QtSql/QSqlDriver>
+#include <QtSql/QSqlResult>
+#include <sqlite3.h>
+
+SqlColumnBinding::SqlColumnBinding(const QStringList& columns) :
+		mColumns(columns), mSchemaVersion(-1), mBound(false)
+{
+}
+
+QVector<int> SqlColumnBinding::positions(const QSqlRecord& record, const int& schemaVersion)
+{
+	QMutexLocker locker(&mMutex);
+	// unknown schema version (-1): always looked up
+	if (mBound && schemaVersion >= 0 && schemaVersion == mSchemaVersion) {
+		return mPositions;
+	}
+	mPositions.resize(mColumns.size());
+	for (int i = 0; i < mColumns.size(); ++i) {
+		mPositions[i] = record.indexOf(mColumns.at(i));
+		if (mPositions.at(i) < 0) {
+			qWarning() << "column not found: " << mColumns.at(i);
+		}
+	}
+	mSchemaVersion = schemaVersion;
+	mBound = true;
+	return mPositions;
+}
+
+// D E C O D E R
+
+/*
+ * the sqlite3_stmt belongs to the SQLite of the QSQLITE plugin
+ * sqlite3_step() / _column_*() are from the SQLite linked to the app (-lsqlite3)
+ * only safe if both are the same library version:
+ * checked once with SELECT sqlite_version() - otherwise QSqlQuery::value()
+ */
+static QMutex sLibraryMutex;
+static int sLibraryChecked = -1;
+
+static int versionNumber(const QString& version)
+{
+	// 3.8.10.2 -> 3008010 (as SQLITE_VERSION_NUMBER)
+	QStringList parts = version.split('.');
+	if (parts.size() < 3) {
+		return -1;
+	}
+	return parts.at(0).toInt() * 1000000 + parts.at(1).toInt() * 1000 + parts.at(2).toInt();
+}
+
+static bool isLinkedLibrary(const QSqlQuery& query)
+{
+	QMutexLocker locker(&sLibraryMutex);
+	if (sLibraryChecked >= 0) {
+		return sLibraryChecked == 1;
+	}
+	QSqlQuery versionQuery(query.driver()->createResult());
+	int pluginVersion = -1;
+	if (versionQuery.exec("SELECT sqlite_version()") && versionQuery.next()) {
+		pluginVersion = versionNumber(versionQuery.value(0).toString());
+	}
+	versionQuery.finish();
+	sLibraryChecked = pluginVersion == sqlite3_libversion_number() ? 1 : 0;
+	if (!sLibraryChecked) {
+		qWarning() << "SQLite of QSQLITE " << pluginVersion << " linked "
+				<< sqlite3_libversion_number() << " - rows read with QSqlQuery::value()";
+	}
+	return sLibraryChecked == 1;
+}
+
+static sqlite3_stmt* statementHandle(const QSqlQuery& query)
+{
+	if (!query.isActive() || !query.isForwardOnly() || query.at() != QSql::BeforeFirstRow) {
+		return 0;
+	}
+	QVariant handle = query.result()->handle();
+	if (!handle.isValid() || qstrcmp(handle.typeName(), "sqlite3_stmt*") != 0) {
+		return 0;
+	}
+	if (!isLinkedLibrary(query)) {
+		return 0;
+	}
+	return *static_cast<sqlite3_stmt* const *>(handle.data());
+}
+
+SqlRowDecoder::SqlRowDecoder(QSqlQuery& query) :
+		mQuery(query), mStatement(statementHandle(query)), mFirstRowPending(false), mDone(
+				false), mRows(0)
+{
+	if (mStatement) {
+		// exec() of QSQLITE already has stepped to the first row (if any)
+		mFirstRowPending = sqlite3_data_count(mStatement) > 0;
+		mDone = !mFirstRowPending;
+	}
+}
+
+void SqlRowDecoder::bind(SqlColumnBinding& binding, const int& schemaVersion)
+{
+	mPositions = binding.positions(mQuery.record(), schemaVersion);
+}
+
+bool SqlRowDecoder::next()
+{
+	if (!mStatement) {
+		if (mQuery.next()) {
+			mRows++;
+			return true;
+		}
+		return false;
+	}
+	if (mDone) {
+		// never step again after SQLITE_DONE: SQLite would run the statement again
+		return false;
+	}
+	if (mFirstRowPending) {
+		mFirstRowPending = false;
+		mRows++;
+		return true;
+	}
+	int result = sqlite3_step(mStatement);
+	if (result == SQLITE_ROW) {
+		mRows++;
+		return true;
+	}
+	if (result != SQLITE_DONE) {
+		qWarning() << "sqlite3_step failed: " << result;
+	}
+	mDone = true;
+	return false;
+}
+
+int SqlRowDecoder::rows() const
+{
+	return mRows;
+}
+
+bool SqlRowDecoder::isNative() const
+{
+	return mStatement != 0;
+}
+
+int SqlRowDecoder::position(const int& column) const
+{
+	if (mPositions.isEmpty()) {
+		return column;
+	}
+	return mPositions.at(column);
+}
+
+bool SqlRowDecoder::isNull(const int& column) const
+{
+	if (mStatement) {
+		return sqlite3_column_type(mStatement, position(column)) == SQLITE_NULL;
+	}
+	return mQuery.value(position(column)).isNull();
+}
+
+int SqlRowDecoder::intValue(const int& column) const
+{
+	if (mStatement) {
+		return sqlite3_column_int(mStatement, position(column));
+	}
+	return mQuery.value(position(column)).toInt();
+}
+
+double SqlRowDecoder::doubleValue(const int& column) const
+{
+	if (mStatement) {
+		return sqlite3_column_double(mStatement, position(column));
+	}
+	return mQuery.value(position(column)).toDouble();
+}
+
+QString SqlRowDecoder::stringValue(const int& column) const
+{
+	if (mStatement) {
+		int pos = position(column);
+		const void* text = sqlite3_column_text16(mStatement, pos);
+		if (!text) {
+			return QString();
+		}
+		return QString(reinterpret_cast<const QChar*>(text),
+				sqlite3_column_bytes16(mStatement, pos) / sizeof(QChar));
+	}
+	return mQuery.value(position(column)).toString();
+}
+
+QByteArray SqlRowDecoder::blobValue(const int& column) const
+{
+	if (mStatement) {
+		int pos = position(column);
+		const void* blob = sqlite3_column_blob(mStatement, pos);
+		if (!blob) {
+			return QByteArray();
+		}
+		return QByteArray(static_cast<const char*>(blob), sqlite3_column_bytes(mStatement, pos));
+	}
+	return mQuery.value(position(column)).toByteArray();
+}
+
+static inline bool isDigit(const char& c)
+{
+	return c >= '0' && c <= '9';
+}
+
+QDate SqlRowDecoder::dateValue(const int& column) const
+{
+	if (!mStatement) {
+		QVariant value = mQuery.value(position(column));
+		if (value.isNull()) {
+			return QDate();
+		}
+		return QDate::fromString(value.toString(), "yyyy-MM-dd");
+	}
+	int pos = position(column);
+	const char* text = reinterpret_cast<const char*>(sqlite3_column_text(mStatement, pos));
+	if (!text) {
+		return QDate();
+	}
+	int length = sqlite3_column_bytes(mStatement, pos);
+	// yyyy-MM-dd: digits at 0..3, 5..6, 8..9
+	if (length == 10 && text[4] == '-' && text[7] == '-' && isDigit(text[0]) && isDigit(text[1])
+			&& isDigit(text[2]) && isDigit(text[3]) && isDigit(text[5]) && isDigit(text[6])
+			&& isDigit(text[8]) && isDigit(text[9])) {
+		int year = (text[0] - '0') * 1000 + (text[1] - '0') * 100 + (text[2] - '0') * 10
+				+ (text[3] - '0');
+		int month = (text[5] - '0') * 10 + (text[6] - '0');
+		int day = (text[8] - '0') * 10 + (text[9] - '0');
+		return QDate(year, month, day);
+	}
+	return QDate::fromString(QString::fromUtf8(text, length), "yyyy-MM-dd");
+}
+
+int SqlRowDecoder::schemaVersion(const QSqlDatabase& database)
+{
+	QSqlQuery query(database);
+	if (query.exec("PRAGMA schema_version") && query.next()) {
+		return query.value(0).toInt();
+	}
+	return -1;
+}
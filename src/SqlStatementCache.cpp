@@ -0,0 +1,65 @@
+#include "SqlStatementCache.hpp"
+#include <QDebug>
+
+#include <QtSql/QSqlError>
+
+SqlStatementCache::SqlStatementCache() :
+		mHits(0), mMisses(0)
+{
+}
+
+SqlStatementCache::~SqlStatementCache()
+{
+	clear();
+}
+
+void SqlStatementCache::setDatabase(const QSqlDatabase& database)
+{
+	clear();
+	mDatabase = database;
+}
+
+QSqlQuery& SqlStatementCache::prepared(const QString& sql)
+{
+	QHash<QString, QSqlQuery>::iterator it = mQueries.find(sql);
+	if (it != mQueries.end()) {
+		mHits++;
+		// reset the statement, keep it prepared
+		it.value().finish();
+		return it.value();
+	}
+	mMisses++;
+	QSqlQuery query(mDatabase);
+	query.setForwardOnly(true);
+	if (!query.prepare(sql)) {
+		// per ex. table doesn't exist yet: not cached, prepared again next time
+		qWarning() << "NO SUCCESS prepare " << sql << query.lastError().text();
+		mFailedQuery = query;
+		return mFailedQuery;
+	}
+	return mQueries.insert(sql, query).value();
+}
+
+void SqlStatementCache::finishAll()
+{
+	QHash<QString, QSqlQuery>::iterator it;
+	for (it = mQueries.begin(); it != mQueries.end(); ++it) {
+		it.value().finish();
+	}
+}
+
+void SqlStatementCache::clear()
+{
+	mQueries.clear();
+	mFailedQuery = QSqlQuery();
+}
+
+int SqlStatementCache::hits() const
+{
+	return mHits;
+}
+
+int SqlStatementCache::misses() const
+{
+	return mMisses;
+}
@@ -0,0 +1,46 @@
+#ifndef SQLSTATEMENTCACHE_HPP_
+#define SQLSTATEMENTCACHE_HPP_
+
+#include <QHash>
+#include <QString>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
+
+/*
+ * prepared statements of one connection, keyed by SQL
+ * each statement is parsed by SQLite only once
+ *
+ * SQL comes from the DTOs (create...() - built once per DTO type)
+ * queries are forward only
+ * bind values by index (bindValue(0, ...)): addBindValue() doesn't
+ * start at 0 again after execBatch()
+ *
+ * finishAll() before DROP TABLE or VACUUM: active statements lock the tables
+ */
+class SqlStatementCache
+{
+public:
+	SqlStatementCache();
+	~SqlStatementCache();
+
+	// removes all statements of the old connection
+	void setDatabase(const QSqlDatabase& database);
+	// finished and ready to bind - prepared at first use
+	QSqlQuery& prepared(const QString& sql);
+	void finishAll();
+	void clear();
+
+	int hits() const;
+	int misses() const;
+
+private:
+	QSqlDatabase mDatabase;
+	QHash<QString, QSqlQuery> mQueries;
+	QSqlQuery mFailedQuery;
+	int mHits;
+	int mMisses;
+
+	Q_DISABLE_COPY (SqlStatementCache)
+};
+
+#endif /* SQLSTATEMENTCACHE_HPP_ */
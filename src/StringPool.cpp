@@ -0,0 +1,77 @@
+#include "StringPool.hpp"
+#include <QDebug>
+
+#include <QMutexLocker>
+
+// QString::Data header (Qt 4, 32 bit) + malloc overhead
+static const int bufferOverhead = 32;
+
+static qint64 bufferBytes(const QString& value)
+{
+	return bufferOverhead + (qint64) value.capacity() * sizeof(QChar);
+}
+
+StringPool::StringPool(const QString& name) :
+		mName(name), mLookups(0), mShared(0), mSavedBytes(0)
+{
+}
+
+QString StringPool::intern(const QString& value)
+{
+	if (value.isEmpty()) {
+		// shared null / empty - nothing to save
+		return value;
+	}
+	QMutexLocker locker(&mMutex);
+	mLookups++;
+	QSet<QString>::const_iterator it = mValues.constFind(value);
+	if (it == mValues.constEnd()) {
+		mValues.insert(value);
+		return value;
+	}
+	if (it->constData() != value.constData()) {
+		mShared++;
+		mSavedBytes += bufferBytes(value);
+	}
+	return *it;
+}
+
+bool StringPool::isSame(const QString& value, const QString& other)
+{
+	// empty values are not pooled
+	return value.constData() == other.constData() || (value.isEmpty() && other.isEmpty());
+}
+
+int StringPool::purge()
+{
+	QMutexLocker locker(&mMutex);
+	int removed = 0;
+	QMutableSetIterator<QString> it(mValues);
+	while (it.hasNext()) {
+		// only referenced by the pool
+		if (it.next().isDetached()) {
+			it.remove();
+			removed++;
+		}
+	}
+	qDebug() << "StringPool " << mName << " purged #" << removed << " values #" << mValues.size();
+	return removed;
+}
+
+QVariantMap StringPool::stats()
+{
+	QMutexLocker locker(&mMutex);
+	qint64 pooledBytes = 0;
+	QSetIterator<QString> it(mValues);
+	while (it.hasNext()) {
+		pooledBytes += bufferBytes(it.next());
+	}
+	QVariantMap statsMap;
+	statsMap.insert("name", mName);
+	statsMap.insert("distinct", mValues.size());
+	statsMap.insert("lookups", mLookups);
+	statsMap.insert("shared", mShared);
+	statsMap.insert("pooledBytes", pooledBytes);
+	statsMap.insert("savedBytes", mSavedBytes);
+	return statsMap;
+}
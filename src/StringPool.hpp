@@ -0,0 +1,48 @@
+#ifndef STRINGPOOL_HPP_
+#define STRINGPOOL_HPP_
+
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QVariantMap>
+
+/*
+ * interning of String properties with few distinct values
+ * (Kunde ort, Position bezeichnung, Schlagwort text)
+ *
+ * intern() returns the pooled QString if an equal one exists:
+ * all DTOs share one implicitly shared buffer per value
+ * the buffer of the loaded value is freed
+ *
+ * interned values can be compared by buffer (isSame()) -
+ * per ex. filters comparing all Kunde with one ort
+ *
+ * used from UI thread and CacheLoader: guarded by a mutex
+ * QString reference counting is atomic
+ */
+class StringPool
+{
+public:
+	StringPool(const QString& name);
+
+	QString intern(const QString& value);
+	// both values interned by the same pool
+	static bool isSame(const QString& value, const QString& other);
+
+	// removes values no DTO is using anymore
+	int purge();
+	// distinct values, lookups and estimated bytes saved
+	QVariantMap stats();
+
+private:
+	QString mName;
+	QSet<QString> mValues;
+	int mLookups;
+	int mShared;
+	qint64 mSavedBytes;
+	QMutex mMutex;
+
+	Q_DISABLE_COPY (StringPool)
+};
+
+#endif /* STRINGPOOL_HPP_ */
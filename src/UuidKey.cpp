@@ -0,0 +1,192 @@
+#include "UuidKey.hpp"
+#include <QDebug>
+#include <quuid.h>
+
+static const char hexDigits[] = "0123456789abcdef";
+
+static int hexValue(const ushort c)
+{
+	if (c >= '0' && c <= '9') {
+		return c - '0';
+	}
+	if (c >= 'a' && c <= 'f') {
+		return c - 'a' + 10;
+	}
+	if (c >= 'A' && c <= 'F') {
+		return c - 'A' + 10;
+	}
+	return -1;
+}
+
+/*
+ * Default Constructor creates a null UuidKey
+ */
+UuidKey::UuidKey() :
+		mHigh(0), mLow(0)
+{
+}
+
+UuidKey::UuidKey(quint64 high, quint64 low) :
+		mHigh(high), mLow(low)
+{
+}
+
+/*
+ * creates a new random UUID
+ * takes the binary fields from QUuid - no String conversion
+ */
+UuidKey UuidKey::createUuid()
+{
+	QUuid uuid = QUuid::createUuid();
+	quint64 high = (quint64(uuid.data1) << 32) | (quint64(uuid.data2) << 16) | quint64(uuid.data3);
+	quint64 low = 0;
+	for (int i = 0; i < 8; ++i) {
+		low = (low << 8) | uuid.data4[i];
+	}
+	return UuidKey(high, low);
+}
+
+/*
+ * parses 8-4-4-4-12 hex digits
+ * braces and hyphens are optional
+ * invalid Strings return a null UuidKey
+ */
+UuidKey UuidKey::fromString(const QString& uuidString)
+{
+	quint64 high = 0;
+	quint64 low = 0;
+	int digits = 0;
+	const QChar* data = uuidString.constData();
+	const int length = uuidString.length();
+	for (int i = 0; i < length; ++i) {
+		const ushort c = data[i].unicode();
+		if (c == '-' || c == '{' || c == '}') {
+			continue;
+		}
+		int value = hexValue(c);
+		if (value < 0 || digits == 32) {
+			return UuidKey();
+		}
+		if (digits < 16) {
+			high = (high << 4) | value;
+		} else {
+			low = (low << 4) | value;
+		}
+		digits++;
+	}
+	if (digits != 32) {
+		return UuidKey();
+	}
+	return UuidKey(high, low);
+}
+
+/*
+ * same as fromString() for text from the boundary (JSON, QML, Server API)
+ * a String which isn't empty and isn't a UUID is logged - the caller gets
+ * a null UuidKey and must not replace an existing id by a new one
+ */
+UuidKey UuidKey::fromString(const QString& uuidString, const char* context)
+{
+	UuidKey uuid = fromString(uuidString);
+	if (uuid.isNull() && !uuidString.isEmpty()) {
+		qWarning() << context << ": invalid uuid rejected: " << uuidString;
+	}
+	return uuid;
+}
+
+/*
+ * 16 Bytes big endian (RFC 4122 byte order)
+ * used to read BLOBs from SQLite or binary caches
+ */
+UuidKey UuidKey::fromRfc4122(const QByteArray& bytes)
+{
+	if (bytes.size() != 16) {
+		return UuidKey();
+	}
+	const uchar* data = reinterpret_cast<const uchar*>(bytes.constData());
+	quint64 high = 0;
+	quint64 low = 0;
+	for (int i = 0; i < 8; ++i) {
+		high = (high << 8) | data[i];
+		low = (low << 8) | data[i + 8];
+	}
+	return UuidKey(high, low);
+}
+
+/*
+ * 8-4-4-4-12 lowercase without braces
+ * same format we got before from QUuid::toString() with braces removed
+ * a null UuidKey returns an empty String
+ */
+QString UuidKey::toString() const
+{
+	if (isNull()) {
+		return QString("");
+	}
+	QString uuidString(36, QChar('-'));
+	QChar* data = uuidString.data();
+	int pos = 0;
+	for (int i = 0; i < 32; ++i) {
+		if (i == 8 || i == 12 || i == 16 || i == 20) {
+			// keep the '-'
+			pos++;
+		}
+		int shift = (15 - (i % 16)) * 4;
+		quint64 part = (i < 16) ? mHigh : mLow;
+		data[pos++] = QChar(hexDigits[(part >> shift) & 0xf]);
+	}
+	return uuidString;
+}
+
+QByteArray UuidKey::toRfc4122() const
+{
+	QByteArray bytes(16, 0);
+	uchar* data = reinterpret_cast<uchar*>(bytes.data());
+	for (int i = 0; i < 8; ++i) {
+		data[i] = (mHigh >> ((7 - i) * 8)) & 0xff;
+		data[i + 8] = (mLow >> ((7 - i) * 8)) & 0xff;
+	}
+	return bytes;
+}
+
+bool UuidKey::isNull() const
+{
+	return mHigh == 0 && mLow == 0;
+}
+
+quint64 UuidKey::high() const
+{
+	return mHigh;
+}
+
+quint64 UuidKey::low() const
+{
+	return mLow;
+}
+
+bool UuidKey::operator==(const UuidKey& other) const
+{
+	return mHigh == other.mHigh && mLow == other.mLow;
+}
+
+bool UuidKey::operator!=(const UuidKey& other) const
+{
+	return !(*this == other);
+}
+
+bool UuidKey::operator<(const UuidKey& other) const
+{
+	if (mHigh != other.mHigh) {
+		return mHigh < other.mHigh;
+	}
+	return mLow < other.mLow;
+}
+
+/*
+ * random UUIDs are well distributed - folding the bits is enough
+ */
+uint qHash(const UuidKey& key)
+{
+	quint64 folded = key.high() ^ key.low();
+	return uint(folded ^ (folded >> 32));
+}
@@ -0,0 +1,52 @@
+#ifndef UUIDKEY_HPP_
+#define UUIDKEY_HPP_
+
+#include <QString>
+#include <QByteArray>
+#include <QMetaType>
+
+/*
+ * compact binary UUID used as DomainKey (128 bit)
+ * needs 16 Bytes instead of a QString with 36 characters
+ * storage, hashing and comparison are done on the binary value
+ * text conversion only at the boundary (QML, Server API, JSON):
+ * fromString() accepts 8-4-4-4-12 with or without braces
+ * invalid Strings are rejected (null UuidKey), never replaced by a new UUID
+ * toString() returns 8-4-4-4-12 lowercase without braces
+ * SQLite stores the 16 Bytes from toRfc4122() as BLOB
+ */
+class UuidKey
+{
+public:
+	UuidKey();
+	UuidKey(quint64 high, quint64 low);
+
+	static UuidKey createUuid();
+	static UuidKey fromString(const QString& uuidString);
+	// logs invalid Strings with qWarning
+	static UuidKey fromString(const QString& uuidString, const char* context);
+	static UuidKey fromRfc4122(const QByteArray& bytes);
+
+	QString toString() const;
+	QByteArray toRfc4122() const;
+
+	bool isNull() const;
+
+	quint64 high() const;
+	quint64 low() const;
+
+	bool operator==(const UuidKey& other) const;
+	bool operator!=(const UuidKey& other) const;
+	bool operator<(const UuidKey& other) const;
+
+private:
+	quint64 mHigh;
+	quint64 mLow;
+};
+
+uint qHash(const UuidKey& key);
+
+Q_DECLARE_TYPEINFO(UuidKey, Q_MOVABLE_TYPE);
+Q_DECLARE_METATYPE(UuidKey)
+
+#endif /* UUIDKEY_HPP_ */
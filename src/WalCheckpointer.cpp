@@ -0,0 +1,110 @@
+#include "WalCheckpointer.hpp"
+#include <QDebug>
+
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
+#include <QtSql/QSqlError>
+#include <QElapsedTimer>
+#include <QFileInfo>
+
+// the worker uses its own connection to the SQLite database
+static QString connectionName = "walCheckpointer";
+
+WalCheckpointer::WalCheckpointer(const QString& databaseFile, const int& intervalMs,
+		QObject *parent) :
+		QObject(parent), mDatabaseFile(databaseFile), mIntervalMs(qMax(100, intervalMs)), mTimer(
+				0), mConnectionOpen(false)
+{
+}
+
+qint64 WalCheckpointer::walFileSize(const QString& databaseFile)
+{
+	QFileInfo walFile(databaseFile + "-wal");
+	if (!walFile.exists()) {
+		return 0;
+	}
+	return walFile.size();
+}
+
+void WalCheckpointer::start()
+{
+	{
+		QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+		database.setDatabaseName(mDatabaseFile);
+		if (!database.open()) {
+			qWarning() << "WalCheckpointer cannot open " << mDatabaseFile << ":"
+					<< database.lastError().text();
+		} else {
+			mConnectionOpen = true;
+			QSqlQuery query(database);
+			if (!query.exec("PRAGMA synchronous = NORMAL")) {
+				qWarning() << "NO SUCCESS PRAGMA synchronous (checkpointer)";
+			}
+		}
+	}
+	if (!mConnectionOpen) {
+		QSqlDatabase::removeDatabase(connectionName);
+		return;
+	}
+	// timer must be created on the worker thread
+	mTimer = new QTimer(this);
+	mTimer->setInterval(mIntervalMs);
+	bool res = QObject::connect(mTimer, SIGNAL(timeout()), this, SLOT(checkpoint()));
+	Q_ASSERT(res);
+	Q_UNUSED(res);
+	mTimer->start();
+	qDebug() << "WalCheckpointer started, interval ms: " << mIntervalMs;
+}
+
+/*
+ * PRAGMA wal_checkpoint(PASSIVE) returns one row:
+ * busy, frames in WAL, frames checkpointed
+ * nothing to do if there's no WAL
+ */
+void WalCheckpointer::checkpoint()
+{
+	if (!mConnectionOpen) {
+		return;
+	}
+	qint64 walSize = walFileSize(mDatabaseFile);
+	if (walSize == 0) {
+		return;
+	}
+	QElapsedTimer elapsedTimer;
+	elapsedTimer.start();
+	int walFrames = -1;
+	int checkpointedFrames = -1;
+	{
+		QSqlQuery query(QSqlDatabase::database(connectionName));
+		if (!query.exec("PRAGMA wal_checkpoint(PASSIVE)")) {
+			qWarning() << "NO SUCCESS PRAGMA wal_checkpoint " << query.lastError().text();
+			return;
+		}
+		if (query.next()) {
+			walFrames = query.value(1).toInt();
+			checkpointedFrames = query.value(2).toInt();
+		}
+	}
+	int latency = elapsedTimer.elapsed();
+	qDebug() << "WAL checkpoint in ms: " << latency << " WAL bytes: " << walSize << " frames: "
+			<< walFrames << " checkpointed: " << checkpointedFrames;
+	emit checkpointDone(latency, walSize, walFrames, checkpointedFrames);
+}
+
+void WalCheckpointer::stop()
+{
+	if (mTimer) {
+		mTimer->stop();
+	}
+	if (mConnectionOpen) {
+		QSqlDatabase::database(connectionName).close();
+		mConnectionOpen = false;
+		// database and query must be out of scope
+		QSqlDatabase::removeDatabase(connectionName);
+	}
+}
+
+WalCheckpointer::~WalCheckpointer()
+{
+	// clean up
+}
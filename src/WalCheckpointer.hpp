@@ -0,0 +1,47 @@
+#ifndef WALCHECKPOINTER_HPP_
+#define WALCHECKPOINTER_HPP_
+
+#include <QObject>
+#include <QTimer>
+
+/*
+ * runs SQLite WAL checkpoints on a worker thread
+ * used by DataManager if durability profile is WalDurability
+ *
+ * DataManager disables wal_autocheckpoint on its connection,
+ * so a COMMIT never has to copy the WAL back into the database
+ * WalCheckpointer uses its own connection and runs
+ * PRAGMA wal_checkpoint(PASSIVE) from a timer:
+ * PASSIVE never waits for readers or writers
+ */
+class WalCheckpointer: public QObject
+{
+	Q_OBJECT
+
+public:
+	WalCheckpointer(const QString& databaseFile, const int& intervalMs, QObject *parent = 0);
+	virtual ~WalCheckpointer();
+
+	// size of <database>-wal in bytes, 0 if there's no WAL
+	static qint64 walFileSize(const QString& databaseFile);
+
+public slots:
+	// opens the connection and starts the timer - runs on the worker thread
+	void start();
+	void checkpoint();
+	// stops the timer and removes the connection
+	void stop();
+
+Q_SIGNALS:
+	// latency of the checkpoint, size of WAL file,
+	// frames in WAL and frames copied into the database
+	void checkpointDone(int latencyMs, qint64 walSize, int walFrames, int checkpointedFrames);
+
+private:
+	QString mDatabaseFile;
+	int mIntervalMs;
+	QTimer* mTimer;
+	bool mConnectionOpen;
+};
+
+#endif /* WALCHECKPOINTER_HPP_ */